@@ -27,6 +27,30 @@ lv_result_t_esp lv_color_blend_to_rgb888_shim(const void* dsc);
 lv_result_t_esp lv_rgb565_blend_normal_to_rgb565_shim(const void* dsc);
 lv_result_t_esp lv_rgb888_blend_normal_to_rgb888_shim(const void* dsc);
 
+// -----------------------------------------------------------------------------
+// Instrumentation Hook
+// -----------------------------------------------------------------------------
+// Per-shim call and CPU cycle counters. Only updated when
+// CONFIG_WORKSHOP_HOT_PATH_PROFILING is set. Written from the LVGL task only.
+
+typedef enum {
+  LV_DRAW_SW_ASM_SHIM_FILL_RGB565 = 0,
+  LV_DRAW_SW_ASM_SHIM_FILL_RGB888,
+  LV_DRAW_SW_ASM_SHIM_IMAGE_RGB565,
+  LV_DRAW_SW_ASM_SHIM_IMAGE_RGB888,
+  LV_DRAW_SW_ASM_SHIM_COUNT
+} lv_draw_sw_asm_shim_id_t;
+
+typedef struct {
+  uint32_t calls;
+  uint64_t cycles;
+} lv_draw_sw_asm_shim_stat_t;
+
+extern lv_draw_sw_asm_shim_stat_t
+    lv_draw_sw_asm_shim_stats[LV_DRAW_SW_ASM_SHIM_COUNT];
+
+void lv_draw_sw_asm_reset_shim_stats(void);
+
 // -----------------------------------------------------------------------------
 // LVGL Hook Macros
 // -----------------------------------------------------------------------------
@@ -0,0 +1,20 @@
+/**
+ * @file lv_draw_sw_asm_instrumentation.c
+ *
+ * Storage for the optional shim instrumentation (per-shim cycle counters).
+ * Kept apart from lv_draw_sw_asm_shim.c, which references the S3-only
+ * assembly symbols, so other targets can still link against it.
+ */
+
+#include <stddef.h>
+
+#include "lv_draw_sw_asm_custom.h"
+
+lv_draw_sw_asm_shim_stat_t lv_draw_sw_asm_shim_stats[LV_DRAW_SW_ASM_SHIM_COUNT];
+
+void lv_draw_sw_asm_reset_shim_stats(void) {
+  for (int i = 0; i < LV_DRAW_SW_ASM_SHIM_COUNT; i++) {
+    lv_draw_sw_asm_shim_stats[i].calls = 0;
+    lv_draw_sw_asm_shim_stats[i].cycles = 0;
+  }
+}
@@ -6,6 +6,12 @@
  */
 
 #include "lvgl.h" // Pull in public types (lv_color_t, lv_area_t, etc.)
+#include "lv_draw_sw_asm_custom.h"
+#include "sdkconfig.h"
+
+#ifdef CONFIG_WORKSHOP_HOT_PATH_PROFILING
+#include "esp_cpu.h"
+#endif
 
 // -----------------------------------------------------------------------------
 // 1. ESP Assembly Struct Definition
@@ -67,7 +73,25 @@ typedef struct {
 } shim_lv_draw_sw_blend_image_dsc_t;
 
 // -----------------------------------------------------------------------------
-// 3. Shim Implementations
+// 3. Instrumentation Hook
+// -----------------------------------------------------------------------------
+
+#ifdef CONFIG_WORKSHOP_HOT_PATH_PROFILING
+#define SHIM_CALL(id, call)                                            \
+  do {                                                                 \
+    uint32_t start = esp_cpu_get_cycle_count();                        \
+    lv_result_t_esp res = (call);                                      \
+    lv_draw_sw_asm_shim_stats[id].calls++;                             \
+    lv_draw_sw_asm_shim_stats[id].cycles +=                            \
+        esp_cpu_get_cycle_count() - start;                             \
+    return res;                                                        \
+  } while (0)
+#else
+#define SHIM_CALL(id, call) return (call)
+#endif
+
+// -----------------------------------------------------------------------------
+// 4. Shim Implementations
 // -----------------------------------------------------------------------------
 
 lv_result_t_esp lv_color_blend_to_rgb565_shim(const void *dsc_void) {
@@ -89,7 +113,8 @@ lv_result_t_esp lv_color_blend_to_rgb565_shim(const void *dsc_void) {
   asm_dsc.mask_buf = dsc->mask_buf;
   asm_dsc.mask_stride = dsc->mask_stride;
 
-  return lv_color_blend_to_rgb565_esp(&asm_dsc);
+  SHIM_CALL(LV_DRAW_SW_ASM_SHIM_FILL_RGB565,
+            lv_color_blend_to_rgb565_esp(&asm_dsc));
 }
 
 lv_result_t_esp lv_color_blend_to_rgb888_shim(const void *dsc_void) {
@@ -111,7 +136,8 @@ lv_result_t_esp lv_color_blend_to_rgb888_shim(const void *dsc_void) {
   asm_dsc.mask_buf = dsc->mask_buf;
   asm_dsc.mask_stride = dsc->mask_stride;
 
-  return lv_color_blend_to_rgb888_esp(&asm_dsc);
+  SHIM_CALL(LV_DRAW_SW_ASM_SHIM_FILL_RGB888,
+            lv_color_blend_to_rgb888_esp(&asm_dsc));
 }
 
 lv_result_t_esp lv_rgb565_blend_normal_to_rgb565_shim(const void *dsc_void) {
@@ -129,7 +155,8 @@ lv_result_t_esp lv_rgb565_blend_normal_to_rgb565_shim(const void *dsc_void) {
   asm_dsc.mask_buf = dsc->mask_buf;
   asm_dsc.mask_stride = dsc->mask_stride;
 
-  return lv_rgb565_blend_normal_to_rgb565_esp(&asm_dsc);
+  SHIM_CALL(LV_DRAW_SW_ASM_SHIM_IMAGE_RGB565,
+            lv_rgb565_blend_normal_to_rgb565_esp(&asm_dsc));
 }
 
 lv_result_t_esp lv_rgb888_blend_normal_to_rgb888_shim(const void *dsc_void) {
@@ -147,5 +174,6 @@ lv_result_t_esp lv_rgb888_blend_normal_to_rgb888_shim(const void *dsc_void) {
   asm_dsc.mask_buf = dsc->mask_buf;
   asm_dsc.mask_stride = dsc->mask_stride;
 
-  return lv_rgb888_blend_normal_to_rgb888_esp(&asm_dsc);
+  SHIM_CALL(LV_DRAW_SW_ASM_SHIM_IMAGE_RGB888,
+            lv_rgb888_blend_normal_to_rgb888_esp(&asm_dsc));
 }
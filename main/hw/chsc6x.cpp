@@ -2,6 +2,7 @@
 
 #include <string.h>
 
+#include "esp_check.h"
 #include "esp_log.h"
 
 static const char* TAG = "Chsc6x";
@@ -63,6 +64,29 @@ esp_err_t Chsc6x::init() {
   return ESP_OK;
 }
 
+esp_err_t Chsc6x::enable_interrupt(gpio_isr_t handler, void* arg) {
+  if (config_.int_io_num < 0) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  // The INT line is pulled low by the controller while a finger is down.
+  gpio_config_t io_conf = {
+      .pin_bit_mask = 1ULL << config_.int_io_num,
+      .mode = GPIO_MODE_INPUT,
+      .pull_up_en = GPIO_PULLUP_ENABLE,
+      .pull_down_en = GPIO_PULLDOWN_DISABLE,
+      .intr_type = GPIO_INTR_NEGEDGE,
+  };
+  ESP_RETURN_ON_ERROR(gpio_config(&io_conf), TAG, "INT pin config failed");
+
+  // The ISR service may already be installed by another driver.
+  esp_err_t err = gpio_install_isr_service(0);
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+    return err;
+  }
+  return gpio_isr_handler_add((gpio_num_t)config_.int_io_num, handler, arg);
+}
+
 esp_err_t Chsc6x::read(uint16_t* x, uint16_t* y, bool* pressed) {
   if (!dev_handle_) {
     return ESP_ERR_INVALID_STATE;
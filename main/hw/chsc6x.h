@@ -1,5 +1,6 @@
 #pragma once
 
+#include "driver/gpio.h"
 #include "driver/i2c_master.h"
 #include "esp_err.h"
 
@@ -24,6 +25,12 @@ class Chsc6x {
   esp_err_t init();
   esp_err_t read(uint16_t* x, uint16_t* y, bool* pressed);
 
+  /**
+   * Call handler from an ISR when a touch starts (falling edge on the INT
+   * pin), e.g. to wake a suspended render loop.
+   */
+  esp_err_t enable_interrupt(gpio_isr_t handler, void* arg);
+
  private:
   Config config_;
   i2c_master_bus_handle_t bus_handle_ = nullptr;
@@ -17,34 +17,65 @@ static const char* TAG = "Gc9a01";
 
 Gc9a01::Gc9a01(const Config& config) : config_(config) {}
 
-Gc9a01::~Gc9a01() {
-  if (panel_handle_) {
-    esp_lcd_panel_del(panel_handle_);
-  }
-  if (io_handle_) {
-    esp_lcd_panel_io_del(io_handle_);
-  }
-}
+Gc9a01::~Gc9a01() { release_panel(); }
 
 esp_err_t Gc9a01::init() {
   // 1. SPI BUS INITIALIZATION
   // -------------------------
   // We configure the SPI bus to handle the high speeds (80MHz) required
   // for smooth animations.
-  ESP_LOGI(TAG, "Initialize SPI bus");
-  spi_bus_config_t buscfg = {};
-  buscfg.mosi_io_num = config_.mosi_io_num;
-  buscfg.miso_io_num = -1;  // No input needed from the display
-  buscfg.sclk_io_num = config_.sclk_io_num;
-  buscfg.quadwp_io_num = -1;
-  buscfg.quadhd_io_num = -1;
-  // Support full frame 240x240x2 DMA transfers (essential for Phase 4)
-  buscfg.max_transfer_sz = (int)(240 * 240 * sizeof(uint16_t));
-
-  ESP_ERROR_CHECK(spi_bus_initialize(config_.host, &buscfg, SPI_DMA_CH_AUTO));
-
-  // 2. PANEL I/O CONFIGURATION
-  // --------------------------
+  // Panels sharing the bus skip this step; the SPI master driver arbitrates
+  // between devices by CS.
+  if (!config_.shared_bus) {
+    ESP_LOGI(TAG, "Initialize SPI bus");
+    spi_bus_config_t buscfg = {};
+    buscfg.mosi_io_num = config_.mosi_io_num;
+    buscfg.miso_io_num = -1;  // No input needed from the display
+    buscfg.sclk_io_num = config_.sclk_io_num;
+    buscfg.quadwp_io_num = -1;
+    buscfg.quadhd_io_num = -1;
+    // Support full frame DMA transfers (essential for Phase 4)
+    buscfg.max_transfer_sz =
+        (int)((size_t)config_.h_res * config_.v_res * sizeof(uint16_t));
+
+    ESP_ERROR_CHECK(
+        spi_bus_initialize(config_.host, &buscfg, SPI_DMA_CH_AUTO));
+  }
+
+  // 2. PANEL I/O AND DRIVER
+  // -----------------------
+  ESP_ERROR_CHECK(create_panel());
+
+  // 3. POWER ON
+  // -----------
+  // Reset the display and run the init sequence.
+  ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle_));
+  ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle_));
+  ESP_ERROR_CHECK(configure_panel());
+
+  // 4. BACKLIGHT CONTROL
+  // --------------------
+  // Simple GPIO-based backlight logic. Panels sharing a backlight line
+  // pass -1.
+  if (config_.bl_io_num >= 0) {
+    ESP_LOGI(TAG, "Initialize backlight");
+    gpio_num_t bl_gpio = (gpio_num_t)config_.bl_io_num;
+    gpio_reset_pin(bl_gpio);
+    gpio_set_direction(bl_gpio, GPIO_MODE_OUTPUT);
+    gpio_set_level(bl_gpio, 1);
+  }
+
+  return ESP_OK;
+}
+
+void Gc9a01::set_backlight(bool on) {
+  if (config_.bl_io_num < 0) return;
+  gpio_set_level((gpio_num_t)config_.bl_io_num, on ? 1 : 0);
+}
+
+esp_err_t Gc9a01::create_panel() {
+  // PANEL I/O CONFIGURATION
+  // -----------------------
   // Link the SPI bus to the LCD-specific protocol (CS, DC, Speed).
   esp_lcd_panel_io_spi_config_t io_config = {
       .cs_gpio_num = (gpio_num_t)config_.cs_io_num,
@@ -71,11 +102,14 @@ esp_err_t Gc9a01::init() {
               .cs_high_active = 0,
           },
   };
-  ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi(
-      (esp_lcd_spi_bus_handle_t)config_.host, &io_config, &io_handle_));
+  esp_err_t err = esp_lcd_new_panel_io_spi(
+      (esp_lcd_spi_bus_handle_t)config_.host, &io_config, &io_handle_);
+  if (err != ESP_OK) {
+    return err;
+  }
 
-  // 3. GC9A01 PANEL SPECIFICS
-  // -------------------------
+  // GC9A01 PANEL SPECIFICS
+  // ----------------------
   // Install the manufacturer-specific initialization sequence.
   ESP_LOGI(TAG, "Install GC9A01 panel driver");
   esp_lcd_panel_dev_config_t panel_config = {
@@ -86,27 +120,62 @@ esp_err_t Gc9a01::init() {
       .vendor_config = NULL,
       .flags = {.reset_active_high = 0},
   };
-  ESP_ERROR_CHECK(
-      esp_lcd_new_panel_gc9a01(io_handle_, &panel_config, &panel_handle_));
-
-  // Power on and reset the display.
-  ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle_));
-  ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle_));
+  return esp_lcd_new_panel_gc9a01(io_handle_, &panel_config, &panel_handle_);
+}
 
+esp_err_t Gc9a01::configure_panel() {
   // Custom display parameters for the Round Screen
-  ESP_ERROR_CHECK(esp_lcd_panel_invert_color(panel_handle_, true));
-  ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle_, true));
-  ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(panel_handle_, true));
-  ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle_, true, true));
+  esp_err_t err = esp_lcd_panel_invert_color(panel_handle_, true);
+  if (err == ESP_OK) {
+    err = esp_lcd_panel_disp_on_off(panel_handle_, true);
+  }
+  if (err == ESP_OK) {
+    err = esp_lcd_panel_swap_xy(panel_handle_, true);
+  }
+  if (err == ESP_OK) {
+    err = esp_lcd_panel_mirror(panel_handle_, true, true);
+  }
+  return err;
+}
 
-  // 4. BACKLIGHT CONTROL
-  // --------------------
-  // Simple GPIO-based backlight logic.
-  ESP_LOGI(TAG, "Initialize backlight");
-  gpio_num_t bl_gpio = (gpio_num_t)config_.bl_io_num;
-  gpio_reset_pin(bl_gpio);
-  gpio_set_direction(bl_gpio, GPIO_MODE_OUTPUT);
-  gpio_set_level(bl_gpio, 1);
+esp_err_t Gc9a01::set_pclk_hz(uint32_t pclk_hz) {
+  // The old device must go first: the new one claims the same CS line. If
+  // the new clock is refused, come back at the old one.
+  const uint32_t old_pclk_hz = config_.pclk_hz;
+  release_panel();
+  config_.pclk_hz = pclk_hz;
+  esp_err_t err = create_panel();
+  if (err == ESP_OK) {
+    // The new driver object starts from defaults: replay the orientation so
+    // that its view matches the glass.
+    err = configure_panel();
+  }
+  if (err == ESP_OK) {
+    return ESP_OK;
+  }
 
-  return ESP_OK;
+  ESP_LOGE(TAG, "Cannot re-create the panel at %u Hz: %s", (unsigned)pclk_hz,
+           esp_err_to_name(err));
+  release_panel();
+  config_.pclk_hz = old_pclk_hz;
+  esp_err_t restore_err = create_panel();
+  if (restore_err == ESP_OK) {
+    restore_err = configure_panel();
+  }
+  if (restore_err != ESP_OK) {
+    ESP_LOGE(TAG, "Cannot restore the panel at %u Hz: %s",
+             (unsigned)old_pclk_hz, esp_err_to_name(restore_err));
+  }
+  return err;
+}
+
+void Gc9a01::release_panel() {
+  if (panel_handle_) {
+    esp_lcd_panel_del(panel_handle_);
+    panel_handle_ = nullptr;
+  }
+  if (io_handle_) {
+    esp_lcd_panel_io_del(io_handle_);
+    io_handle_ = nullptr;
+  }
 }
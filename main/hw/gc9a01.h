@@ -18,16 +18,35 @@ class Gc9a01 {
     uint32_t pclk_hz;
     int h_res;
     int v_res;
+    // Another panel already initialized this SPI host: only add a device
+    // (with its own CS) to the bus.
+    bool shared_bus = false;
   };
 
   explicit Gc9a01(const Config& config);
   ~Gc9a01();
 
   esp_err_t init();
+
+  /**
+   * Change the SPI pixel clock. esp_lcd cannot retune a device in place, so
+   * this replaces the panel IO and panel handles; the glass keeps its
+   * state and is not reset. Call while no transfer is in flight. If the
+   * new clock cannot be set, the panel is re-created at the old one.
+   */
+  esp_err_t set_pclk_hz(uint32_t pclk_hz);
+  uint32_t pclk_hz() const { return config_.pclk_hz; }
+
+  /** Switch the backlight on or off. */
+  void set_backlight(bool on);
   esp_lcd_panel_handle_t get_panel_handle() const { return panel_handle_; }
   esp_lcd_panel_io_handle_t get_io_handle() const { return io_handle_; }
 
  private:
+  esp_err_t create_panel();
+  esp_err_t configure_panel();
+  void release_panel();
+
   Config config_;
   esp_lcd_panel_io_handle_t io_handle_ = nullptr;
   esp_lcd_panel_handle_t panel_handle_ = nullptr;
@@ -0,0 +1,210 @@
+#include "hw/host_panel.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "HostPanel";
+
+/**
+ * HOST PANEL: Implementation
+ * --------------------------
+ * draw_bitmap() only queues the transfer; the bus worker copies the pixels
+ * and fires on_color_trans_done() once the emulated wire time has passed.
+ * LVGL must not touch the buffer before that callback, exactly as with the
+ * SPI DMA, so the copy can safely happen late.
+ */
+
+// CASET + RASET + RAMWR: 3 commands, 8 parameter bytes.
+static constexpr uint32_t kCommandOverheadBytes = 3 + 8;
+
+HostSpiBus::HostSpiBus(uint32_t pclk_hz, size_t queue_depth)
+    : pclk_hz_(pclk_hz), queue_depth_(queue_depth) {}
+
+HostSpiBus::~HostSpiBus() {
+  if (worker_) vTaskDelete(worker_);
+  if (queue_) vQueueDelete(queue_);
+}
+
+esp_err_t HostSpiBus::init() {
+  queue_ = xQueueCreate(queue_depth_, sizeof(Transfer));
+  if (!queue_) {
+    return ESP_ERR_NO_MEM;
+  }
+  if (xTaskCreate(worker_task, "host_spi", 4096, this, 10, &worker_) !=
+      pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  ESP_LOGI(TAG, "Emulated SPI bus at %u MHz, queue depth %u",
+           (unsigned)(pclk_hz_ / 1000000), (unsigned)queue_depth_);
+  return ESP_OK;
+}
+
+esp_err_t HostSpiBus::submit(const Transfer& transfer) {
+  return xQueueSend(queue_, &transfer, portMAX_DELAY) == pdTRUE
+             ? ESP_OK
+             : ESP_ERR_TIMEOUT;
+}
+
+void HostSpiBus::worker_task(void* arg) {
+  auto* bus = static_cast<HostSpiBus*>(arg);
+  Transfer transfer;
+  while (true) {
+    if (xQueueReceive(bus->queue_, &transfer, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+
+    // Hold the "wire" for as long as the real bus would.
+    const uint64_t bytes = (uint64_t)(transfer.x2 - transfer.x1) *
+                               (transfer.y2 - transfer.y1) * sizeof(uint16_t) +
+                           kCommandOverheadBytes;
+    const int64_t wire_us = (int64_t)(bytes * 8 * 1000000 / bus->pclk_hz_);
+    const int64_t until = esp_timer_get_time() + wire_us;
+    if (wire_us > 2000) {
+      vTaskDelay(pdMS_TO_TICKS(wire_us / 1000 - 1));
+    }
+    while (esp_timer_get_time() < until) {
+    }
+    bus->busy_us_ += wire_us;
+
+    transfer.panel->complete(transfer);
+  }
+}
+
+HostPanel::HostPanel(HostSpiBus& bus, int h_res, int v_res)
+    : bus_(bus),
+      h_res_(h_res),
+      v_res_(v_res),
+      framebuffer_((size_t)h_res * v_res, 0) {
+  panel_.reset = panel_noop;
+  panel_.init = panel_noop;
+  panel_.del = panel_noop;
+  panel_.draw_bitmap = panel_draw_bitmap;
+  panel_.mirror = panel_mirror;
+  panel_.swap_xy = panel_flag;
+  panel_.set_gap = panel_set_gap;
+  panel_.invert_color = panel_flag;
+  panel_.disp_on_off = panel_flag;
+  panel_.disp_sleep = panel_flag;
+  panel_.user_data = this;
+
+  io_.self = this;
+  io_.base.rx_param = io_rx_param;
+  io_.base.tx_param = io_tx_param;
+  io_.base.tx_color = io_tx_color;
+  io_.base.del = io_del;
+  io_.base.register_event_callbacks = io_register_event_callbacks;
+}
+
+esp_err_t HostPanel::init() {
+  ESP_LOGI(TAG, "Host panel %dx%d", h_res_, v_res_);
+  return ESP_OK;
+}
+
+HostPanel* HostPanel::from(esp_lcd_panel_t* panel) {
+  return static_cast<HostPanel*>(panel->user_data);
+}
+
+HostPanel* HostPanel::from(esp_lcd_panel_io_t* io) {
+  return reinterpret_cast<IoShim*>(io)->self;
+}
+
+esp_err_t HostPanel::panel_noop(esp_lcd_panel_t* panel) { return ESP_OK; }
+
+esp_err_t HostPanel::panel_flag(esp_lcd_panel_t* panel, bool value) {
+  return ESP_OK;
+}
+
+esp_err_t HostPanel::panel_mirror(esp_lcd_panel_t* panel, bool x_axis,
+                                  bool y_axis) {
+  return ESP_OK;
+}
+
+esp_err_t HostPanel::panel_set_gap(esp_lcd_panel_t* panel, int x_gap,
+                                   int y_gap) {
+  return ESP_OK;
+}
+
+esp_err_t HostPanel::panel_draw_bitmap(esp_lcd_panel_t* panel, int x_start,
+                                       int y_start, int x_end, int y_end,
+                                       const void* color_data) {
+  HostPanel* self = from(panel);
+  if (x_start < 0 || y_start < 0 || x_end > self->h_res_ ||
+      y_end > self->v_res_ || x_start >= x_end || y_start >= y_end) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  self->submitted_ = self->submitted_ + 1;
+  return self->bus_.submit(
+      {self, x_start, y_start, x_end, y_end, color_data});
+}
+
+esp_err_t HostPanel::io_rx_param(esp_lcd_panel_io_t* io, int lcd_cmd,
+                                 void* param, size_t param_size) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t HostPanel::io_tx_param(esp_lcd_panel_io_t* io, int lcd_cmd,
+                                 const void* param, size_t param_size) {
+  return ESP_OK;
+}
+
+esp_err_t HostPanel::io_tx_color(esp_lcd_panel_io_t* io, int lcd_cmd,
+                                 const void* color, size_t color_size) {
+  // Raw color writes bypass the window commands; only draw_bitmap() is
+  // supported.
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t HostPanel::io_del(esp_lcd_panel_io_t* io) { return ESP_OK; }
+
+esp_err_t HostPanel::io_register_event_callbacks(
+    esp_lcd_panel_io_t* io, const esp_lcd_panel_io_callbacks_t* cbs,
+    void* user_ctx) {
+  HostPanel* self = from(io);
+  self->callbacks_ = *cbs;
+  self->callbacks_ctx_ = user_ctx;
+  return ESP_OK;
+}
+
+void HostPanel::complete(const HostSpiBus::Transfer& t) {
+  const int w = t.x2 - t.x1;
+  const auto* src = static_cast<const uint16_t*>(t.data);
+  for (int y = t.y1; y < t.y2; y++) {
+    memcpy(&framebuffer_[(size_t)y * h_res_ + t.x1],
+           src + (size_t)(y - t.y1) * w, w * sizeof(uint16_t));
+  }
+  transfers_ = transfers_ + 1;
+
+  if (callbacks_.on_color_trans_done) {
+    callbacks_.on_color_trans_done(&io_.base, nullptr, callbacks_ctx_);
+  }
+}
+
+uint32_t HostPanel::checksum() const {
+  uint32_t hash = 2166136261u;
+  for (uint16_t px : framebuffer_) {
+    hash = (hash ^ (px & 0xFF)) * 16777619u;
+    hash = (hash ^ (px >> 8)) * 16777619u;
+  }
+  return hash;
+}
+
+bool HostPanel::write_ppm(const char* path) const {
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    return false;
+  }
+  fprintf(f, "P6\n%d %d\n255\n", h_res_, v_res_);
+  for (uint16_t px : framebuffer_) {
+    // Stored as sent on the wire: swap back to CPU order first.
+    const uint16_t c = (uint16_t)((px >> 8) | (px << 8));
+    const uint8_t rgb[3] = {(uint8_t)((c >> 11) << 3),
+                            (uint8_t)(((c >> 5) & 0x3F) << 2),
+                            (uint8_t)((c & 0x1F) << 3)};
+    fwrite(rgb, 1, 3, f);
+  }
+  fclose(f);
+  return true;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "esp_lcd_panel_interface.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_io_interface.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+class HostPanel;
+
+/**
+ * HOST SPI BUS
+ * ------------
+ * Linux-target stand-in for a shared SPI bus. Transfers from every panel on
+ * the bus go through one bounded queue and one worker task, which "sends"
+ * them one at a time, taking as long as the real bus would at pclk_hz. A
+ * full queue blocks the caller, just like spi_device_queue_trans(), so bus
+ * contention between panels shows up in the same places as on hardware.
+ */
+class HostSpiBus {
+ public:
+  explicit HostSpiBus(uint32_t pclk_hz, size_t queue_depth = 10);
+  ~HostSpiBus();
+
+  HostSpiBus(const HostSpiBus&) = delete;
+  HostSpiBus& operator=(const HostSpiBus&) = delete;
+
+  esp_err_t init();
+
+  /** Change the emulated clock; takes effect from the next transfer. */
+  void set_pclk_hz(uint32_t pclk_hz) { pclk_hz_ = pclk_hz; }
+  uint32_t pclk_hz() const { return pclk_hz_; }
+
+  /** Time the emulated wire has been busy, in microseconds. */
+  uint64_t busy_us() const { return busy_us_; }
+
+ private:
+  friend class HostPanel;
+
+  struct Transfer {
+    HostPanel* panel;
+    int x1, y1, x2, y2;  // End-exclusive, like esp_lcd_panel_draw_bitmap().
+    const void* data;
+  };
+
+  esp_err_t submit(const Transfer& transfer);
+  static void worker_task(void* arg);
+
+  std::atomic<uint32_t> pclk_hz_;
+  size_t queue_depth_;
+  QueueHandle_t queue_ = nullptr;
+  TaskHandle_t worker_ = nullptr;
+  volatile uint64_t busy_us_ = 0;
+};
+
+/**
+ * HOST PANEL
+ * ----------
+ * A software GC9A01 for the linux target. It implements the esp_lcd panel
+ * and panel IO interfaces, so LvglPort drives it through exactly the same
+ * calls (esp_lcd_panel_draw_bitmap, on_color_trans_done) as the real panel.
+ * Pixels land in a framebuffer in panel byte order (big-endian RGB565).
+ */
+class HostPanel {
+ public:
+  HostPanel(HostSpiBus& bus, int h_res, int v_res);
+  ~HostPanel() = default;
+
+  HostPanel(const HostPanel&) = delete;
+  HostPanel& operator=(const HostPanel&) = delete;
+
+  esp_err_t init();
+
+  esp_lcd_panel_handle_t get_panel_handle() { return &panel_; }
+  esp_lcd_panel_io_handle_t get_io_handle() { return &io_.base; }
+
+  int h_res() const { return h_res_; }
+  int v_res() const { return v_res_; }
+  const std::vector<uint16_t>& framebuffer() const { return framebuffer_; }
+
+  /** Transfers completed so far. */
+  uint32_t transfers() const { return transfers_; }
+
+  /** True when every queued transfer has landed in the framebuffer. */
+  bool idle() const { return transfers_ == submitted_; }
+
+  /** FNV-1a hash of the framebuffer, for golden-image checks. */
+  uint32_t checksum() const;
+
+  /** Write the framebuffer as a binary PPM image. */
+  bool write_ppm(const char* path) const;
+
+ private:
+  friend class HostSpiBus;
+
+  // esp_lcd_panel_t has a user_data field, the IO interface does not: wrap
+  // it together with a back-pointer.
+  struct IoShim {
+    esp_lcd_panel_io_t base;
+    HostPanel* self;
+  };
+
+  static HostPanel* from(esp_lcd_panel_t* panel);
+  static HostPanel* from(esp_lcd_panel_io_t* io);
+
+  static esp_err_t panel_noop(esp_lcd_panel_t* panel);
+  static esp_err_t panel_draw_bitmap(esp_lcd_panel_t* panel, int x_start,
+                                     int y_start, int x_end, int y_end,
+                                     const void* color_data);
+  static esp_err_t panel_flag(esp_lcd_panel_t* panel, bool value);
+  static esp_err_t panel_mirror(esp_lcd_panel_t* panel, bool x_axis,
+                                bool y_axis);
+  static esp_err_t panel_set_gap(esp_lcd_panel_t* panel, int x_gap,
+                                 int y_gap);
+  static esp_err_t io_rx_param(esp_lcd_panel_io_t* io, int lcd_cmd,
+                               void* param, size_t param_size);
+  static esp_err_t io_tx_param(esp_lcd_panel_io_t* io, int lcd_cmd,
+                               const void* param, size_t param_size);
+  static esp_err_t io_tx_color(esp_lcd_panel_io_t* io, int lcd_cmd,
+                               const void* color, size_t color_size);
+  static esp_err_t io_del(esp_lcd_panel_io_t* io);
+  static esp_err_t io_register_event_callbacks(
+      esp_lcd_panel_io_t* io, const esp_lcd_panel_io_callbacks_t* cbs,
+      void* user_ctx);
+
+  /** Called by the bus worker once a transfer has been "sent". */
+  void complete(const HostSpiBus::Transfer& transfer);
+
+  HostSpiBus& bus_;
+  int h_res_;
+  int v_res_;
+  std::vector<uint16_t> framebuffer_;
+  esp_lcd_panel_t panel_{};
+  IoShim io_{};
+  esp_lcd_panel_io_callbacks_t callbacks_{};
+  void* callbacks_ctx_ = nullptr;
+  volatile uint32_t submitted_ = 0;
+  volatile uint32_t transfers_ = 0;
+};
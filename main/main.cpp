@@ -2,14 +2,39 @@
 #undef noreturn
 #endif
 
-#include "driver/gpio.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include "esp_heap_caps.h"
 #include "esp_log.h"
-#include "esp_pm.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "hw/host_panel.h"
+#else
+#include "driver/gpio.h"
+#include "esp_pm.h"
 #include "hw/chsc6x.h"
 #include "hw/gc9a01.h"
+#endif
+#include "sys/asset_store.h"
+#include "sys/asset_stream.h"
+#include "sys/bench_console.h"
+#include "sys/boot_metrics.h"
+#include "sys/cpu_monitor.h"
+#include "sys/flush_pipeline.h"
+#include "sys/frame_benchmark.h"
+#include "sys/hot_path_profiler.h"
 #include "sys/lvgl_port.h"
+#include "sys/mem_report.h"
+#include "sys/telemetry.h"
+#include "sys/trace_recorder.h"
+#include "ui/splash_frames.h"
 #include "ui/workshop_ui.h"
 #include "workshop_config.h"
 
@@ -22,6 +47,463 @@
 
 static const char* TAG = "main";
 
+#if !CONFIG_IDF_TARGET_LINUX
+/**
+ * PARALLEL BOOT: Touch bring-up
+ * -----------------------------
+ * The CHSC6X ignores I2C for about a second after power-on. This task waits
+ * out whatever is left of that second, initializes the chip and attaches it
+ * to the already running LVGL port, so the display and the first scene do
+ * not pay for the delay.
+ */
+struct TouchBoot {
+  Chsc6x* touch;
+  LvglPort* port;
+};
+
+static constexpr int64_t TOUCH_POWER_ON_DELAY_US = 1000 * 1000;
+
+static void touch_boot_task(void* arg) {
+  auto* boot = static_cast<TouchBoot*>(arg);
+
+  int64_t remaining_us = TOUCH_POWER_ON_DELAY_US - esp_timer_get_time();
+  if (remaining_us > 0) {
+    vTaskDelay(pdMS_TO_TICKS(remaining_us / 1000) + 1);
+  }
+
+  if (boot->touch->init() == ESP_OK) {
+    LvglPort::Lock guard(*boot->port);
+    boot->port->register_touch_driver(boot->touch);
+    // A touch interrupt lets a suspended static scene stop polling.
+    if (Workshop::STATIC_IDLE_FRAMES > 0 &&
+        boot->touch->enable_interrupt(LvglPort::wake_from_isr, boot->port) ==
+            ESP_OK) {
+      boot->port->set_touch_wakeup(true);
+    }
+    BootMetrics::mark(BootMetrics::Stage::TouchReady);
+    ESP_LOGI(TAG, "Touch attached at %lld ms", esp_timer_get_time() / 1000);
+  } else {
+    ESP_LOGE(TAG, "Touch controller failed to initialize; running without "
+                  "input");
+  }
+
+  vTaskDelete(nullptr);
+}
+#endif  // !CONFIG_IDF_TARGET_LINUX
+
+/**
+ * Time reading every asset's stored bytes through the flash mapping and
+ * decoding it in bounded chunks, as the splash does. raw_read_us_est
+ * scales the measured read rate to the decoded size: what reading the asset
+ * uncompressed would have cost. saved_us is that minus the decode time,
+ * negative where the decoder is slower than the flash it saves.
+ *
+ * Both passes read the same flash lines, so the cache is flushed before
+ * each: otherwise the read pass leaves a small asset cached and the decode
+ * pass is billed for RAM reads instead of flash.
+ */
+static void run_asset_benchmark() {
+  static constexpr size_t kChunk = 4096;
+  // Twice the largest S3 data cache, which flash and PSRAM share.
+  static constexpr size_t kEvictBytes = 128 * 1024;
+  auto* chunk = static_cast<uint8_t*>(
+      heap_caps_malloc(kChunk, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+  auto* evict = static_cast<uint8_t*>(
+      heap_caps_malloc(kEvictBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+  if (!chunk) {
+    heap_caps_free(evict);
+    return;
+  }
+  if (!evict) {
+    ESP_LOGW(TAG, "No PSRAM to flush the cache with: decode times may "
+                  "include cached reads");
+  }
+  auto flush_cache = [evict]() {
+    if (evict) {
+      // Writing every line of the buffer displaces whatever was cached.
+      memset(evict, 0, kEvictBytes);
+    }
+  };
+
+  for (size_t i = 0; i < AssetStore::count(); i++) {
+    const AssetStore::Asset& asset = *AssetStore::at(i);
+
+    flush_cache();
+    int64_t start_us = esp_timer_get_time();
+    for (size_t offset = 0; offset < asset.size; offset += kChunk) {
+      memcpy(chunk, asset.data + offset, std::min(kChunk, asset.size - offset));
+    }
+    const int64_t read_us = esp_timer_get_time() - start_us;
+
+    flush_cache();
+    start_us = esp_timer_get_time();
+    AssetStream stream(asset);
+    if (stream.init() == ESP_OK) {
+      while (stream.read(chunk, kChunk) == kChunk) {
+      }
+    }
+    const int64_t decode_us = esp_timer_get_time() - start_us;
+
+    const int64_t raw_read_us_est =
+        asset.size ? read_us * (int64_t)asset.raw_size / (int64_t)asset.size
+                   : 0;
+    Telemetry::emit(
+        "asset_bench",
+        "name=%s compression=%u size=%u raw_size=%u ratio=%.2f read_us=%lld "
+        "decode_us=%lld read_mbps=%.1f decode_mbps=%.1f raw_read_us_est=%lld "
+        "saved_us=%lld verified=%d",
+        asset.name, (unsigned)asset.compression, (unsigned)asset.size,
+        (unsigned)asset.raw_size,
+        asset.size ? (float)asset.raw_size / asset.size : 0.0f, read_us,
+        decode_us, read_us ? (float)asset.size / read_us : 0.0f,
+        decode_us ? (float)asset.raw_size / decode_us : 0.0f, raw_read_us_est,
+        raw_read_us_est - decode_us, stream.verified() ? 1 : 0);
+  }
+  heap_caps_free(evict);
+  heap_caps_free(chunk);
+}
+
+/**
+ * Swap a scene for its pre-rendered clip ("clip_<animal>" in the asset
+ * partition), or hand the panel back to LVGL if it has none. Call with the
+ * LVGL lock held.
+ */
+static void play_scene_clip(LvglPort& port, WorkshopUI::Animal animal) {
+  char name[32];
+  snprintf(name, sizeof(name), "clip_%s", WorkshopUI::animal_name(animal));
+  const AssetStore::Asset* clip = AssetStore::find(name);
+  if (!clip || clip->format != AssetStore::Format::Clip) {
+    port.stop_clip();
+    return;
+  }
+  esp_err_t err = port.play_clip(clip->data, clip->size);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Cannot play %s: %s", name, esp_err_to_name(err));
+  }
+}
+
+#if CONFIG_WORKSHOP_CLIP_CAPTURE
+/**
+ * Step one scene through its animation loop with the virtual clock and
+ * append the host panel to clip_<animal>.raw after every frame, for
+ * tools/bake_clip.py. The period is fitted to the loop, so the last frame
+ * leads seamlessly back into the first.
+ */
+static void capture_clip(LvglPort& port, WorkshopUI& ui,
+                         const HostPanel& panel) {
+  const auto* animal = std::find_if(
+      std::begin(WorkshopUI::kAnimals), std::end(WorkshopUI::kAnimals),
+      [](WorkshopUI::Animal a) {
+        return strcmp(WorkshopUI::animal_name(a), Workshop::CLIP_ANIMAL) == 0;
+      });
+  if (animal == std::end(WorkshopUI::kAnimals)) {
+    ESP_LOGE(TAG, "No scene named '%s'", Workshop::CLIP_ANIMAL);
+    exit(1);
+  }
+  {
+    LvglPort::Lock guard(port);
+    ui.show(*animal);
+  }
+
+  const uint32_t loop_ms = WorkshopUI::loop_ms(*animal);
+  const uint32_t frames =
+      std::max<uint32_t>(1, loop_ms * Workshop::CLIP_FPS / 1000);
+  char path[48];
+  snprintf(path, sizeof(path), "clip_%s.raw", Workshop::CLIP_ANIMAL);
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    ESP_LOGE(TAG, "Cannot create %s", path);
+    exit(1);
+  }
+
+  FrameBenchmark bench(port);
+  bench.set_frame_period_us(loop_ms * 1000 / frames);
+  bench.run(frames, [&](uint32_t frame) {
+    // lv_refr_now() only queued the last transfer.
+    while (!panel.idle()) {
+      vTaskDelay(1);
+    }
+    fwrite(panel.framebuffer().data(), sizeof(uint16_t),
+           panel.framebuffer().size(), f);
+  });
+  fclose(f);
+
+  ESP_LOGI(TAG, "Captured %u frames of %s to %s", (unsigned)frames,
+           Workshop::CLIP_ANIMAL, path);
+  Telemetry::emit("clip_capture", "animal=%s frames=%u loop_ms=%u path=%s",
+                  Workshop::CLIP_ANIMAL, (unsigned)frames, (unsigned)loop_ms,
+                  path);
+  exit(0);
+}
+#endif  // CONFIG_WORKSHOP_CLIP_CAPTURE
+
+#if CONFIG_WORKSHOP_CLIP_PLAYBACK && CONFIG_IDF_TARGET_LINUX
+/**
+ * Show the first scene that has a clip and play the clip through one whole
+ * loop and on into the next, then print what the host panel shows: the
+ * frame index, how many transfers playback made and the framebuffer
+ * checksum, which must match the captured frame (pytest_clip_capture.py).
+ * Stopping the clip prints its TLM clip record; normal playback takes over
+ * afterwards.
+ */
+static void check_clip_playback(LvglPort& port, WorkshopUI& ui,
+                                const HostPanel& panel) {
+  const auto* animal = std::find_if(
+      std::begin(WorkshopUI::kAnimals), std::end(WorkshopUI::kAnimals),
+      [](WorkshopUI::Animal a) {
+        char name[32];
+        snprintf(name, sizeof(name), "clip_%s", WorkshopUI::animal_name(a));
+        return AssetStore::find(name) != nullptr;
+      });
+  if (animal == std::end(WorkshopUI::kAnimals)) {
+    return;
+  }
+
+  uint32_t base_transfers = 0;
+  {
+    LvglPort::Lock guard(port);
+    ui.show(*animal);
+    // LVGL's own transfers must land before counting the clip's.
+    while (!panel.idle()) {
+      vTaskDelay(1);
+    }
+    base_transfers = panel.transfers();
+    play_scene_clip(port, *animal);
+    if (!port.clip_playing()) {
+      return;
+    }
+  }
+
+  LvglPort::ClipPosition pos;
+  while (true) {
+    vTaskDelay(pdMS_TO_TICKS(10));
+    LvglPort::Lock guard(port);
+    // The key frame plus one delta per frame closes the loop.
+    if (!port.clip_position(&pos) || pos.sent <= pos.frames + 1) {
+      continue;
+    }
+    while (!panel.idle()) {
+      vTaskDelay(1);
+    }
+    Telemetry::emit("clip_check",
+                    "frame=%u sent=%u transfers=%u checksum=0x%08x",
+                    (unsigned)pos.frame, (unsigned)pos.sent,
+                    (unsigned)(panel.transfers() - base_transfers),
+                    (unsigned)panel.checksum());
+    port.stop_clip();
+    return;
+  }
+}
+#endif  // CONFIG_WORKSHOP_CLIP_PLAYBACK && CONFIG_IDF_TARGET_LINUX
+
+/**
+ * Run the stress scene with 1, 2, 4, ... STRESS_MAX_SPRITES sprites and
+ * report how frame time, invalidated area, animation CPU and heap grow
+ * with the sprite count.
+ */
+static void run_stress_sweep(LvglPort& port, WorkshopUI& ui,
+                             FrameBenchmark& bench) {
+  for (uint32_t count = 1; count <= Workshop::STRESS_MAX_SPRITES;
+       count *= 2) {
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    {
+      LvglPort::Lock guard(port);
+      ui.show_stress(count);
+    }
+    auto result = bench.run(Workshop::BENCHMARK_FRAMES);
+
+    const uint32_t frames = result.frames ? result.frames : 1;
+    Telemetry::emit("stress",
+                    "phase=%d sprites=%u frames=%u ms_per_frame=%.2f "
+                    "fps=%.1f max_ms=%.2f render_ms=%.2f flush_ms=%.2f "
+                    "anim_ms=%.3f dirty_px=%llu flushed_px=%llu heap_bytes=%u",
+                    WORKSHOP_PHASE, (unsigned)count, (unsigned)result.frames,
+                    result.ms_per_frame(), result.fps(),
+                    result.max_us / 1000.0f,
+                    result.render_us / 1000.0f / frames,
+                    result.flush_us / 1000.0f / frames,
+                    result.anim_us / 1000.0f / frames,
+                    (unsigned long long)(result.dirty_px / frames),
+                    (unsigned long long)(result.flushed_px / frames),
+                    (unsigned)result.heap_bytes(free_before));
+  }
+
+  LvglPort::Lock guard(port);
+  ui.show(WorkshopUI::kAnimals[0]);
+}
+
+/**
+ * Time every kind of scene change (cut, slide, crossfade) between each pair
+ * of neighbouring scenes. The change is started from the hook after the
+ * first frame, so the record covers one frame of the outgoing scene, the
+ * frame that rebuilds the scene (and takes the snapshot) and every frame
+ * of the transition; max_ms is the switch spike. With the event trace on,
+ * the transitions get a capture of their own, where the snapshot and
+ * rebuild spans sit between the frames around them.
+ */
+static void run_transition_benchmark(LvglPort& port, WorkshopUI& ui,
+                                     FrameBenchmark& bench) {
+  using Transition = WorkshopUI::Transition;
+  const uint32_t period_ms = bench.frame_period_us() / 1000;
+  const uint32_t frames = Workshop::TRANSITION_MS / period_ms + 3;
+  const size_t count = std::size(WorkshopUI::kAnimals);
+
+  TraceRecorder::start();
+
+  for (Transition kind :
+       {Transition::Cut, Transition::Slide, Transition::Crossfade}) {
+    for (size_t i = 0; i < count; i++) {
+      const auto from = WorkshopUI::kAnimals[i];
+      const auto to = WorkshopUI::kAnimals[(i + 1) % count];
+      {
+        LvglPort::Lock guard(port);
+        ui.show(from);
+      }
+      auto result = bench.run(frames, [&](uint32_t frame) {
+        if (frame == 0) {
+          ui.transition_to(to, kind, Workshop::TRANSITION_MS);
+        }
+      });
+
+      const auto& stats = ui.last_transition();
+      const uint32_t n = result.frames ? result.frames : 1;
+      Telemetry::emit(
+          "transition",
+          "kind=%s from=%s to=%s duration_ms=%u frames=%u ms_per_frame=%.2f "
+          "max_ms=%.2f render_ms=%.2f flush_ms=%.2f flushed_px=%llu "
+          "snapshot_ms=%.2f rebuild_ms=%.2f snapshot_kb=%u",
+          WorkshopUI::transition_name(kind), WorkshopUI::animal_name(from),
+          WorkshopUI::animal_name(to), (unsigned)Workshop::TRANSITION_MS,
+          (unsigned)result.frames, result.ms_per_frame(),
+          result.max_us / 1000.0f, result.render_us / 1000.0f / n,
+          result.flush_us / 1000.0f / n,
+          (unsigned long long)(result.flushed_px / n),
+          stats.snapshot_us / 1000.0f, stats.rebuild_us / 1000.0f,
+          (unsigned)(stats.snapshot_bytes / 1024));
+    }
+  }
+  TraceRecorder::stop();
+  TraceRecorder::dump();
+
+  LvglPort::Lock guard(port);
+  ui.show(WorkshopUI::kAnimals[0]);
+}
+
+/**
+ * Time the whale with and without its bitmap cache in the same run, so the
+ * two differ only in the cache, and emit both as one TLM bitmap_cache_ab
+ * record.
+ */
+static void run_bitmap_cache_ab(LvglPort& port, WorkshopUI& ui,
+                                FrameBenchmark& bench) {
+  float ms_per_frame[2] = {};  // Uncached, cached.
+  uint32_t frames = 0;
+  for (bool cached : {false, true}) {
+    {
+      LvglPort::Lock guard(port);
+      ui.set_cache_as_bitmap(cached);
+      ui.show(WorkshopUI::Animal::Whale);
+    }
+    auto result = bench.run(Workshop::BENCHMARK_FRAMES);
+    ms_per_frame[cached] = result.ms_per_frame();
+    frames = result.frames;
+  }
+  Telemetry::emit("bitmap_cache_ab",
+                  "animal=whale frames=%u uncached_ms=%.2f cached_ms=%.2f "
+                  "speedup=%.2f",
+                  (unsigned)frames, ms_per_frame[0], ms_per_frame[1],
+                  ms_per_frame[1] > 0 ? ms_per_frame[0] / ms_per_frame[1]
+                                      : 0.0f);
+}
+
+/**
+ * Render every animal with the deterministic benchmark and report the
+ * results as telemetry. In stack calibration mode, stacks and heaps are
+ * sampled while the scenes render and a stack size is recommended.
+ */
+static void run_boot_benchmark(LvglPort& port, WorkshopUI& ui) {
+  MemReport mem;
+  FrameBenchmark bench(port);
+  bench.set_full_redraw(Workshop::BENCHMARK_FULL_REDRAW);
+
+  // flush_cb's pixel transform on its own, one strip per pass.
+  benchmark_flush_pipeline(Workshop::H_RES * Workshop::STRIP_LINES, 200);
+
+  // Heaps are sampled from a task of their own, so the LVGL task's stack
+  // only holds what rendering needs.
+  if (Workshop::STACK_CALIBRATION) {
+    mem.start_sampler(10);
+  }
+
+  // The event trace covers the per-animal runs, scene switches included.
+  TraceRecorder::start();
+  for (auto animal : WorkshopUI::kAnimals) {
+    {
+      LvglPort::Lock guard(port);
+      ui.show(animal);
+    }
+    const size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    if (Workshop::HOT_PATH_PROFILING) {
+      HotPathProfiler::reset();
+    }
+
+    auto result = bench.run(Workshop::BENCHMARK_FRAMES);
+
+    result.emit(WorkshopUI::animal_name(animal), WORKSHOP_PHASE, free_before);
+
+    if (const BitmapCache* cache = ui.bitmap_cache()) {
+      const BitmapCache::Stats& stats = cache->stats();
+      Telemetry::emit("bitmap_cache",
+                      "animal=%s frames=%u renders=%u render_ms=%.2f kb=%u",
+                      WorkshopUI::animal_name(animal),
+                      (unsigned)result.frames, (unsigned)stats.renders,
+                      stats.render_us / 1000.0f,
+                      (unsigned)(stats.bytes / 1024));
+    }
+
+    if (Workshop::HOT_PATH_PROFILING) {
+      HotPathProfiler::report(WorkshopUI::animal_name(animal));
+    }
+  }
+
+  TraceRecorder::stop();
+  TraceRecorder::dump();
+
+  if (Workshop::CACHE_AS_BITMAP) {
+    run_bitmap_cache_ab(port, ui, bench);
+  }
+
+  if (Workshop::STRESS_MAX_SPRITES > 0) {
+    run_stress_sweep(port, ui, bench);
+  }
+
+  if (Workshop::TRANSITION_MS > 0) {
+    run_transition_benchmark(port, ui, bench);
+  }
+
+  if (Workshop::STACK_CALIBRATION) {
+    mem.stop_sampler();
+    mem.report();
+
+    // FreeRTOS keeps the lifetime low-water mark, so asking for the LVGL
+    // task's directly covers every frame rendered so far.
+    uint32_t min_free = uxTaskGetStackHighWaterMark(port.get_task_handle());
+    uint32_t recommended = MemReport::recommend_stack(
+        Workshop::LVGL_STACK_SIZE, min_free, Workshop::STACK_MARGIN_PCT);
+    ESP_LOGW(TAG,
+             "LVGL stack: %u configured, %u peak. Recommended "
+             "CONFIG_WORKSHOP_LVGL_STACK_SIZE=%u (+%u%% margin)",
+             (unsigned)Workshop::LVGL_STACK_SIZE,
+             (unsigned)(Workshop::LVGL_STACK_SIZE - min_free),
+             (unsigned)recommended, (unsigned)Workshop::STACK_MARGIN_PCT);
+    Telemetry::emit("stack_recommendation",
+                    "task=lvgl configured=%u peak=%u recommended=%u",
+                    (unsigned)Workshop::LVGL_STACK_SIZE,
+                    (unsigned)(Workshop::LVGL_STACK_SIZE - min_free),
+                    (unsigned)recommended);
+  }
+}
+
 extern "C" void app_main(void) {
   // 0. TELEMETRY & PHASE REPORTING
   // We log the current workshop phase and hardware specs to the console.
@@ -29,6 +511,13 @@ extern "C" void app_main(void) {
   ESP_LOGI(TAG, "CPU: %d MHz, Bus: %d MHz, Memory: %s", Workshop::CPU_FREQ_MHZ,
            (int)(Workshop::SPI_BUS_SPEED / 1000000),
            (Workshop::ALLOC_CAPS & MALLOC_CAP_SPIRAM) ? "PSRAM" : "SRAM");
+  if (Workshop::STACK_RECLAIMED_BYTES > 0) {
+    ESP_LOGI(TAG, "LVGL stack %u bytes below the phase default: %s",
+             (unsigned)Workshop::STACK_RECLAIMED_BYTES,
+             Workshop::STACK_RECLAIMED_TO_STRIPS
+                 ? "added to the partial strips"
+                 : "left on the internal heap (no port-managed strips)");
+  }
 
   // POWER MANAGEMENT (CPU CLOCK SCALING)
   // ------------------------------------
@@ -37,18 +526,38 @@ extern "C" void app_main(void) {
   // Foundation Phases (1-3) run at 160MHz to save power.
   // Expert Phases (4+) boost to 240MHz to handle the parallel overhead of DMA
   // and color conversion without jitter.
+  // With the frame governor, the floor drops to PM_MIN_FREQ_MHZ (optionally
+  // light sleep) and LvglPort holds the maximum only while a frame renders.
+#if !CONFIG_IDF_TARGET_LINUX
+  const bool governed = Workshop::PM_MIN_FREQ_MHZ > 0;
   esp_pm_config_t pm_config = {
       .max_freq_mhz = Workshop::CPU_FREQ_MHZ,
-      .min_freq_mhz = Workshop::CPU_FREQ_MHZ,
-      .light_sleep_enable = false,
+      .min_freq_mhz =
+          governed ? Workshop::PM_MIN_FREQ_MHZ : Workshop::CPU_FREQ_MHZ,
+      .light_sleep_enable = Workshop::PM_LIGHT_SLEEP,
   };
   ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+#endif
 
   // 1. Display Hardware
   // --------------------
   // This Gc9a01 object manages the raw SPI communication. It doesn't know
   // about "buttons" or "animations"—it only knows how to send raw pixel
   // streams to the round LCD glass.
+  // Extra panels (DISPLAY_COUNT > 1, e.g. a pair of eyes) share the SPI bus,
+  // DC line and backlight with the first one and only bring their own CS.
+#if CONFIG_IDF_TARGET_LINUX
+  // Host build: software panels on an emulated SPI bus stand in for the
+  // GC9A01s, so the render loop and the bus arbitration run unchanged.
+  static HostSpiBus host_bus(Workshop::SPI_BUS_SPEED);
+  ESP_ERROR_CHECK(host_bus.init());
+  std::vector<std::unique_ptr<HostPanel>> panels;
+  for (int i = 0; i < Workshop::DISPLAY_COUNT; i++) {
+    panels.push_back(std::make_unique<HostPanel>(host_bus, Workshop::H_RES,
+                                                 Workshop::V_RES));
+    panels.back()->init();
+  }
+#else
   Gc9a01::Config display_cfg = {
       .host = SPI2_HOST,
       .cs_io_num = 2,
@@ -58,49 +567,165 @@ extern "C" void app_main(void) {
       .bl_io_num = 43,
       .pclk_hz =
           Workshop::SPI_BUS_SPEED,  // Speed is managed by workshop_config.h
-      .h_res = 240,
-      .v_res = 240,
+      .h_res = Workshop::H_RES,
+      .v_res = Workshop::V_RES,
   };
-  auto display_hw = std::make_unique<Gc9a01>(display_cfg);
-  display_hw->init();
+  std::vector<std::unique_ptr<Gc9a01>> panels;
+  for (int i = 0; i < Workshop::DISPLAY_COUNT; i++) {
+    Gc9a01::Config cfg = display_cfg;
+    if (i > 0) {
+      cfg.cs_io_num = Workshop::DISPLAY_CS_PINS[i];
+      cfg.bl_io_num = -1;
+      cfg.shared_bus = true;
+    }
+    panels.push_back(std::make_unique<Gc9a01>(cfg));
+    panels.back()->init();
+  }
+#endif
+  auto* display_hw = panels[0].get();
+  BootMetrics::mark(BootMetrics::Stage::DisplayReady);
 
   // 2. Touch Hardware
+#if !CONFIG_IDF_TARGET_LINUX
   Chsc6x::Config touch_cfg = {
       .i2c_port = I2C_NUM_0,
       .sda_io_num = 5,
       .scl_io_num = 6,
       .int_io_num = 44,
       .clk_speed = 400000,
-      .h_res = 240,
-      .v_res = 240,
+      .h_res = Workshop::H_RES,
+      .v_res = Workshop::V_RES,
       .swap_xy = true,
       .mirror_x = true,
       .mirror_y = false,
   };
   auto chsc6x = std::make_unique<Chsc6x>(touch_cfg);
-  // Wait for the touch chip to finish its internal boot (approx 1s).
-  vTaskDelay(pdMS_TO_TICKS(1000));
-  chsc6x->init();
+  // The touch chip needs ~1s after power-on before it answers. Instead of
+  // blocking the boot, a helper task waits for it and attaches the driver
+  // once the port is running (see touch_boot_task).
+#endif
 
   // 3. LVGL Porting Layer
   LvglPort::Config lvgl_config;
-  lvgl_config.h_res = 240;
-  lvgl_config.v_res = 240;
+  lvgl_config.h_res = Workshop::H_RES;
+  lvgl_config.v_res = Workshop::V_RES;
   lvgl_config.task_stack_size = Workshop::LVGL_STACK_SIZE;
+  lvgl_config.strip_lines = Workshop::STRIP_LINES;
+  lvgl_config.bus_clock_hz = Workshop::SPI_BUS_SPEED;
   lvgl_config.task_priority = 5;
   lvgl_config.task_affinity = Workshop::LVGL_TASK_CORE;
+  lvgl_config.recorder_depth = Workshop::FLIGHT_RECORDER_DEPTH;
+  lvgl_config.jank_budget_ms = Workshop::JANK_BUDGET_MS;
+  lvgl_config.heatmap_tile_size = Workshop::HEATMAP_TILE_SIZE;
+  lvgl_config.heatmap_report_frames = Workshop::HEATMAP_REPORT_FRAMES;
+  lvgl_config.image_cache_report_ms = Workshop::IMAGE_CACHE_REPORT_MS;
+  lvgl_config.image_cache_cost_eviction = Workshop::IMAGE_CACHE_COST_EVICTION;
+  lvgl_config.governor_min_mhz = Workshop::PM_MIN_FREQ_MHZ;
+  lvgl_config.governor_max_mhz = Workshop::CPU_FREQ_MHZ;
+  lvgl_config.governor_budget_ms = Workshop::PM_FRAME_BUDGET_MS;
+  lvgl_config.governor_report_ms = Workshop::PM_REPORT_MS;
+  lvgl_config.static_idle_frames = Workshop::STATIC_IDLE_FRAMES;
+  lvgl_config.static_sleep_ms = Workshop::STATIC_SLEEP_MS;
+  lvgl_config.trace_events = Workshop::TRACE_EVENTS;
+  lvgl_config.cpu_monitor_ms = Workshop::CPU_MONITOR_PERIOD_MS;
+  lvgl_config.pacing_max_hz = Workshop::PACING_MAX_HZ;
+  lvgl_config.pacing_headroom_pct = Workshop::PACING_HEADROOM_PCT;
+  lvgl_config.pacing_report_ms = Workshop::PACING_REPORT_MS;
 
   ESP_LOGI(TAG, "Initializing LVGL Port on Core %d", Workshop::LVGL_TASK_CORE);
   auto lvgl_port = std::make_unique<LvglPort>(lvgl_config);
+#if CONFIG_IDF_TARGET_LINUX
+  // The panels share one emulated bus: its clock is the panels' clock.
+  lvgl_port->set_bus_clock_handler(
+      [](size_t, uint32_t hz, esp_lcd_panel_handle_t*,
+         esp_lcd_panel_io_handle_t*) {
+        host_bus.set_pclk_hz(hz);
+        return ESP_OK;
+      });
+#else
+  lvgl_port->set_backlight_handler(
+      [hw = display_hw](bool on) { hw->set_backlight(on); });
+  lvgl_port->set_bus_clock_handler(
+      [&panels](size_t index, uint32_t hz, esp_lcd_panel_handle_t* panel,
+                esp_lcd_panel_io_handle_t* io) {
+        esp_err_t err = panels[index]->set_pclk_hz(hz);
+        *panel = panels[index]->get_panel_handle();
+        *io = panels[index]->get_io_handle();
+        return err;
+      });
+#endif
+
+  // The splash and the scenes read from the asset partition: map it first.
+  // With it, the SVGs are not compiled into the app: without the mapping
+  // there is nothing to render, so stop with the reason in the log.
+  if (Workshop::ASSET_PARTITION) {
+    esp_err_t err = AssetStore::mount();
+    if (err != ESP_OK) {
+      ESP_LOGE(TAG, "Cannot mount the asset partition (%s); the scenes live "
+                    "there. Flash it with `idf.py assets-flash`.",
+               esp_err_to_name(err));
+      abort();
+    }
+    if (Workshop::ASSET_BENCHMARK) {
+      run_asset_benchmark();
+    }
+  }
+
+#if CONFIG_WORKSHOP_SPLASH
+  // Put the baked first frame of the opening scene on the glass while LVGL
+  // and ThorVG start up. The first real flush replaces it.
+  bool splash_shown = false;
+#if CONFIG_WORKSHOP_ASSET_PARTITION
+  // Packed into the asset partition, maybe compressed: decode it chunk by
+  // chunk straight into the bounce buffers.
+  char splash_name[32];
+  snprintf(splash_name, sizeof(splash_name), "splash_%s",
+           WorkshopUI::animal_name(WorkshopUI::kAnimals[0]));
+  if (const AssetStore::Asset* splash = AssetStore::find(splash_name)) {
+    AssetStream stream(*splash);
+    splash_shown =
+        stream.init() == ESP_OK &&
+        lvgl_port->show_splash(display_hw->get_panel_handle(),
+                               display_hw->get_io_handle(), splash->raw_size,
+                               [&stream](uint8_t* dst, size_t len) {
+                                 return stream.read(dst, len) == len;
+                               });
+  }
+#else
+  size_t splash_size = 0;
+  const uint8_t* splash = splash_frame(WorkshopUI::kAnimals[0], &splash_size);
+  splash_shown = lvgl_port->show_splash(display_hw->get_panel_handle(),
+                                        display_hw->get_io_handle(), splash,
+                                        splash_size);
+#endif
+  if (splash_shown) {
+    BootMetrics::mark(BootMetrics::Stage::FirstPixel);
+  }
+#endif
+
   lvgl_port->init(display_hw->get_panel_handle(), display_hw->get_io_handle());
+  for (size_t i = 1; i < panels.size(); i++) {
+    lvgl_port->add_display(panels[i]->get_panel_handle(),
+                           panels[i]->get_io_handle());
+  }
+  BootMetrics::mark(BootMetrics::Stage::PortReady);
 
-  lvgl_port->register_touch_driver(chsc6x.get());
+#if CONFIG_IDF_TARGET_LINUX
+  // No touch controller on the host.
+  BootMetrics::mark(BootMetrics::Stage::TouchReady);
+#else
+  // Touch comes up in parallel with the first scene.
+  static TouchBoot touch_boot = {chsc6x.get(), lvgl_port.get()};
+  xTaskCreate(touch_boot_task, "touch_boot", 4096, &touch_boot, 4, nullptr);
+#endif
 
   // 4. UI Layer
   // -----------
-  // Now that the foundations (Display, Touch, Port) are ready, we build the
-  // visual world.
-  static WorkshopUI ui;
+  // Now that the foundations (Display, Port) are ready, we build the visual
+  // world. Touch joins whenever the chip is ready. Every display gets its
+  // own scene; touch and the benchmark drive the first one.
+  static WorkshopUI uis[Workshop::DISPLAY_COUNT];
+  WorkshopUI& ui = uis[0];
 
   // CRITICAL: Since the LvglPort task is already running in the background,
   // we MUST lock the mutex before creating or modifying any UI elements.
@@ -108,13 +733,68 @@ extern "C" void app_main(void) {
   // attempts to draw an object that is only half-initialized.
   {
     LvglPort::Lock guard(*lvgl_port);
-    if (auto* display = lvgl_port->get_display()) {
-      ui.init(*display);
+    for (size_t i = 0; i < lvgl_port->display_count(); i++) {
+      if (auto* display = lvgl_port->get_display(i)) {
+        uis[i].init(*display);
+        uis[i].set_transition(Workshop::TRANSITION_CROSSFADE
+                                  ? WorkshopUI::Transition::Crossfade
+                                  : WorkshopUI::Transition::Slide,
+                              Workshop::TRANSITION_MS);
+      }
     }
   }
+  BootMetrics::mark(BootMetrics::Stage::UiReady);
+
+#if CONFIG_WORKSHOP_CLIP_CAPTURE
+  capture_clip(*lvgl_port, ui, *display_hw);
+#endif
+
+#if CONFIG_WORKSHOP_CPU_MONITOR_SELFTEST
+  // The host has one core: check the migration accounting on a script.
+  CpuMonitor::check_placement();
+#endif
+
+  if (Workshop::BENCHMARK_FRAMES > 0) {
+    run_boot_benchmark(*lvgl_port, ui);
+  }
 
-  // The main task remains running for system maintenance.
+#if CONFIG_WORKSHOP_CLIP_PLAYBACK && CONFIG_IDF_TARGET_LINUX
+  if (AssetStore::mounted()) {
+    check_clip_playback(*lvgl_port, ui, *display_hw);
+  }
+#endif
+
+  // From here on, scenes with a pre-rendered clip play it instead.
+  if (Workshop::CLIP_PLAYBACK && AssetStore::mounted()) {
+    LvglPort::Lock guard(*lvgl_port);
+    ui.set_scene_hook([port = lvgl_port.get()](WorkshopUI::Animal animal) {
+      play_scene_clip(*port, animal);
+    });
+    play_scene_clip(*lvgl_port, ui.current_animal());
+  }
+
+  // Interactive experiments (bench, phase, strip, spi, ...) from here on.
+  if (Workshop::CONSOLE) {
+    static BenchConsole console(*lvgl_port, ui);
+    console.start();
+  }
+
+  // The main task remains running for system maintenance: it prints any
+  // diagnostics the render path deferred (jank snapshots, heatmaps) and the
+  // boot metrics once every milestone has been reached.
+  bool boot_reported = false;
   while (1) {
+    if (!boot_reported && lvgl_port->first_flush_us() != 0) {
+      BootMetrics::mark_at(BootMetrics::Stage::FirstPixel,
+                           lvgl_port->first_flush_us());
+      BootMetrics::mark_at(BootMetrics::Stage::FirstFrame,
+                           lvgl_port->first_flush_us());
+      if (BootMetrics::complete()) {
+        BootMetrics::report();
+        boot_reported = true;
+      }
+    }
+    lvgl_port->poll_diagnostics();
     vTaskDelay(pdMS_TO_TICKS(1000));
   }
 }
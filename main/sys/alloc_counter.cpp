@@ -0,0 +1,77 @@
+#include "sys/alloc_counter.h"
+
+#include <atomic>
+#include <cstddef>
+
+#include "esp_attr.h"
+#include "sdkconfig.h"
+
+/**
+ * ALLOCATION COUNTER: Implementation
+ * ----------------------------------
+ * The hooks run inside the allocator, possibly with the flash cache
+ * disabled, so they only bump two lock-free counters and live in IRAM. On
+ * the host, realloc() counts as an allocation only when it acts as
+ * malloc(); resizing in place or moving a block is the allocator's business.
+ */
+
+namespace {
+
+std::atomic<uint32_t> alloc_count{0};
+std::atomic<uint32_t> free_count{0};
+
+}  // namespace
+
+uint32_t AllocCounter::allocs() {
+  return alloc_count.load(std::memory_order_relaxed);
+}
+
+uint32_t AllocCounter::frees() {
+  return free_count.load(std::memory_order_relaxed);
+}
+
+#if CONFIG_WORKSHOP_ALLOC_COUNTING
+#if CONFIG_IDF_TARGET_LINUX
+extern "C" {
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+  return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  if (!ptr) {
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void* ptr) {
+  if (ptr) {
+    free_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  __real_free(ptr);
+}
+
+}  // extern "C"
+#else
+extern "C" IRAM_ATTR void esp_heap_trace_alloc_hook(void* ptr, size_t size,
+                                                    uint32_t caps) {
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" IRAM_ATTR void esp_heap_trace_free_hook(void* ptr) {
+  free_count.fetch_add(1, std::memory_order_relaxed);
+}
+#endif  // CONFIG_IDF_TARGET_LINUX
+#endif  // CONFIG_WORKSHOP_ALLOC_COUNTING
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * ALLOCATION COUNTER
+ * ------------------
+ * Heap allocations and frees since boot, from every task. A frame that
+ * allocates (LVGL draw tasks, ThorVG scratch, layers) pays for the
+ * allocator and fragments internal RAM long before that shows up in
+ * ms/frame, so the benchmark reports allocations per run and the perf
+ * suite gates on them.
+ *
+ * On the chip the counts come from the heap's allocation hooks
+ * (CONFIG_HEAP_USE_HOOKS), on the host from malloc wrappers linked in with
+ * --wrap. Without WORKSHOP_ALLOC_COUNTING both stay 0.
+ */
+namespace AllocCounter {
+
+uint32_t allocs();
+uint32_t frees();
+
+}  // namespace AllocCounter
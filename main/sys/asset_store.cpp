@@ -0,0 +1,208 @@
+#include "sys/asset_store.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "sys/telemetry.h"
+
+static const char* TAG = "AssetStore";
+
+/**
+ * ASSET PARTITION: Implementation
+ * -------------------------------
+ * Only the 16-byte header is read with esp_partition_read(); the index and
+ * the data are used in place through one mapping of exactly the blob size.
+ * The index CRC catches an erased or half-written partition without
+ * touching the (potentially large) data.
+ */
+
+namespace {
+
+constexpr uint32_t kMagic = 0x53415357;  // "WSAS"
+constexpr uint16_t kVersion = 2;
+
+struct __attribute__((packed)) BlobHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+  uint32_t size;
+  uint32_t index_crc;
+};
+
+struct __attribute__((packed)) BlobEntry {
+  char name[32];
+  uint32_t offset;
+  uint32_t size;
+  uint32_t raw_size;
+  uint32_t raw_crc;
+  uint16_t width;
+  uint16_t height;
+  uint8_t format;
+  uint8_t compression;
+  uint8_t pad[2];
+};
+
+static_assert(sizeof(BlobHeader) == 16, "header layout");
+static_assert(sizeof(BlobEntry) == 56, "index entry layout");
+
+bool header_valid(const BlobHeader& header, size_t partition_size) {
+  return header.magic == kMagic && header.version == kVersion &&
+         header.size <= partition_size &&
+         sizeof(BlobHeader) + (size_t)header.count * sizeof(BlobEntry) <=
+             header.size;
+}
+
+}  // namespace
+
+const uint8_t* AssetStore::base_ = nullptr;
+esp_partition_mmap_handle_t AssetStore::mmap_handle_ = 0;
+AssetStore::Asset AssetStore::assets_[kMaxAssets];
+size_t AssetStore::count_ = 0;
+
+esp_err_t AssetStore::mount(const char* label) {
+  if (base_) {
+    return ESP_OK;
+  }
+  const int64_t start_us = esp_timer_get_time();
+
+  const esp_partition_t* partition = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (!partition) {
+    ESP_LOGE(TAG, "No '%s' partition in the partition table", label);
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  esp_err_t err = ESP_OK;
+#if CONFIG_IDF_TARGET_LINUX
+  // The emulated flash starts out erased: copy in the freshly packed blob.
+  err = provision(partition);
+  if (err != ESP_OK) {
+    return err;
+  }
+#endif
+
+  // 1. Header
+  BlobHeader header;
+  err = esp_partition_read(partition, 0, &header, sizeof(header));
+  if (err != ESP_OK || !header_valid(header, partition->size)) {
+    ESP_LOGE(TAG, "Partition '%s' holds no asset blob (idf.py assets-flash)",
+             label);
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (header.count > kMaxAssets) {
+    ESP_LOGE(TAG, "%u assets, at most %u supported", (unsigned)header.count,
+             (unsigned)kMaxAssets);
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  // 2. Map exactly the blob
+  const void* mapped = nullptr;
+  err = esp_partition_mmap(partition, 0, header.size, ESP_PARTITION_MMAP_DATA,
+                           &mapped, &mmap_handle_);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "mmap failed: %s", esp_err_to_name(err));
+    return err;
+  }
+  const auto* blob = static_cast<const uint8_t*>(mapped);
+  const auto* entries =
+      reinterpret_cast<const BlobEntry*>(blob + sizeof(BlobHeader));
+
+  // 3. Validate and index
+  const size_t index_size = header.count * sizeof(BlobEntry);
+  if (esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(entries),
+                       index_size) != header.index_crc) {
+    ESP_LOGE(TAG, "Asset index CRC mismatch");
+    esp_partition_munmap(mmap_handle_);
+    return ESP_ERR_INVALID_CRC;
+  }
+  for (size_t i = 0; i < header.count; i++) {
+    const BlobEntry& e = entries[i];
+    if (e.offset > header.size || e.size > header.size - e.offset ||
+        e.name[sizeof(e.name) - 1] != '\0') {
+      ESP_LOGE(TAG, "Asset %u is corrupt", (unsigned)i);
+      esp_partition_munmap(mmap_handle_);
+      return ESP_ERR_INVALID_STATE;
+    }
+    assets_[i] = {e.name,
+                  blob + e.offset,
+                  e.size,
+                  e.raw_size,
+                  e.raw_crc,
+                  e.width,
+                  e.height,
+                  (Format)e.format,
+                  (Compression)e.compression};
+  }
+  count_ = header.count;
+  base_ = blob;
+
+  const int64_t mount_us = esp_timer_get_time() - start_us;
+  size_t raw_bytes = 0;
+  for (size_t i = 0; i < count_; i++) raw_bytes += assets_[i].raw_size;
+  ESP_LOGI(TAG, "Mapped %u assets (%u bytes, %u decoded) from '%s' in %lld us",
+           (unsigned)count_, (unsigned)header.size, (unsigned)raw_bytes, label,
+           mount_us);
+  Telemetry::emit("assets",
+                  "count=%u bytes=%u raw_bytes=%u partition=%u mount_us=%lld",
+                  (unsigned)count_, (unsigned)header.size, (unsigned)raw_bytes,
+                  (unsigned)partition->size, mount_us);
+  return ESP_OK;
+}
+
+void AssetStore::unmount() {
+  if (!base_) {
+    return;
+  }
+  esp_partition_munmap(mmap_handle_);
+  base_ = nullptr;
+  count_ = 0;
+}
+
+const AssetStore::Asset* AssetStore::find(const char* name) {
+  for (size_t i = 0; i < count_; i++) {
+    if (strcmp(assets_[i].name, name) == 0) {
+      return &assets_[i];
+    }
+  }
+  return nullptr;
+}
+
+esp_err_t AssetStore::provision(const esp_partition_t* partition) {
+#ifdef WORKSHOP_ASSET_BLOB_PATH
+  FILE* f = fopen(WORKSHOP_ASSET_BLOB_PATH, "rb");
+  if (!f) {
+    ESP_LOGE(TAG, "Cannot open %s", WORKSHOP_ASSET_BLOB_PATH);
+    return ESP_ERR_NOT_FOUND;
+  }
+  std::vector<uint8_t> blob;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+    blob.insert(blob.end(), chunk, chunk + n);
+  }
+  fclose(f);
+  if (blob.size() > partition->size) {
+    ESP_LOGE(TAG, "Blob (%u bytes) exceeds the partition",
+             (unsigned)blob.size());
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  const size_t erase_size =
+      (blob.size() + partition->erase_size - 1) / partition->erase_size *
+      partition->erase_size;
+  esp_err_t err = esp_partition_erase_range(partition, 0, erase_size);
+  if (err == ESP_OK) {
+    err = esp_partition_write(partition, 0, blob.data(), blob.size());
+  }
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Provisioning failed: %s", esp_err_to_name(err));
+  }
+  return err;
+#else
+  return ESP_OK;
+#endif
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+#include "esp_partition.h"
+
+/**
+ * ASSET PARTITION
+ * ---------------
+ * The SVGs used to be compiled into the app as string literals, so every
+ * asset change meant a full rebuild and reflash and the app image grew with
+ * every scene. tools/pack_assets.py now packs them into an indexed blob
+ * that lives in its own data partition ("assets" in partitions.csv) and is
+ * flashed on its own with `idf.py assets-flash`.
+ *
+ * mount() maps the blob with esp_partition_mmap(); find() returns pointers
+ * into that mapping, which go straight into lvgl::ImageDescriptor. Nothing
+ * is copied to RAM: ThorVG reads the SVG through the flash cache exactly
+ * as it read the old .rodata strings. Compressed assets are decoded from
+ * the mapping by AssetStream instead.
+ *
+ * On the linux target, ESP-IDF emulates the partition table in a host file.
+ * mount() provisions the emulated partition from the blob the build just
+ * packed (WORKSHOP_ASSET_BLOB_PATH), then maps it the same way.
+ *
+ * The layout is documented in tools/pack_assets.py.
+ */
+class AssetStore {
+ public:
+  enum class Format : uint8_t {
+    Svg = 0,            // NUL-terminated SVG document; raw_size counts it.
+    Rgb565Swapped = 1,  // RGB565 frame in panel byte order.
+    Clip = 2,           // Animation clip, see sys/clip.h.
+  };
+
+  enum class Compression : uint8_t {
+    None = 0,
+    Deflate = 1,  // Raw deflate; read it through AssetStream.
+  };
+
+  struct Asset {
+    const char* name;
+    const uint8_t* data;  // Stored bytes, inside the flash mapping.
+    size_t size;          // Stored size.
+    size_t raw_size;      // Decoded size.
+    uint32_t raw_crc;     // CRC-32 of the decoded bytes.
+    uint16_t width;       // 0 for vector formats.
+    uint16_t height;
+    Format format;
+    Compression compression;
+
+    /** True if `data` can be used in place (zero-copy). */
+    bool stored() const { return compression == Compression::None; }
+  };
+
+  /**
+   * Map the asset partition and validate its index.
+   * @param label Partition label.
+   * @return ESP_OK, ESP_ERR_NOT_FOUND without a partition or
+   *         ESP_ERR_INVALID_STATE if it holds no valid blob.
+   */
+  static esp_err_t mount(const char* label = "assets");
+
+  /** Unmap the partition. Pointers from find() become invalid. */
+  static void unmount();
+
+  static bool mounted() { return base_ != nullptr; }
+
+  /** Look an asset up by name, or nullptr if it is not in the blob. */
+  static const Asset* find(const char* name);
+
+  static size_t count() { return count_; }
+
+  /** The asset at `index` (< count()) in index order. */
+  static const Asset* at(size_t index) {
+    return index < count_ ? &assets_[index] : nullptr;
+  }
+
+ private:
+  static constexpr size_t kMaxAssets = 64;
+
+  static esp_err_t provision(const esp_partition_t* partition);
+
+  static const uint8_t* base_;
+  static esp_partition_mmap_handle_t mmap_handle_;
+  static Asset assets_[kMaxAssets];
+  static size_t count_;
+};
@@ -0,0 +1,258 @@
+#include "sys/asset_stream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "sdkconfig.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <zlib.h>
+#else
+#include "miniz.h"
+#endif
+
+static const char* TAG = "AssetStream";
+
+/**
+ * ASSET STREAM: Implementation
+ * ----------------------------
+ * tinfl writes into a circular 32 KB window and may stop with output still
+ * pending in it; read() hands that out before decoding more. zlib keeps
+ * its own window and writes into the caller's buffer directly.
+ *
+ * load() runs tinfl in non-wrapping mode with the destination as the
+ * output buffer: back-references then point into the destination itself,
+ * so no separate window is needed.
+ */
+
+#if CONFIG_IDF_TARGET_LINUX
+
+struct AssetStream::Decoder {
+  z_stream zs{};
+  bool open = false;
+};
+
+esp_err_t AssetStream::init() {
+  if (asset_.stored()) {
+    return ESP_OK;
+  }
+  decoder_ = new Decoder();
+  if (inflateInit2(&decoder_->zs, -15) != Z_OK) {
+    return ESP_ERR_NO_MEM;
+  }
+  decoder_->open = true;
+  return ESP_OK;
+}
+
+AssetStream::~AssetStream() {
+  if (decoder_) {
+    if (decoder_->open) inflateEnd(&decoder_->zs);
+    delete decoder_;
+  }
+}
+
+size_t AssetStream::inflate(uint8_t* dst, size_t len) {
+  z_stream& zs = decoder_->zs;
+  zs.next_out = dst;
+  zs.avail_out = len;
+  while (zs.avail_out > 0) {
+    const size_t in_bytes = std::min(kInputChunk, (size_t)(in_end_ - in_));
+    zs.next_in = const_cast<uint8_t*>(in_);
+    zs.avail_in = in_bytes;
+    int ret = ::inflate(&zs, Z_NO_FLUSH);
+    in_ += in_bytes - zs.avail_in;
+    if (ret == Z_STREAM_END) {
+      break;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      failed_ = true;
+      break;
+    }
+    if (ret == Z_BUF_ERROR && in_ == in_end_) {
+      failed_ = true;  // Truncated stream.
+      break;
+    }
+  }
+  return len - zs.avail_out;
+}
+
+uint8_t* AssetStream::load(const AssetStore::Asset& asset, uint32_t caps) {
+  auto* out = static_cast<uint8_t*>(heap_caps_malloc(asset.raw_size, caps));
+  if (!out) {
+    return nullptr;
+  }
+  AssetStream stream(asset);
+  if (stream.init() != ESP_OK ||
+      stream.read(out, asset.raw_size) != asset.raw_size ||
+      !stream.verified()) {
+    ESP_LOGE(TAG, "Failed to decode '%s'", asset.name);
+    heap_caps_free(out);
+    return nullptr;
+  }
+  return out;
+}
+
+#else  // tinfl from ROM
+
+struct AssetStream::Decoder {
+  tinfl_decompressor tinfl;
+  uint8_t* window = nullptr;  // TINFL_LZ_DICT_SIZE bytes, circular.
+  size_t window_pos = 0;      // Where tinfl writes next.
+  size_t pending_pos = 0;     // Decoded bytes not handed out yet...
+  size_t pending_len = 0;     // ...and how many.
+  bool end = false;
+};
+
+esp_err_t AssetStream::init() {
+  if (asset_.stored()) {
+    return ESP_OK;
+  }
+  decoder_ = static_cast<Decoder*>(
+      heap_caps_calloc(1, sizeof(Decoder), MALLOC_CAP_DEFAULT));
+  if (!decoder_) {
+    return ESP_ERR_NO_MEM;
+  }
+  // The window is hit for every back-reference: internal RAM if possible.
+  decoder_->window = static_cast<uint8_t*>(heap_caps_malloc(
+      TINFL_LZ_DICT_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+  if (!decoder_->window) {
+    decoder_->window = static_cast<uint8_t*>(
+        heap_caps_malloc(TINFL_LZ_DICT_SIZE, MALLOC_CAP_DEFAULT));
+  }
+  if (!decoder_->window) {
+    return ESP_ERR_NO_MEM;
+  }
+  tinfl_init(&decoder_->tinfl);
+  return ESP_OK;
+}
+
+AssetStream::~AssetStream() {
+  if (decoder_) {
+    heap_caps_free(decoder_->window);
+    heap_caps_free(decoder_);
+  }
+}
+
+size_t AssetStream::inflate(uint8_t* dst, size_t len) {
+  Decoder& d = *decoder_;
+  size_t written = 0;
+  while (written < len) {
+    // 1. Hand out what the last call left in the window.
+    if (d.pending_len > 0) {
+      const size_t n = std::min(len - written, d.pending_len);
+      memcpy(dst + written, d.window + d.pending_pos, n);
+      d.pending_pos += n;
+      d.pending_len -= n;
+      written += n;
+      continue;
+    }
+    if (d.end || failed_) {
+      break;
+    }
+
+    // 2. Decode the next bounded input chunk into the window.
+    size_t in_bytes = std::min(kInputChunk, (size_t)(in_end_ - in_));
+    size_t out_bytes = TINFL_LZ_DICT_SIZE - d.window_pos;
+    const bool more_input = in_ + in_bytes < in_end_;
+    tinfl_status status = tinfl_decompress(
+        &d.tinfl, in_, &in_bytes, d.window, d.window + d.window_pos,
+        &out_bytes, more_input ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+    in_ += in_bytes;
+    d.pending_pos = d.window_pos;
+    d.pending_len = out_bytes;
+    d.window_pos = (d.window_pos + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+
+    if (status == TINFL_STATUS_DONE) {
+      d.end = true;
+    } else if (status < TINFL_STATUS_DONE ||
+               (status == TINFL_STATUS_NEEDS_MORE_INPUT && in_ == in_end_)) {
+      failed_ = true;
+    }
+  }
+  return written;
+}
+
+uint8_t* AssetStream::load(const AssetStore::Asset& asset, uint32_t caps) {
+  auto* out = static_cast<uint8_t*>(heap_caps_malloc(asset.raw_size, caps));
+  if (!out) {
+    return nullptr;
+  }
+  if (asset.stored()) {
+    memcpy(out, asset.data, asset.raw_size);
+    return out;
+  }
+
+  auto* tinfl = static_cast<tinfl_decompressor*>(
+      heap_caps_malloc(sizeof(tinfl_decompressor), MALLOC_CAP_DEFAULT));
+  bool ok = tinfl != nullptr;
+  if (ok) {
+    tinfl_init(tinfl);
+    const uint8_t* in = asset.data;
+    const uint8_t* in_end = asset.data + asset.size;
+    size_t produced = 0;
+    tinfl_status status = TINFL_STATUS_NEEDS_MORE_INPUT;
+    while (status > TINFL_STATUS_DONE) {
+      size_t in_bytes = std::min(kInputChunk, (size_t)(in_end - in));
+      size_t out_bytes = asset.raw_size - produced;
+      const bool more_input = in + in_bytes < in_end;
+      status = tinfl_decompress(
+          tinfl, in, &in_bytes, out, out + produced, &out_bytes,
+          TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF |
+              (more_input ? TINFL_FLAG_HAS_MORE_INPUT : 0));
+      in += in_bytes;
+      produced += out_bytes;
+      // Truncated input, or more output than the index promised.
+      if ((status == TINFL_STATUS_NEEDS_MORE_INPUT && in == in_end) ||
+          (status == TINFL_STATUS_HAS_MORE_OUTPUT &&
+           produced == asset.raw_size)) {
+        break;
+      }
+    }
+    ok = status == TINFL_STATUS_DONE && produced == asset.raw_size &&
+         esp_rom_crc32_le(0, out, produced) == asset.raw_crc;
+  }
+  heap_caps_free(tinfl);
+
+  if (!ok) {
+    ESP_LOGE(TAG, "Failed to decode '%s'", asset.name);
+    heap_caps_free(out);
+    return nullptr;
+  }
+  return out;
+}
+
+#endif  // CONFIG_IDF_TARGET_LINUX
+
+AssetStream::AssetStream(const AssetStore::Asset& asset)
+    : asset_(asset), in_(asset.data), in_end_(asset.data + asset.size) {}
+
+size_t AssetStream::read(uint8_t* dst, size_t len) {
+  len = std::min(len, asset_.raw_size - position_);
+  if (len == 0 || failed_) {
+    return 0;
+  }
+
+  size_t n;
+  if (asset_.stored()) {
+    memcpy(dst, asset_.data + position_, len);
+    n = len;
+  } else if (decoder_) {
+    n = inflate(dst, len);
+  } else {
+    failed_ = true;  // init() was not called or failed.
+    return 0;
+  }
+  finish(dst, n);
+  return n;
+}
+
+void AssetStream::finish(const uint8_t* out, size_t len) {
+  crc_ = esp_rom_crc32_le(crc_, out, len);
+  position_ += len;
+  if (done() && crc_ != asset_.raw_crc) {
+    ESP_LOGE(TAG, "'%s': CRC mismatch", asset_.name);
+    failed_ = true;
+  }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+#include "sys/asset_store.h"
+
+/**
+ * ASSET STREAM
+ * ------------
+ * Sequential reader for an asset from the mapped partition. Stored assets
+ * are copied straight from the mapping; deflated ones are decoded on the
+ * fly, consuming the compressed bytes in place in bounded input chunks, so
+ * there is never a full-size temporary copy of either side:
+ *
+ *   read():  bounded output chunks (e.g. rows into DMA bounce buffers).
+ *            Deflate needs its 32 KB history window for this.
+ *   load():  the whole asset into one new buffer (e.g. PSRAM for ThorVG),
+ *            decoded directly into it; the buffer doubles as the window.
+ *
+ * The decoder is the ROM's tinfl (miniz) on the chip and zlib on the linux
+ * target. Every decoded byte goes into a running CRC-32 that is checked
+ * against the index once the asset is complete.
+ */
+class AssetStream {
+ public:
+  explicit AssetStream(const AssetStore::Asset& asset);
+  ~AssetStream();
+
+  AssetStream(const AssetStream&) = delete;
+  AssetStream& operator=(const AssetStream&) = delete;
+
+  /**
+   * Allocate the decoder state (and the history window for read()).
+   * @return ESP_OK or ESP_ERR_NO_MEM.
+   */
+  esp_err_t init();
+
+  /**
+   * Decode up to `len` bytes into `dst`.
+   * @return Bytes written; less than `len` only at the end of the asset or
+   *         on error (see failed()).
+   */
+  size_t read(uint8_t* dst, size_t len);
+
+  /** Decoded bytes so far. */
+  size_t position() const { return position_; }
+
+  bool done() const { return position_ == asset_.raw_size; }
+  bool failed() const { return failed_; }
+
+  /**
+   * True once every byte was decoded and matched the CRC in the index.
+   */
+  bool verified() const {
+    return done() && !failed_ && crc_ == asset_.raw_crc;
+  }
+
+  /**
+   * Decode a whole asset into a new buffer from heap_caps_malloc(caps).
+   * @return The buffer (free with heap_caps_free), or nullptr on error.
+   */
+  static uint8_t* load(const AssetStore::Asset& asset, uint32_t caps);
+
+ private:
+  struct Decoder;
+
+  // Compressed bytes handed to the decoder per call.
+  static constexpr size_t kInputChunk = 4096;
+
+  size_t inflate(uint8_t* dst, size_t len);
+  void finish(const uint8_t* out, size_t len);
+
+  const AssetStore::Asset& asset_;
+  const uint8_t* in_;
+  const uint8_t* in_end_;
+  Decoder* decoder_ = nullptr;
+  size_t position_ = 0;
+  uint32_t crc_ = 0;
+  bool failed_ = false;
+};
@@ -0,0 +1,427 @@
+#include "sys/bench_console.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include "esp_console.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sys/alloc_counter.h"
+#include "sys/frame_benchmark.h"
+#include "sys/lvgl_port.h"
+#include "sys/telemetry.h"
+#include "sys/trace_recorder.h"
+#include "ui/workshop_ui.h"
+#include "workshop_config.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <poll.h>
+#include <unistd.h>
+#else
+#include "esp_pm.h"
+#endif
+
+static const char* TAG = "BenchConsole";
+
+/**
+ * BENCHMARK CONSOLE: Implementation
+ * ---------------------------------
+ * Commands run on the console task, never on the LVGL task: the benchmark
+ * posts its frames to the LVGL task and waits, and everything that touches
+ * LVGL or the port takes the LVGL lock. On the chip, esp_console's REPL
+ * reads the console device; on the host, a task polls stdin (a blocking
+ * read would stall the simulated scheduler) and feeds esp_console_run().
+ */
+
+BenchConsole* BenchConsole::active_ = nullptr;
+
+namespace {
+
+constexpr uint32_t kTaskStack = 6 * 1024;
+
+long parse_int(const char* arg) {
+  char* end = nullptr;
+  const long value = strtol(arg, &end, 10);
+  return (end && *end == '\0') ? value : -1;
+}
+
+}  // namespace
+
+BenchConsole::BenchConsole(LvglPort& port, WorkshopUI& ui)
+    : port_(port),
+      ui_(ui),
+      phase_(WORKSHOP_PHASE),
+      cpu_mhz_(Workshop::CPU_FREQ_MHZ) {}
+
+esp_err_t BenchConsole::start() {
+  if (active_) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  active_ = this;
+
+#if CONFIG_IDF_TARGET_LINUX
+  esp_console_config_t config = ESP_CONSOLE_CONFIG_DEFAULT();
+  esp_err_t err = esp_console_init(&config);
+#else
+  esp_console_repl_t* repl = nullptr;
+  esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+  repl_config.prompt = "workshop>";
+  repl_config.task_stack_size = kTaskStack;
+#if CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+  esp_console_dev_usb_serial_jtag_config_t hw_config =
+      ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+  esp_err_t err =
+      esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl);
+#elif CONFIG_ESP_CONSOLE_UART
+  esp_console_dev_uart_config_t hw_config =
+      ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+  esp_err_t err = esp_console_new_repl_uart(&hw_config, &repl_config, &repl);
+#else
+  esp_err_t err = ESP_ERR_NOT_SUPPORTED;
+#endif
+#endif
+
+  if (err == ESP_OK) {
+    err = register_commands();
+  }
+#if CONFIG_IDF_TARGET_LINUX
+  if (err == ESP_OK && xTaskCreate(stdin_task, "console", kTaskStack, this, 2,
+                                   nullptr) != pdPASS) {
+    err = ESP_ERR_NO_MEM;
+  }
+#else
+  if (err == ESP_OK) {
+    err = esp_console_start_repl(repl);
+  }
+#endif
+
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Cannot start the console: %s", esp_err_to_name(err));
+    active_ = nullptr;
+    return err;
+  }
+  ESP_LOGI(TAG, "Console ready, 'help' lists the commands");
+  return ESP_OK;
+}
+
+esp_err_t BenchConsole::register_commands() {
+  const esp_console_cmd_t commands[] = {
+      {.command = "bench",
+       .help = "Show a scene and benchmark it",
+       .hint = "<hummingbird|raccoon|whale> <frames>",
+       .func = cmd_bench},
+      {.command = "stats",
+       .help = "Print the current settings and the last frame",
+       .hint = nullptr,
+       .func = cmd_stats},
+      {.command = "phase",
+       .help = "Apply the CPU and SPI clocks of a phase preset",
+       .hint = "<1-5>",
+       .func = cmd_phase},
+      {.command = "strip",
+       .help = "Re-allocate the draw buffers with this many lines",
+       .hint = "<lines>",
+       .func = cmd_strip},
+      {.command = "spi",
+       .help = "Move every panel to a new SPI clock",
+       .hint = "<MHz>",
+       .func = cmd_spi},
+      {.command = "cpu",
+       .help = "Change the CPU clock",
+       .hint = "<80|160|240>",
+       .func = cmd_cpu},
+      {.command = "trace",
+       .help = "Print the frames recorded between start and stop",
+       .hint = "<start|stop>",
+       .func = cmd_trace},
+      {.command = "heap",
+       .help = "Print heap and stack high-water marks",
+       .hint = nullptr,
+       .func = cmd_heap},
+  };
+  esp_err_t err = esp_console_register_help_command();
+  for (const esp_console_cmd_t& cmd : commands) {
+    if (err == ESP_OK) {
+      err = esp_console_cmd_register(&cmd);
+    }
+  }
+  return err;
+}
+
+esp_err_t BenchConsole::set_cpu_mhz(int mhz) {
+#if !CONFIG_IDF_TARGET_LINUX
+  // Keep the frame governor's floor (see app_main), but never above the
+  // new maximum.
+  esp_pm_config_t pm_config = {
+      .max_freq_mhz = mhz,
+      .min_freq_mhz = Workshop::PM_MIN_FREQ_MHZ > 0
+                          ? std::min(Workshop::PM_MIN_FREQ_MHZ, mhz)
+                          : mhz,
+      .light_sleep_enable = Workshop::PM_LIGHT_SLEEP,
+  };
+  esp_err_t err = esp_pm_configure(&pm_config);
+  if (err != ESP_OK) {
+    return err;
+  }
+#endif
+  cpu_mhz_ = mhz;
+  return ESP_OK;
+}
+
+int BenchConsole::finish(const char* name, esp_err_t err) {
+  Telemetry::emit("cmd", "name=%s status=%s err=%s", name,
+                  err == ESP_OK ? "ok" : "error", esp_err_to_name(err));
+  return err == ESP_OK ? 0 : 1;
+}
+
+int BenchConsole::cmd_bench(int argc, char** argv) {
+  BenchConsole& self = *active_;
+  const auto* animal = std::end(WorkshopUI::kAnimals);
+  if (argc == 3) {
+    animal = std::find_if(std::begin(WorkshopUI::kAnimals),
+                          std::end(WorkshopUI::kAnimals),
+                          [&](WorkshopUI::Animal a) {
+                            return strcmp(WorkshopUI::animal_name(a),
+                                          argv[1]) == 0;
+                          });
+  }
+  const long frames = argc == 3 ? parse_int(argv[2]) : -1;
+  if (animal == std::end(WorkshopUI::kAnimals) || frames <= 0 ||
+      frames > 100000) {
+    return finish("bench", ESP_ERR_INVALID_ARG);
+  }
+
+  {
+    LvglPort::Lock guard(self.port_);
+    self.ui_.show(*animal);
+  }
+  const size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  FrameBenchmark bench(self.port_);
+  bench.set_full_redraw(Workshop::BENCHMARK_FULL_REDRAW);
+  const auto result = bench.run((uint32_t)frames);
+  result.emit(WorkshopUI::animal_name(*animal), self.phase_, free_before);
+  return finish("bench", ESP_OK);
+}
+
+int BenchConsole::cmd_stats(int argc, char** argv) {
+  BenchConsole& self = *active_;
+  FrameRecorder* recorder = self.port_.get_recorder();
+  FrameRecorder::Frame last;
+  uint32_t frames = 0;
+  uint32_t jank = 0;
+  WorkshopUI::Animal animal;
+  int strip_lines;
+  uint32_t spi_hz;
+  size_t sram;
+  {
+    LvglPort::Lock guard(self.port_);
+    if (recorder) {
+      last = recorder->last_frame();
+      frames = recorder->frame_count();
+      jank = recorder->jank_count();
+    }
+    animal = self.ui_.current_animal();
+    strip_lines = self.port_.strip_lines();
+    spi_hz = self.port_.bus_clock_hz();
+    sram = self.port_.sram_bytes();
+  }
+  const int core = Workshop::LVGL_TASK_CORE == tskNO_AFFINITY
+                       ? -1
+                       : (int)Workshop::LVGL_TASK_CORE;
+
+  Telemetry::emit(
+      "stats",
+      "phase=%d build_phase=%d cpu_mhz=%d spi_mhz=%u strip=%d buffers=%s "
+      "driver=%s animal=%s frames=%u jank=%u last_ms=%.2f render_ms=%.2f "
+      "flush_ms=%.2f free_internal=%u free_psram=%u psram=%d double=%d "
+      "partial=%d bswap=%d core=%d sram=%u",
+      self.phase_, WORKSHOP_PHASE, self.cpu_mhz_,
+      (unsigned)(spi_hz / 1000000), strip_lines,
+      Workshop::BUFFER_MODE == Workshop::BufferMode::FullFrame ? "full"
+                                                               : "strip",
+      Workshop::USE_NATIVE_DRIVER ? "native" : "port",
+      WorkshopUI::animal_name(animal), (unsigned)frames, (unsigned)jank,
+      last.total_us / 1000.0f, last.render_us / 1000.0f,
+      last.flush_us / 1000.0f,
+      (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+      (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+      Workshop::USE_PSRAM, Workshop::USE_DOUBLE_BUFFERING,
+      Workshop::PARTIAL_REFRESH, Workshop::USE_XTENSA_INTRINSICS,
+      core, (unsigned)sram);
+  return finish("stats", ESP_OK);
+}
+
+int BenchConsole::cmd_phase(int argc, char** argv) {
+  BenchConsole& self = *active_;
+  const long phase = argc == 2 ? parse_int(argv[1]) : -1;
+  if (phase < 1 || phase > 5) {
+    return finish("phase", ESP_ERR_INVALID_ARG);
+  }
+
+  // The bus clock goes first: a failed change leaves the display at its old
+  // clock (see LvglPort::set_bus_clock), so nothing is switched yet. If the
+  // CPU clock then fails, the bus goes back to where it was.
+  esp_err_t spi_err;
+  uint32_t spi_hz;
+  uint32_t prev_spi_hz;
+  {
+    LvglPort::Lock guard(self.port_);
+    prev_spi_hz = self.port_.bus_clock_hz();
+    spi_err = self.port_.set_bus_clock(Workshop::phase_spi_bus_speed(phase));
+    spi_hz = self.port_.bus_clock_hz();
+  }
+  // Without a runtime-changeable bus the clock simply stays as built.
+  if (spi_err != ESP_OK && spi_err != ESP_ERR_NOT_SUPPORTED) {
+    return finish("phase", spi_err);
+  }
+  const esp_err_t err = self.set_cpu_mhz(Workshop::phase_cpu_freq_mhz(phase));
+  if (err != ESP_OK) {
+    if (spi_err == ESP_OK) {
+      LvglPort::Lock guard(self.port_);
+      self.port_.set_bus_clock(prev_spi_hz);
+    }
+    return finish("phase", err);
+  }
+  self.phase_ = (int)phase;
+
+  Telemetry::emit("phase",
+                  "phase=%d build_phase=%d cpu_mhz=%d spi_mhz=%u spi=%s "
+                  "fixed=buffers,psram,driver,stack",
+                  self.phase_, WORKSHOP_PHASE, self.cpu_mhz_,
+                  (unsigned)(spi_hz / 1000000),
+                  spi_err == ESP_OK ? "applied" : "fixed");
+  return finish("phase", ESP_OK);
+}
+
+int BenchConsole::cmd_strip(int argc, char** argv) {
+  BenchConsole& self = *active_;
+  const long lines = argc == 2 ? parse_int(argv[1]) : -1;
+  if (lines <= 0) {
+    return finish("strip", ESP_ERR_INVALID_ARG);
+  }
+  LvglPort::Lock guard(self.port_);
+  return finish("strip", self.port_.set_strip_lines((int)lines));
+}
+
+int BenchConsole::cmd_spi(int argc, char** argv) {
+  BenchConsole& self = *active_;
+  const long mhz = argc == 2 ? parse_int(argv[1]) : -1;
+  if (mhz < 1 || mhz > 80) {
+    return finish("spi", ESP_ERR_INVALID_ARG);
+  }
+  LvglPort::Lock guard(self.port_);
+  return finish("spi", self.port_.set_bus_clock((uint32_t)mhz * 1000000));
+}
+
+int BenchConsole::cmd_cpu(int argc, char** argv) {
+  BenchConsole& self = *active_;
+  const long mhz = argc == 2 ? parse_int(argv[1]) : -1;
+  if (mhz != 80 && mhz != 160 && mhz != 240) {
+    return finish("cpu", ESP_ERR_INVALID_ARG);
+  }
+  return finish("cpu", self.set_cpu_mhz((int)mhz));
+}
+
+int BenchConsole::cmd_trace(int argc, char** argv) {
+  BenchConsole& self = *active_;
+  FrameRecorder* recorder = self.port_.get_recorder();
+  if (argc != 2) {
+    return finish("trace", ESP_ERR_INVALID_ARG);
+  }
+  if (!recorder && !TraceRecorder::ready()) {
+    return finish("trace", ESP_ERR_NOT_SUPPORTED);
+  }
+
+  if (strcmp(argv[1], "start") == 0) {
+    if (recorder) {
+      LvglPort::Lock guard(self.port_);
+      self.trace_seq_ = recorder->frame_count();
+    }
+    TraceRecorder::start();
+    self.tracing_ = true;
+    return finish("trace", ESP_OK);
+  }
+  if (strcmp(argv[1], "stop") != 0) {
+    return finish("trace", ESP_ERR_INVALID_ARG);
+  }
+  if (!self.tracing_) {
+    return finish("trace", ESP_ERR_INVALID_STATE);
+  }
+  TraceRecorder::stop();
+  self.tracing_ = false;
+
+  if (recorder) {
+    // Frames older than the ring's depth are gone: they count as dropped.
+    std::vector<FrameRecorder::Frame> frames(recorder->depth());
+    size_t copied;
+    uint32_t recorded;
+    {
+      LvglPort::Lock guard(self.port_);
+      copied = recorder->copy_since(self.trace_seq_, frames.data(),
+                                    frames.size());
+      recorded = recorder->frame_count() - self.trace_seq_;
+    }
+    for (size_t i = 0; i < copied; i++) {
+      const FrameRecorder::Frame& f = frames[i];
+      Telemetry::emit("frame",
+                      "seq=%u start_us=%lld interval_us=%u total_us=%u "
+                      "render_us=%u flush_us=%u flush_wait_us=%u "
+                      "lock_wait_us=%u dirty_px=%u flushed_px=%u anims=%u",
+                      (unsigned)f.seq, (long long)f.start_us,
+                      (unsigned)f.interval_us, (unsigned)f.total_us,
+                      (unsigned)f.render_us, (unsigned)f.flush_us,
+                      (unsigned)f.flush_wait_us, (unsigned)f.lock_wait_us,
+                      (unsigned)f.dirty_px, (unsigned)f.flushed_px,
+                      (unsigned)f.active_anims);
+    }
+    Telemetry::emit("trace", "frames=%u dropped=%u", (unsigned)copied,
+                    (unsigned)(recorded - copied));
+  }
+  // The event capture, if enabled, follows as trace_* records.
+  TraceRecorder::dump();
+  return finish("trace", ESP_OK);
+}
+
+int BenchConsole::cmd_heap(int argc, char** argv) {
+  BenchConsole& self = *active_;
+  self.mem_.sample();
+  self.mem_.report();
+  Telemetry::emit("allocs", "allocs=%u frees=%u",
+                  (unsigned)AllocCounter::allocs(),
+                  (unsigned)AllocCounter::frees());
+  return finish("heap", ESP_OK);
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+void BenchConsole::stdin_task(void* arg) {
+  char line[128];
+  size_t len = 0;
+  while (true) {
+    pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    char c;
+    if (poll(&pfd, 1, 0) <= 0 || read(STDIN_FILENO, &c, 1) != 1) {
+      vTaskDelay(pdMS_TO_TICKS(20));
+      continue;
+    }
+    if (c != '\n' && c != '\r') {
+      if (len < sizeof(line) - 1) {
+        line[len++] = c;
+      }
+      continue;
+    }
+    if (len == 0) {
+      continue;
+    }
+    line[len] = '\0';
+    len = 0;
+
+    int ret = 0;
+    esp_err_t err = esp_console_run(line, &ret);
+    if (err == ESP_ERR_NOT_FOUND) {
+      ESP_LOGW(TAG, "Unknown command: %s", line);
+    }
+  }
+}
+#endif
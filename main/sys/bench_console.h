@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "sys/mem_report.h"
+
+class LvglPort;
+class WorkshopUI;
+
+/**
+ * BENCHMARK CONSOLE
+ * -----------------
+ * Tuning experiments without reflashing: commands on the serial console
+ * (stdin on the host) that run the frame benchmark and change the parts of
+ * a phase that can change at run time. Results are TLM records, and every
+ * command ends with
+ *
+ *     TLM cmd name=<command> status=ok|error err=<esp_err_t name>
+ *
+ * so a script can send a command and wait for its answer.
+ *
+ *   bench <animal> <frames>  Show a scene and benchmark it (TLM bench).
+ *   stats                    Settings and the last frame (TLM stats).
+ *   phase <n>                Apply phase n's CPU and SPI clocks.
+ *   strip <lines>            Re-allocate the draw buffers.
+ *   spi <MHz>                Move every panel to a new SPI clock.
+ *   cpu <MHz>                Change the CPU clock (80, 160 or 240).
+ *   trace start|stop         Print the frames (and events) recorded in
+ *                            between.
+ *   heap                     Heap and stack high-water marks.
+ *
+ * Buffer mode, PSRAM, driver and stack sizes are fixed at build time, so
+ * `phase` reports them as such; `strip` and `spi` need the port's own flush
+ * path (not phase 5's native driver) and `trace` the flight recorder or
+ * the event trace. tools/sweep_knobs.py drives these commands.
+ */
+class BenchConsole {
+ public:
+  BenchConsole(LvglPort& port, WorkshopUI& ui);
+
+  BenchConsole(const BenchConsole&) = delete;
+  BenchConsole& operator=(const BenchConsole&) = delete;
+
+  /**
+   * Register the commands and start reading them on a console task. Only
+   * one console can run.
+   */
+  esp_err_t start();
+
+ private:
+  esp_err_t register_commands();
+  esp_err_t set_cpu_mhz(int mhz);
+  static int finish(const char* name, esp_err_t err);
+
+  static int cmd_bench(int argc, char** argv);
+  static int cmd_stats(int argc, char** argv);
+  static int cmd_phase(int argc, char** argv);
+  static int cmd_strip(int argc, char** argv);
+  static int cmd_spi(int argc, char** argv);
+  static int cmd_cpu(int argc, char** argv);
+  static int cmd_trace(int argc, char** argv);
+  static int cmd_heap(int argc, char** argv);
+
+#if CONFIG_IDF_TARGET_LINUX
+  static void stdin_task(void* arg);
+#endif
+
+  static BenchConsole* active_;
+
+  LvglPort& port_;
+  WorkshopUI& ui_;
+  int phase_;    // Preset whose clocks were applied last.
+  int cpu_mhz_;  // Maximum CPU clock set last (PM config on the device).
+  bool tracing_ = false;
+  uint32_t trace_seq_ = 0;
+  MemReport mem_;  // High-water marks accumulate across `heap` commands.
+};
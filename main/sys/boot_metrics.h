@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sys/telemetry.h"
+
+/**
+ * BOOT METRICS
+ * ------------
+ * Timestamps (microseconds since the app started, from esp_timer) of the
+ * boot milestones. Stages are marked from different tasks, so each one is
+ * an atomic; report() prints the set once every stage has been reached.
+ *
+ *   first_pixel: the first pixels on the panel (the splash frame, if one is
+ *                enabled, else LVGL's first flush).
+ *   first_frame: LVGL's first flush, i.e. the hand-over to live rendering.
+ *   interactive: UI built and touch driver attached.
+ */
+class BootMetrics {
+ public:
+  enum class Stage : uint8_t {
+    DisplayReady = 0,
+    PortReady,
+    UiReady,
+    FirstPixel,
+    FirstFrame,
+    TouchReady,
+    Count
+  };
+
+  static void mark(Stage stage) { mark_at(stage, esp_timer_get_time()); }
+
+  static void mark_at(Stage stage, int64_t us) {
+    int64_t expected = 0;
+    stages_[(int)stage].compare_exchange_strong(expected, us);
+  }
+
+  static int64_t at(Stage stage) { return stages_[(int)stage].load(); }
+
+  static bool complete() {
+    for (const auto& s : stages_) {
+      if (s.load() == 0) return false;
+    }
+    return true;
+  }
+
+  static int64_t interactive_us() {
+    int64_t ui = at(Stage::UiReady);
+    int64_t touch = at(Stage::TouchReady);
+    return ui > touch ? ui : touch;
+  }
+
+  static void report() {
+    ESP_LOGI("BootMetrics",
+             "display %lld ms, port %lld ms, ui %lld ms, touch %lld ms, "
+             "first pixel %lld ms, first frame %lld ms, interactive %lld ms",
+             at(Stage::DisplayReady) / 1000, at(Stage::PortReady) / 1000,
+             at(Stage::UiReady) / 1000, at(Stage::TouchReady) / 1000,
+             at(Stage::FirstPixel) / 1000, at(Stage::FirstFrame) / 1000,
+             interactive_us() / 1000);
+    Telemetry::emit("boot",
+                    "display_us=%lld port_us=%lld ui_us=%lld touch_us=%lld "
+                    "first_pixel_us=%lld first_frame_us=%lld "
+                    "interactive_us=%lld",
+                    at(Stage::DisplayReady), at(Stage::PortReady),
+                    at(Stage::UiReady), at(Stage::TouchReady),
+                    at(Stage::FirstPixel), at(Stage::FirstFrame),
+                    interactive_us());
+  }
+
+ private:
+  static inline std::atomic<int64_t> stages_[(int)Stage::Count] = {};
+};
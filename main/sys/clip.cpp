@@ -0,0 +1,110 @@
+#include "sys/clip.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "esp_log.h"
+
+static const char* TAG = "Clip";
+
+/**
+ * ANIMATION CLIP: Implementation
+ * ------------------------------
+ * The blob is read in place, so no struct is ever overlaid on it: the
+ * fields are assembled byte by byte (the mapping only guarantees the
+ * blob's own alignment). Every row op is a little-endian u16: bit 15 set
+ * means a run of (op & 0x7fff) copies of the next pixel, clear means that
+ * many literal pixels follow.
+ */
+
+namespace {
+
+constexpr uint8_t kMagic[4] = {'W', 'S', 'C', 'L'};
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderSize = 16;
+constexpr size_t kEntrySize = 16;
+constexpr uint16_t kRunFlag = 0x8000;
+
+uint16_t u16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+uint32_t u32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+}  // namespace
+
+esp_err_t Clip::open(const uint8_t* data, size_t size) {
+  data_ = nullptr;
+  if (!data || size < kHeaderSize || memcmp(data, kMagic, 4) != 0 ||
+      u16(data + 4) != kVersion) {
+    ESP_LOGE(TAG, "Not a clip");
+    return ESP_ERR_INVALID_STATE;
+  }
+  width_ = u16(data + 6);
+  height_ = u16(data + 8);
+  frames_ = u16(data + 10);
+  fps_ = u16(data + 12);
+  if (width_ == 0 || height_ == 0 || frames_ == 0 || fps_ == 0 ||
+      kHeaderSize + (size_t)(frames_ + 1) * kEntrySize > size) {
+    ESP_LOGE(TAG, "Bad clip header");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // Bounds-check the whole table once, so playback need not.
+  for (size_t i = 0; i <= frames_; i++) {
+    const uint8_t* e = data + kHeaderSize + i * kEntrySize;
+    const uint32_t offset = u32(e);
+    const uint32_t bytes = u32(e + 4);
+    const uint16_t x1 = u16(e + 8), y1 = u16(e + 10);
+    const uint16_t x2 = u16(e + 12), y2 = u16(e + 14);
+    if (offset > size || bytes > size - offset || x1 > x2 || y1 > y2 ||
+        x2 > width_ || y2 > height_ || (offset & 1)) {
+      ESP_LOGE(TAG, "Clip frame %u is corrupt", (unsigned)i);
+      return ESP_ERR_INVALID_STATE;
+    }
+  }
+  data_ = data;
+  return ESP_OK;
+}
+
+Clip::Frame Clip::entry(size_t index) const {
+  const uint8_t* e = data_ + kHeaderSize + index * kEntrySize;
+  return {u16(e + 8), u16(e + 10), u16(e + 12), u16(e + 14),
+          data_ + u32(e), u32(e + 4)};
+}
+
+const uint8_t* Clip::decode_rows(const uint8_t* src, const uint8_t* end,
+                                 uint16_t* dst, int width, int rows) {
+  for (int row = 0; row < rows; row++) {
+    for (int x = 0; x < width;) {
+      if (end - src < 2) {
+        return nullptr;
+      }
+      const uint16_t op = u16(src);
+      const int count = op & ~kRunFlag;
+      src += 2;
+      if (count == 0 || count > width - x) {
+        return nullptr;
+      }
+      if (op & kRunFlag) {
+        if (end - src < 2) {
+          return nullptr;
+        }
+        uint16_t px;
+        memcpy(&px, src, sizeof(px));  // Panel order: copied, not parsed.
+        src += 2;
+        std::fill_n(dst, count, px);
+      } else {
+        const size_t bytes = (size_t)count * sizeof(uint16_t);
+        if ((size_t)(end - src) < bytes) {
+          return nullptr;
+        }
+        memcpy(dst, src, bytes);
+        src += bytes;
+      }
+      dst += count;
+      x += count;
+    }
+  }
+  return src;
+}
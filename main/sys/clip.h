@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+
+/**
+ * ANIMATION CLIP
+ * --------------
+ * A scene's animation loop, rendered on the host by the linux build of this
+ * very app and encoded by tools/bake_clip.py. Playing it back costs a
+ * memcpy-class decode per frame instead of a ThorVG render, so the frame
+ * rate no longer depends on the scene.
+ *
+ * Every frame is stored as the bounding box of the pixels that changed since
+ * the previous frame (cyclically, so the loop closes), row by row, each row
+ * run-length encoded. A key frame (the full first frame) starts playback.
+ * Pixels are RGB565 in panel byte order, so decoded rows go to the panel
+ * as they are. The layout is documented in tools/bake_clip.py.
+ *
+ * A Clip only indexes the blob in place (e.g. in the mapped asset
+ * partition); nothing is copied.
+ */
+class Clip {
+ public:
+  struct Frame {
+    uint16_t x1, y1, x2, y2;  // Changed area, end-exclusive.
+    const uint8_t* data;      // Encoded rows.
+    size_t size;
+
+    bool empty() const { return x1 >= x2 || y1 >= y2; }
+    int width() const { return x2 - x1; }
+    int height() const { return y2 - y1; }
+  };
+
+  /**
+   * Validate a clip blob and index it.
+   * @return ESP_OK or ESP_ERR_INVALID_STATE if the blob is not a valid clip.
+   */
+  esp_err_t open(const uint8_t* data, size_t size);
+
+  uint16_t width() const { return width_; }
+  uint16_t height() const { return height_; }
+  uint16_t frames() const { return frames_; }
+  uint16_t fps() const { return fps_; }
+
+  /** The full first frame. */
+  Frame key() const { return entry(0); }
+
+  /** What changes from the previous frame to frame `index` (cyclic). */
+  Frame delta(size_t index) const { return entry(1 + index); }
+
+  /**
+   * Decode `rows` rows of `width` pixels.
+   * @param src Encoded data, at a row boundary.
+   * @param end End of the frame's data.
+   * @param dst Receives width * rows pixels.
+   * @return Where the next row starts, or nullptr if the data is corrupt.
+   */
+  static const uint8_t* decode_rows(const uint8_t* src, const uint8_t* end,
+                                    uint16_t* dst, int width, int rows);
+
+ private:
+  Frame entry(size_t index) const;
+
+  const uint8_t* data_ = nullptr;
+  uint16_t width_ = 0;
+  uint16_t height_ = 0;
+  uint16_t frames_ = 0;
+  uint16_t fps_ = 0;
+};
@@ -0,0 +1,233 @@
+#include "sys/cpu_monitor.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sys/telemetry.h"
+
+#if CONFIG_FREERTOS_RUN_TIME_STATS_USING_CPU_CLK
+#error "CpuMonitor expects the esp_timer (microsecond) run-time stats clock"
+#endif
+
+static const char* TAG = "CpuMonitor";
+
+/**
+ * PER-CORE CPU MONITOR: Implementation
+ * ------------------------------------
+ * Run-time counters and the LVGL task accumulators are 32-bit microsecond
+ * counts; they wrap after about 71 minutes, so only their differences are
+ * used and a window must be shorter than that.
+ *
+ * Only one core can run the LVGL task at a time, and the scheduler switches
+ * it out on one core before it can be switched in on another, so the hooks
+ * never race on its Placement. snapshot() reads it from another task and
+ * may be off by the slice in progress.
+ */
+
+TaskHandle_t CpuMonitor::sampler_ = nullptr;
+uint32_t CpuMonitor::period_ms_ = 0;
+std::atomic<TaskHandle_t> CpuMonitor::watched_{nullptr};
+CpuMonitor::Placement CpuMonitor::lvgl_;
+std::vector<TaskStatus_t> CpuMonitor::status_;
+std::vector<CpuMonitor::TaskTime> CpuMonitor::previous_;
+
+extern "C" void IRAM_ATTR workshop_cpu_task_switched_in(void) {
+  CpuMonitor::switched_in();
+}
+
+extern "C" void IRAM_ATTR workshop_cpu_task_switched_out(void) {
+  CpuMonitor::switched_out();
+}
+
+static inline int current_core() {
+#if CONFIG_IDF_TARGET_LINUX
+  return 0;
+#else
+  return esp_cpu_get_core_id();
+#endif
+}
+
+void IRAM_ATTR CpuMonitor::switched_in() {
+  TaskHandle_t watched = watched_.load(std::memory_order_relaxed);
+  if (!watched || xTaskGetCurrentTaskHandle() != watched) {
+    return;
+  }
+  lvgl_.switched_in(current_core(), (uint32_t)esp_timer_get_time());
+}
+
+void IRAM_ATTR CpuMonitor::switched_out() {
+  if (lvgl_.core.load(std::memory_order_relaxed) < 0 ||
+      xTaskGetCurrentTaskHandle() != watched_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  lvgl_.switched_out((uint32_t)esp_timer_get_time());
+}
+
+void IRAM_ATTR CpuMonitor::Placement::switched_in(int core_id,
+                                                  uint32_t now_us) {
+  if (last_core >= 0 && core_id != last_core) {
+    migrations.fetch_add(1, std::memory_order_relaxed);
+  }
+  last_core = core_id;
+  in_since_us = now_us;
+  core.store(core_id, std::memory_order_relaxed);
+}
+
+void IRAM_ATTR CpuMonitor::Placement::switched_out(uint32_t now_us) {
+  const int core_id = core.load(std::memory_order_relaxed);
+  if (core_id < 0) {
+    return;
+  }
+  us[core_id].fetch_add(now_us - in_since_us, std::memory_order_relaxed);
+  core.store(-1, std::memory_order_relaxed);
+}
+
+#if CONFIG_WORKSHOP_CPU_MONITOR_SELFTEST
+void CpuMonitor::check_placement() {
+  // In on core 0, over to core 1, a second slice there, back to core 0.
+  static constexpr struct {
+    int core;
+    uint32_t in_us;
+    uint32_t out_us;
+  } kSlices[] = {{0, 0, 100}, {1, 150, 250}, {1, 300, 350}, {0, 400, 460}};
+  Placement p;
+  for (const auto& slice : kSlices) {
+    p.switched_in(slice.core, slice.in_us);
+    p.switched_out(slice.out_us);
+  }
+  Telemetry::emit("cpu_check",
+                  "migrations=%u lvgl_core0_us=%u lvgl_core1_us=%u",
+                  (unsigned)p.migrations.load(), (unsigned)p.us[0].load(),
+                  (unsigned)p.us[1].load());
+}
+#endif
+
+bool CpuMonitor::start(uint32_t period_ms) {
+  if (sampler_ || period_ms == 0) {
+    return sampler_ != nullptr;
+  }
+#if !CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  ESP_LOGE(TAG, "Needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS");
+  return false;
+#else
+  period_ms_ = period_ms;
+  // Above the LVGL task so a saturated core cannot starve the reports.
+  if (xTaskCreate(sampler_task, "cpu_mon", 4096, nullptr,
+                  configMAX_PRIORITIES - 3, &sampler_) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create the sampler task");
+    sampler_ = nullptr;
+    return false;
+  }
+  ESP_LOGI(TAG, "Sampling %d core(s) every %u ms", cores(),
+           (unsigned)period_ms);
+  return true;
+#endif
+}
+
+CpuMonitor::Snapshot CpuMonitor::snapshot() {
+  Snapshot s;
+  s.us = esp_timer_get_time();
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  for (int core = 0; core < std::min(cores(), kMaxCores); core++) {
+    s.idle_us[core] = (uint32_t)ulTaskGetRunTimeCounter(
+        xTaskGetIdleTaskHandleForCore(core));
+  }
+#endif
+  for (int core = 0; core < kMaxCores; core++) {
+    s.lvgl_us[core] = lvgl_.us[core].load(std::memory_order_relaxed);
+  }
+  const int running = lvgl_.core.load(std::memory_order_relaxed);
+  if (running >= 0) {
+    s.lvgl_us[running] += (uint32_t)s.us - lvgl_.in_since_us;
+  }
+  s.migrations = lvgl_.migrations.load(std::memory_order_relaxed);
+  return s;
+}
+
+CpuMonitor::Usage CpuMonitor::usage(const Snapshot& from,
+                                    const Snapshot& to) {
+  Usage u;
+  const int64_t window_us = to.us - from.us;
+  if (window_us <= 0) {
+    return u;
+  }
+  u.window_ms = (uint32_t)(window_us / 1000);
+  for (int core = 0; core < std::min(cores(), kMaxCores); core++) {
+    const float idle = (uint32_t)(to.idle_us[core] - from.idle_us[core]);
+    const float lvgl = (uint32_t)(to.lvgl_us[core] - from.lvgl_us[core]);
+    u.busy_pct[core] = std::clamp(100.0f - 100.0f * idle / window_us,
+                                  0.0f, 100.0f);
+    u.lvgl_pct[core] = std::min(100.0f * lvgl / window_us, 100.0f);
+  }
+  u.migrations = to.migrations - from.migrations;
+  return u;
+}
+
+void CpuMonitor::Usage::format(char* buf, size_t len) const {
+  size_t used = 0;
+  for (int core = 0; core < std::min(cores(), kMaxCores) && used < len;
+       core++) {
+    used += snprintf(buf + used, len - used, "core%d_busy=%.1f ", core,
+                     busy_pct[core]);
+  }
+  for (int core = 0; core < std::min(cores(), kMaxCores) && used < len;
+       core++) {
+    used += snprintf(buf + used, len - used, "lvgl_core%d=%.1f ", core,
+                     lvgl_pct[core]);
+  }
+  if (used < len) {
+    snprintf(buf + used, len - used, "lvgl_migrations=%u",
+             (unsigned)migrations);
+  }
+}
+
+void CpuMonitor::sampler_task(void*) {
+  Snapshot last = snapshot();
+  report_tasks(0);  // Baseline.
+  TickType_t wake = xTaskGetTickCount();
+  while (true) {
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(period_ms_));
+    const Snapshot now = snapshot();
+    const Usage u = usage(last, now);
+    last = now;
+
+    char fields[160];
+    u.format(fields, sizeof(fields));
+    Telemetry::emit("cpu", "window_ms=%u cores=%d %s", (unsigned)u.window_ms,
+                    cores(), fields);
+    report_tasks(u.window_ms * 1000);
+  }
+}
+
+void CpuMonitor::report_tasks(uint32_t window_us) {
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  status_.resize(uxTaskGetNumberOfTasks() + 4);
+  const UBaseType_t count =
+      uxTaskGetSystemState(status_.data(), status_.size(), nullptr);
+
+  std::vector<TaskTime> current;
+  current.reserve(count);
+  for (UBaseType_t i = 0; i < count; i++) {
+    const TaskStatus_t& st = status_[i];
+    const uint32_t run_us = (uint32_t)st.ulRunTimeCounter;
+    current.push_back({st.xHandle, run_us});
+    if (window_us == 0) {
+      continue;
+    }
+    // Tasks created during the window count from zero.
+    auto it = std::find_if(
+        previous_.begin(), previous_.end(),
+        [&](const auto& t) { return t.handle == st.xHandle; });
+    const uint32_t delta = run_us - (it != previous_.end() ? it->run_us : 0);
+    const float pct = 100.0f * delta / window_us;
+    if (pct >= 1.0f) {
+      Telemetry::emit("cpu_task", "name=%s pct=%.1f prio=%u", st.pcTaskName,
+                      pct, (unsigned)st.uxCurrentPriority);
+    }
+  }
+  previous_ = std::move(current);
+#endif
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * PER-CORE CPU MONITOR
+ * --------------------
+ * Phase 5 leaves the LVGL task unpinned (tskNO_AFFINITY) and trusts the
+ * scheduler to balance it against ThorVG, the SPI ISR and everything else.
+ * This monitor shows what each core actually does:
+ *
+ *   - busy time per core, from its idle task's FreeRTOS run-time counter,
+ *   - CPU share per task, from the run-time counters of every task,
+ *   - how the LVGL task's time splits between the cores, and how often it
+ *     migrates, from the task switch hooks (see sys/trace_hooks.h); the
+ *     run-time counters alone cannot tell where a task ran.
+ *
+ * A sampler task prints a TLM cpu record (plus cpu_task records for tasks
+ * above 1%) every period. snapshot() and usage() let a benchmark report
+ * the same figures over its own run.
+ *
+ * Requires FREERTOS_GENERATE_RUN_TIME_STATS with the default esp_timer
+ * (microsecond) clock.
+ */
+class CpuMonitor {
+ public:
+  static constexpr int kMaxCores = 2;
+
+  /** Cumulative counters; subtract two with usage(). */
+  struct Snapshot {
+    int64_t us = 0;
+    uint32_t idle_us[kMaxCores] = {};
+    uint32_t lvgl_us[kMaxCores] = {};
+    uint32_t migrations = 0;
+  };
+
+  /** Figures over a window, in percent of one core. */
+  struct Usage {
+    uint32_t window_ms = 0;
+    float busy_pct[kMaxCores] = {};
+    float lvgl_pct[kMaxCores] = {};
+    uint32_t migrations = 0;
+
+    /**
+     * Format as "coreN_busy=.. lvgl_coreN=.. lvgl_migrations=.." for a
+     * TLM record.
+     */
+    void format(char* buf, size_t len) const;
+  };
+
+  /**
+   * Start the sampler task.
+   * @param period_ms Reporting period, e.g. 1000.
+   * @return True if the monitor is running.
+   */
+  static bool start(uint32_t period_ms);
+
+  static bool ready() { return sampler_ != nullptr; }
+
+  /** Track the LVGL task's cores and migrations from now on. */
+  static void watch(TaskHandle_t task) { watched_ = task; }
+
+  static Snapshot snapshot();
+  static Usage usage(const Snapshot& from, const Snapshot& to);
+
+  static int cores() { return portNUM_PROCESSORS; }
+
+  /** Task switch hooks; called by the scheduler with its lock held. */
+  static void IRAM_ATTR switched_in();
+  static void IRAM_ATTR switched_out();
+
+#if CONFIG_WORKSHOP_CPU_MONITOR_SELFTEST
+  /**
+   * Replay a fixed sequence of switches on two cores through a scratch copy
+   * of the placement accounting and print the result as a TLM cpu_check
+   * record: migrations=2 lvgl_core0_us=160 lvgl_core1_us=150 when it is
+   * right. Single-core hosts never migrate, so this is their only check.
+   */
+  static void check_placement();
+#endif
+
+ private:
+  struct TaskTime {
+    TaskHandle_t handle;
+    uint32_t run_us;
+  };
+
+  // Where the watched task runs, fed by the switch hooks.
+  struct Placement {
+    std::atomic<int> core{-1};  // Core it runs on, or -1.
+    int last_core = -1;
+    uint32_t in_since_us = 0;
+    std::atomic<uint32_t> us[kMaxCores] = {};
+    std::atomic<uint32_t> migrations{0};
+
+    void IRAM_ATTR switched_in(int core, uint32_t now_us);
+    void IRAM_ATTR switched_out(uint32_t now_us);
+  };
+
+  static void sampler_task(void* arg);
+  static void report_tasks(uint32_t window_us);
+
+  static TaskHandle_t sampler_;
+  static uint32_t period_ms_;
+  static std::atomic<TaskHandle_t> watched_;
+
+  static Placement lvgl_;
+
+  // Sampler state.
+  static std::vector<TaskStatus_t> status_;
+  static std::vector<TaskTime> previous_;
+};
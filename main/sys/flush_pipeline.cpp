@@ -0,0 +1,78 @@
+#include "sys/flush_pipeline.h"
+
+#include <cstring>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sys/telemetry.h"
+#include "workshop_config.h"
+
+static const char* TAG = "FlushPipeline";
+
+/**
+ * FLUSH PIPELINE: Implementation
+ * ------------------------------
+ * The reference is the loop flush_cb ran before the pipeline, one pixel per
+ * iteration, with the same byte-swap choice as Workshop::FlushStages. Both
+ * transform the same pattern `rounds` times in place, so the buffers must
+ * still match at the end.
+ */
+
+static void legacy_flush_loop(uint16_t* buf16, uint32_t len) {
+  if (Workshop::USE_XTENSA_INTRINSICS) {
+    while (len > 0) {
+      *buf16 = __builtin_bswap16(*buf16);
+      buf16++;
+      len--;
+    }
+  } else {
+    while (len > 0) {
+      *buf16 = (uint16_t)((*buf16 >> 8) | (*buf16 << 8));
+      buf16++;
+      len--;
+    }
+  }
+}
+
+void benchmark_flush_pipeline(size_t pixels, uint32_t rounds) {
+  const size_t bytes = pixels * sizeof(uint16_t);
+  auto* legacy = (uint16_t*)heap_caps_malloc(bytes, Workshop::ALLOC_CAPS);
+  auto* fused = (uint16_t*)heap_caps_malloc(bytes, Workshop::ALLOC_CAPS);
+  if (!legacy || !fused || pixels == 0 || rounds == 0) {
+    ESP_LOGW(TAG, "Skipping the benchmark (%u px)", (unsigned)pixels);
+    heap_caps_free(legacy);
+    heap_caps_free(fused);
+    return;
+  }
+  for (size_t i = 0; i < pixels; i++) {
+    legacy[i] = (uint16_t)(i * 2654435761u >> 16);
+  }
+  memcpy(fused, legacy, bytes);
+
+  int64_t start = esp_timer_get_time();
+  for (uint32_t r = 0; r < rounds; r++) {
+    legacy_flush_loop(legacy, pixels);
+  }
+  const int64_t legacy_us = esp_timer_get_time() - start;
+
+  // One strip-sized area, as flush_cb sees it.
+  start = esp_timer_get_time();
+  for (uint32_t r = 0; r < rounds; r++) {
+    Workshop::FlushStages::run(fused, pixels, 1);
+  }
+  const int64_t fused_us = esp_timer_get_time() - start;
+
+  const bool match = memcmp(legacy, fused, bytes) == 0;
+  if (!match) {
+    ESP_LOGE(TAG, "Pipeline output differs from the legacy loop");
+  }
+  Telemetry::emit("flush_pipeline",
+                  "stages=%u px=%u rounds=%u legacy_us=%lld fused_us=%lld "
+                  "speedup=%.2f match=%d",
+                  (unsigned)Workshop::FlushStages::kStages, (unsigned)pixels,
+                  (unsigned)rounds, (long long)legacy_us, (long long)fused_us,
+                  fused_us > 0 ? (float)legacy_us / fused_us : 0.0f, match);
+  heap_caps_free(legacy);
+  heap_caps_free(fused);
+}
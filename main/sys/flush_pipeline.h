@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Inlined into flush_cb, so the loop lives wherever flush_cb does (IRAM
+// with WORKSHOP_IRAM_FLUSH).
+#define WORKSHOP_FLUSH_INLINE inline __attribute__((always_inline))
+
+/**
+ * FLUSH PIPELINE
+ * --------------
+ * The per-pixel work flush_cb does before a strip goes on the wire, as a
+ * list of stages fused at compile time into one pass over each row:
+ *
+ *     using Pipeline = FlushPipeline<BswapBuiltin, Invert>;
+ *     Pipeline::run(px, w, h);
+ *
+ * A stage is a type with two static functions: apply() for one RGB565 pixel
+ * and apply2() for two pixels packed in a 32-bit word (first pixel in the
+ * low half). run() chains every stage on every pixel in a single loop, so
+ * the loop holds no branch on which stages are enabled, and a new stage adds
+ * work to that loop rather than another trip through the buffer.
+ *
+ * Rows are processed a word at a time; a pixel at either end that does not
+ * fill a word goes through apply(). workshop_config.h picks the stages for
+ * the selected phase (Workshop::FlushStages).
+ */
+
+template <typename... Stages>
+struct FlushPipeline {
+  static constexpr size_t kStages = sizeof...(Stages);
+
+  WORKSHOP_FLUSH_INLINE static uint16_t apply(uint16_t px) {
+    ((px = Stages::apply(px)), ...);
+    return px;
+  }
+
+  WORKSHOP_FLUSH_INLINE static uint32_t apply2(uint32_t two_px) {
+    ((two_px = Stages::apply2(two_px)), ...);
+    return two_px;
+  }
+
+  /** Transform a w x h area in place (rows are contiguous). */
+  WORKSHOP_FLUSH_INLINE static void run(uint16_t* px, uint32_t w, uint32_t h) {
+    if constexpr (kStages > 0) {
+      for (uint32_t y = 0; y < h; y++, px += w) {
+        row(px, w);
+      }
+    }
+  }
+
+  WORKSHOP_FLUSH_INLINE static void row(uint16_t* px, uint32_t n) {
+    // The buffer is at least 2-byte aligned: at most one pixel before the
+    // first word boundary.
+    if (n > 0 && (reinterpret_cast<uintptr_t>(px) & 2)) {
+      *px = apply(*px);
+      px++;
+      n--;
+    }
+    auto* words = reinterpret_cast<Word*>(px);
+    for (uint32_t i = 0; i < n / 2; i++) {
+      words[i] = apply2(words[i]);
+    }
+    if (n & 1) {
+      px[n - 1] = apply(px[n - 1]);
+    }
+  }
+
+ private:
+  typedef uint32_t __attribute__((may_alias)) Word;
+};
+
+/**
+ * RGB565 byte swap for the big-endian panel with plain shifts (the code
+ * before phase 4).
+ */
+struct BswapShift {
+  static inline uint16_t apply(uint16_t px) {
+    return (uint16_t)((px >> 8) | (px << 8));
+  }
+  static inline uint32_t apply2(uint32_t two_px) {
+    return ((two_px & 0x00FF00FFu) << 8) | ((two_px >> 8) & 0x00FF00FFu);
+  }
+};
+
+/**
+ * RGB565 byte swap with __builtin_bswap16/32, single instructions on the
+ * Xtensa core. bswap32 also swaps the two pixels; the rotate puts them back.
+ */
+struct BswapBuiltin {
+  static inline uint16_t apply(uint16_t px) { return __builtin_bswap16(px); }
+  static inline uint32_t apply2(uint32_t two_px) {
+    const uint32_t swapped = __builtin_bswap32(two_px);
+    return (swapped >> 16) | (swapped << 16);
+  }
+};
+
+/**
+ * Bitwise inversion, for panels that show a negative image.
+ */
+struct Invert {
+  static inline uint16_t apply(uint16_t px) { return (uint16_t)~px; }
+  static inline uint32_t apply2(uint32_t two_px) { return ~two_px; }
+};
+
+/**
+ * Time Workshop::FlushStages against the per-pixel loop flush_cb used
+ * before the pipeline (same byte-swap choice) on a buffer of `pixels`
+ * pixels in the draw-buffer heap, check that both produce the same bytes
+ * and print a TLM flush_pipeline record.
+ */
+void benchmark_flush_pipeline(size_t pixels, uint32_t rounds);
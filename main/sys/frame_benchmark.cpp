@@ -0,0 +1,164 @@
+#include "sys/frame_benchmark.h"
+
+#include <algorithm>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "lvgl.h"
+#include "sys/alloc_counter.h"
+#include "sys/lvgl_port.h"
+#include "sys/telemetry.h"
+#include "workshop_config.h"
+
+static const char* TAG = "FrameBenchmark";
+
+/**
+ * DETERMINISTIC FRAME BENCHMARK: Implementation
+ * ---------------------------------------------
+ * The port advances LVGL's tick with lv_tick_inc() from a periodic timer,
+ * or the frame pacer supplies it through lv_tick_set_cb(). The benchmark's
+ * own callback overrides either while it runs; when we hand control back we
+ * first advance the real clock to the virtual time so that no animation
+ * sees time jump backwards.
+ */
+
+uint32_t FrameBenchmark::virtual_ms_ = 0;
+
+FrameBenchmark::FrameBenchmark(LvglPort& port, uint32_t frame_period_ms)
+    : port_(port), frame_period_us_(frame_period_ms * 1000) {}
+
+uint32_t FrameBenchmark::virtual_tick() { return virtual_ms_; }
+
+struct FrameBenchmark::Job {
+  FrameBenchmark* self;
+  uint32_t frames;
+  const FrameHook* hook;
+  Result result;
+  SemaphoreHandle_t done;
+};
+
+FrameBenchmark::Result FrameBenchmark::run(uint32_t frames,
+                                           const FrameHook& hook) {
+  Job job = {this, frames, &hook, Result{}, xSemaphoreCreateBinary()};
+  if (!job.done) {
+    ESP_LOGE(TAG, "Out of memory");
+    return job.result;
+  }
+
+  const CpuMonitor::Snapshot cpu_before = CpuMonitor::snapshot();
+  {
+    LvglPort::Lock guard(port_);
+    lv_async_call(run_job, &job);
+  }
+  port_.notify_event(0);
+  xSemaphoreTake(job.done, portMAX_DELAY);
+  vSemaphoreDelete(job.done);
+  if (CpuMonitor::ready()) {
+    job.result.cpu = CpuMonitor::usage(cpu_before, CpuMonitor::snapshot());
+  }
+  return job.result;
+}
+
+void FrameBenchmark::run_job(void* arg) {
+  auto* job = static_cast<Job*>(arg);
+  job->result = job->self->run_frames(job->frames, *job->hook);
+  xSemaphoreGive(job->done);
+}
+
+FrameBenchmark::Result FrameBenchmark::run_frames(uint32_t frames,
+                                                  const FrameHook& hook) {
+  Result result;
+  lvgl::Display* display = port_.get_display();
+  if (!display) {
+    ESP_LOGE(TAG, "No display");
+    return result;
+  }
+  lv_display_t* disp = display->raw();
+  FrameRecorder* recorder = port_.get_recorder();
+
+  const uint32_t start_ms = lv_tick_get();
+  virtual_ms_ = start_ms;
+  lv_tick_set_cb(virtual_tick);
+
+  // Warm-up: a full redraw so that caches and the first layout are not
+  // billed to frame 0.
+  lv_obj_invalidate(lv_display_get_screen_active(disp));
+  lv_refr_now(disp);
+  uint32_t last_seq = recorder ? recorder->last_frame().seq : 0;
+
+  for (uint32_t i = 0; i < frames; i++) {
+    // Derived from the frame count, so fractional periods do not drift.
+    virtual_ms_ =
+        start_ms + (uint32_t)((uint64_t)(i + 1) * frame_period_us_ / 1000);
+
+    const uint32_t allocs_before = AllocCounter::allocs();
+    int64_t start_us = esp_timer_get_time();
+    // Step the animations first so their cost can be told apart from
+    // rendering; lv_refr_now() then finds them up to date.
+    lv_anim_refr_now();
+    result.anim_us += (uint64_t)(esp_timer_get_time() - start_us);
+    if (full_redraw_) {
+      lv_obj_invalidate(lv_display_get_screen_active(disp));
+    }
+    lv_refr_now(disp);  // Renders and flushes.
+    uint32_t frame_us = (uint32_t)(esp_timer_get_time() - start_us);
+    result.allocs += AllocCounter::allocs() - allocs_before;
+
+    result.frames++;
+    result.wall_us += frame_us;
+    result.min_us = std::min(result.min_us, frame_us);
+    result.max_us = std::max(result.max_us, frame_us);
+    // Static scenes produce no recorded frame; only count fresh records.
+    if (recorder && recorder->last_frame().seq != last_seq) {
+      const FrameRecorder::Frame& f = recorder->last_frame();
+      last_seq = f.seq;
+      result.render_us += f.render_us;
+      result.flush_us += f.flush_us;
+      result.flushed_px += f.flushed_px;
+      result.dirty_px += f.dirty_px;
+      const uint32_t free_heap = f.free_internal + f.free_psram;
+      if (result.min_free_heap == 0 || free_heap < result.min_free_heap) {
+        result.min_free_heap = free_heap;
+      }
+    }
+
+    if (hook) {
+      hook(i);
+    }
+  }
+
+  // Hand the clock back without letting it run backwards: to the frame
+  // pacer's clock when it drives the tick, otherwise to the port's counter.
+  if (FramePacer* pacer = port_.get_pacer()) {
+    pacer->resume_clock(virtual_ms_);
+  } else {
+    lv_tick_set_cb(nullptr);
+    uint32_t real_ms = lv_tick_get();
+    if ((int32_t)(virtual_ms_ - real_ms) > 0) {
+      lv_tick_inc(virtual_ms_ - real_ms);
+    }
+  }
+
+  return result;
+}
+
+void FrameBenchmark::Result::emit(const char* animal, int phase,
+                                  size_t free_before) const {
+  const uint32_t n = frames ? frames : 1;
+  char cpu_fields[160] = "";
+  if (CpuMonitor::ready()) {
+    cpu_fields[0] = ' ';
+    cpu.format(cpu_fields + 1, sizeof(cpu_fields) - 1);
+  }
+  Telemetry::emit("bench",
+                  "phase=%d res=%dx%d animal=%s frames=%u ms_per_frame=%.2f "
+                  "fps=%.1f min_ms=%.2f max_ms=%.2f render_ms=%.2f "
+                  "flush_ms=%.2f flushed_px=%llu allocs=%u heap_bytes=%u%s",
+                  phase, Workshop::H_RES, Workshop::V_RES, animal,
+                  (unsigned)frames, ms_per_frame(), fps(), min_us / 1000.0f,
+                  max_us / 1000.0f, render_us / 1000.0f / n,
+                  flush_us / 1000.0f / n, (unsigned long long)flushed_px,
+                  (unsigned)allocs, (unsigned)heap_bytes(free_before),
+                  cpu_fields);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "sys/cpu_monitor.h"
+
+class LvglPort;
+
+/**
+ * DETERMINISTIC FRAME BENCHMARK
+ * -----------------------------
+ * Renders a fixed number of frames with LVGL's clock replaced by a virtual
+ * one that advances exactly one frame period per frame. Animations therefore
+ * step through the same states on every run, regardless of how long each
+ * frame actually takes, which makes results comparable across phases,
+ * builds and the host simulator.
+ *
+ * The frames are rendered on the LVGL task itself (the run is posted with
+ * lv_async_call), so stack depth, core affinity and caches match normal
+ * operation. The calling task blocks until the run completes; input is not
+ * polled meanwhile.
+ */
+class FrameBenchmark {
+ public:
+  struct Result {
+    uint32_t frames = 0;
+    uint64_t wall_us = 0;
+    uint32_t min_us = UINT32_MAX;
+    uint32_t max_us = 0;
+    uint64_t render_us = 0;  // From the flight recorder, if enabled.
+    uint64_t flush_us = 0;
+    uint64_t flushed_px = 0;
+    uint64_t dirty_px = 0;       // Invalidated pixels (overlaps counted).
+    uint32_t min_free_heap = 0;  // Lowest free heap seen (internal + PSRAM).
+    uint64_t anim_us = 0;        // Time spent updating animations.
+    uint32_t allocs = 0;         // Heap allocations (WORKSHOP_ALLOC_COUNTING).
+    CpuMonitor::Usage cpu;       // Over the run (WORKSHOP_CPU_MONITOR).
+
+    float ms_per_frame() const {
+      return frames ? wall_us / 1000.0f / frames : 0.0f;
+    }
+    float fps() const { return wall_us ? frames * 1e6f / wall_us : 0.0f; }
+
+    /**
+     * Heap held at the run's peak (objects, animations, caches, ThorVG
+     * scratch), given the free heap before the scene was built.
+     */
+    size_t heap_bytes(size_t free_before) const {
+      return (min_free_heap && free_before > min_free_heap)
+                 ? free_before - min_free_heap
+                 : 0;
+    }
+
+    /**
+     * Print the TLM bench record for one animal, with the per-core figures
+     * appended when the CPU monitor runs.
+     */
+    void emit(const char* animal, int phase, size_t free_before) const;
+  };
+
+  /**
+   * Called on the LVGL task after every frame with the zero-based frame
+   * index.
+   */
+  using FrameHook = std::function<void(uint32_t frame)>;
+
+  explicit FrameBenchmark(LvglPort& port, uint32_t frame_period_ms = 33);
+
+  /**
+   * Render `frames` frames (plus one untimed warm-up frame). Must not be
+   * called from the LVGL task.
+   */
+  Result run(uint32_t frames, const FrameHook& hook = nullptr);
+
+  /**
+   * Invalidate the whole screen before every frame, so each frame renders
+   * and flushes every pixel (cost versus panel area).
+   */
+  void set_full_redraw(bool enabled) { full_redraw_ = enabled; }
+
+  /**
+   * Step the virtual clock by a fractional frame period, e.g. 33333 us for
+   * exactly 30 frames per second of animation time.
+   */
+  void set_frame_period_us(uint32_t period_us) {
+    frame_period_us_ = period_us;
+  }
+  uint32_t frame_period_us() const { return frame_period_us_; }
+
+ private:
+  struct Job;
+  static void run_job(void* job);
+  Result run_frames(uint32_t frames, const FrameHook& hook);
+
+  static uint32_t virtual_tick();
+  static uint32_t virtual_ms_;
+
+  LvglPort& port_;
+  uint32_t frame_period_us_;
+  bool full_redraw_ = false;
+};
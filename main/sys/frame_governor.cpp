@@ -0,0 +1,185 @@
+#include "sys/frame_governor.h"
+
+#include <algorithm>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sys/telemetry.h"
+
+static const char* TAG = "FrameGovernor";
+
+/**
+ * FRAME GOVERNOR: Implementation
+ * ------------------------------
+ * Costs are tracked in "max-frequency microseconds": a frame that ran
+ * unlocked at min_mhz is scaled down by min/max, so locked and unlocked
+ * frames feed the same moving average and the same active-cycle total.
+ *
+ * Jitter needs a reference interval. A fixed LV_DEF_REFR_PERIOD is wrong as
+ * soon as anything else sets the cadence (the frame pacer's slots, frames
+ * that take longer than a period), so the reference is the median of the
+ * last kIntervalWindow intervals: robust against the late frames we are
+ * trying to measure, and it follows rate changes within a few frames.
+ */
+
+FrameGovernor::FrameGovernor(const Config& config)
+    : config_(config), budget_us_(config.budget_ms * 1000) {}
+
+FrameGovernor::~FrameGovernor() {
+  if (lock_) {
+    if (locked_) esp_pm_lock_release(lock_);
+    esp_pm_lock_delete(lock_);
+  }
+}
+
+bool FrameGovernor::init() {
+  if (config_.min_mhz <= 0 || config_.max_mhz <= config_.min_mhz) {
+    return false;
+  }
+  esp_err_t err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "frame", &lock_);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create PM lock: %s", esp_err_to_name(err));
+    return false;
+  }
+  window_start_us_ = esp_timer_get_time();
+  ESP_LOGI(TAG, "%d MHz while rendering, %d MHz between frames, budget %u ms",
+           config_.max_mhz, config_.min_mhz, (unsigned)config_.budget_ms);
+  return true;
+}
+
+void FrameGovernor::attach(lv_display_t* disp) {
+  if (!lock_ || !disp) {
+    return;
+  }
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_REFR_START, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_FLUSH_START, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_REFR_READY, this);
+}
+
+void FrameGovernor::event_cb(lv_event_t* e) {
+  auto* self = static_cast<FrameGovernor*>(lv_event_get_user_data(e));
+  const int64_t now = esp_timer_get_time();
+  switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+      self->on_refr_start(now);
+      break;
+    case LV_EVENT_FLUSH_START:
+      self->flushed_ = true;
+      break;
+    case LV_EVENT_REFR_READY:
+      self->on_refr_ready(now);
+      break;
+    default:
+      break;
+  }
+}
+
+void FrameGovernor::on_refr_start(int64_t now) {
+  // 1. Jitter: only meaningful while something is supposed to move. An idle
+  // stretch starts a new median.
+  if (lv_anim_count_running() == 0) {
+    interval_count_ = 0;
+  } else if (prev_start_us_) {
+    const uint32_t interval = (uint32_t)(now - prev_start_us_);
+    intervals_[interval_next_] = interval;
+    interval_next_ = (interval_next_ + 1) % kIntervalWindow;
+    interval_count_ = std::min(interval_count_ + 1, kIntervalWindow);
+    // A handful of intervals before the median means anything.
+    if (interval_count_ >= 5) {
+      const uint32_t median_us = median_interval_us();
+      const uint32_t deviation = interval > median_us
+                                     ? interval - median_us
+                                     : median_us - interval;
+      jitter_sum_us_ += deviation;
+      jitter_samples_++;
+      if (deviation > jitter_max_us_.load(std::memory_order_relaxed)) {
+        jitter_max_us_.store(deviation, std::memory_order_relaxed);
+      }
+    }
+  }
+  prev_start_us_ = now;
+
+  // 2. Decide: would the frame still fit the budget at min_mhz? An unknown
+  // cost (cold start) always takes the lock.
+  const uint64_t slow_cost_us =
+      (uint64_t)cost_ema_us_ * config_.max_mhz / config_.min_mhz;
+  const uint64_t allowed_us =
+      (uint64_t)budget_us_ * config_.headroom_pct / 100;
+  if (cost_ema_us_ == 0 || slow_cost_us > allowed_us) {
+    locked_ = esp_pm_lock_acquire(lock_) == ESP_OK;
+  }
+
+  frame_start_us_ = now;
+  flushed_ = false;
+  in_frame_ = true;
+}
+
+void FrameGovernor::on_refr_ready(int64_t now) {
+  if (!in_frame_) {
+    return;
+  }
+  in_frame_ = false;
+
+  // 3. Cost in max-frequency microseconds.
+  const bool was_locked = locked_;
+  uint32_t cost_us = (uint32_t)(now - frame_start_us_);
+  if (!was_locked) {
+    cost_us = (uint32_t)((uint64_t)cost_us * config_.min_mhz /
+                         config_.max_mhz);
+  }
+  active_us_ += cost_us;
+
+  if (was_locked) {
+    esp_pm_lock_release(lock_);
+    locked_ = false;
+  }
+
+  // Empty refresh passes are cheap and say nothing about the next frame.
+  if (flushed_) {
+    cost_ema_us_ = cost_ema_us_ ? (cost_ema_us_ * 7 + cost_us) / 8
+                                : (cost_us ? cost_us : 1);
+    frames_++;
+    if (was_locked) locked_frames_++;
+  }
+}
+
+uint32_t FrameGovernor::median_interval_us() const {
+  uint32_t sorted[kIntervalWindow];
+  std::copy(intervals_, intervals_ + interval_count_, sorted);
+  uint32_t* mid = sorted + interval_count_ / 2;
+  std::nth_element(sorted, mid, sorted + interval_count_);
+  return *mid;
+}
+
+FrameGovernor::Stats FrameGovernor::take_stats() {
+  const int64_t now = esp_timer_get_time();
+  Stats stats;
+  stats.wall_us = (uint64_t)(now - window_start_us_.exchange(now));
+  stats.frames = frames_.exchange(0);
+  stats.locked_frames = locked_frames_.exchange(0);
+  stats.active_us = active_us_.exchange(0);
+  stats.jitter_sum_us = jitter_sum_us_.exchange(0);
+  stats.jitter_max_us = jitter_max_us_.exchange(0);
+  stats.jitter_samples = jitter_samples_.exchange(0);
+  stats.cost_us = cost_ema_us_;
+  return stats;
+}
+
+void FrameGovernor::report() {
+  Stats s = take_stats();
+  ESP_LOGI(TAG,
+           "%u frames (%u at %d MHz), active %.1f%%, cost %.2f ms, "
+           "jitter avg %.2f ms max %.2f ms",
+           (unsigned)s.frames, (unsigned)s.locked_frames, config_.max_mhz,
+           s.active_pct(), s.cost_us / 1000.0f, s.jitter_avg_us() / 1000.0f,
+           s.jitter_max_us / 1000.0f);
+  Telemetry::emit("pm",
+                  "max_mhz=%d min_mhz=%d frames=%u locked_frames=%u "
+                  "wall_us=%llu active_us=%llu active_pct=%.1f cost_us=%u "
+                  "jitter_avg_us=%.0f jitter_max_us=%u",
+                  config_.max_mhz, config_.min_mhz, (unsigned)s.frames,
+                  (unsigned)s.locked_frames, (unsigned long long)s.wall_us,
+                  (unsigned long long)s.active_us, s.active_pct(),
+                  (unsigned)s.cost_us, s.jitter_avg_us(),
+                  (unsigned)s.jitter_max_us);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_pm.h"
+#include "lvgl.h"
+
+/**
+ * FRAME GOVERNOR
+ * --------------
+ * Pinning the CPU at 240 MHz keeps the chip at full power even when a frame
+ * takes 10 ms of a 33 ms budget. The governor lets esp_pm run the CPU at a
+ * low frequency (or in light sleep) between frames and holds an
+ * ESP_PM_CPU_FREQ_MAX lock only from LV_EVENT_REFR_START to REFR_READY,
+ * i.e. while LVGL renders and flushes. The SPI driver holds its own PM lock
+ * while a DMA transfer is still on the wire.
+ *
+ * It adapts to the measured frame cost: when a frame would still fit the
+ * budget at the low frequency (with headroom), the lock is skipped and the
+ * frame renders slowly; as soon as the cost grows, the lock comes back.
+ *
+ * Reported per window:
+ *   active_pct: active-cycle fraction, the energy proxy: CPU cycles spent
+ *               in frames over the cycles the window would have at max
+ *               frequency. 100% means no cycle was left to save.
+ *   jitter:     deviation of frame start intervals from their running
+ *               median while animations run (wake-up latency shows up
+ *               here). The median is the cadence the display actually
+ *               settled on, whether LV_DEF_REFR_PERIOD, a frame pacer's
+ *               rate or slower frames, so a steady rate reads as zero.
+ */
+class FrameGovernor {
+ public:
+  struct Config {
+    int max_mhz = 240;
+    int min_mhz = 80;
+    uint32_t budget_ms = 33;     // Frame budget the cost is compared with.
+    uint32_t headroom_pct = 70;  // Unlocked frames may use this much.
+  };
+
+  struct Stats {
+    uint32_t frames = 0;
+    uint32_t locked_frames = 0;
+    uint64_t wall_us = 0;
+    uint64_t active_us = 0;  // Frame time in max-frequency equivalents.
+    uint64_t jitter_sum_us = 0;
+    uint32_t jitter_max_us = 0;
+    uint32_t jitter_samples = 0;
+    uint32_t cost_us = 0;  // Smoothed frame cost, scaled to max_mhz.
+
+    float active_pct() const {
+      return wall_us ? 100.0f * active_us / wall_us : 0.0f;
+    }
+    float jitter_avg_us() const {
+      return jitter_samples ? (float)jitter_sum_us / jitter_samples : 0.0f;
+    }
+  };
+
+  explicit FrameGovernor(const Config& config);
+  ~FrameGovernor();
+
+  FrameGovernor(const FrameGovernor&) = delete;
+  FrameGovernor& operator=(const FrameGovernor&) = delete;
+
+  /**
+   * Create the PM lock. esp_pm must already be configured with the desired
+   * min/max frequency and light sleep setting.
+   * @return True if the governor is ready to use.
+   */
+  bool init();
+
+  /**
+   * Subscribe to the display's refresh events. Call with the LVGL lock
+   * held.
+   */
+  void attach(lv_display_t* disp);
+
+  /**
+   * Compare frame costs with this budget from now on, e.g. the frame
+   * pacer's slot period, which changes with its rate. Call from the LVGL
+   * task.
+   */
+  void set_budget_us(uint32_t budget_us) { budget_us_ = budget_us; }
+
+  /**
+   * Copy and clear the statistics of the current window. Safe to call from
+   * any task.
+   */
+  Stats take_stats();
+
+  /** Log and emit a `TLM pm` record for the current window, then reset. */
+  void report();
+
+ private:
+  static void event_cb(lv_event_t* e);
+  void on_refr_start(int64_t now);
+  void on_refr_ready(int64_t now);
+  uint32_t median_interval_us() const;
+
+  // Start intervals the jitter median is taken over.
+  static constexpr size_t kIntervalWindow = 15;
+
+  Config config_;
+  esp_pm_lock_handle_t lock_ = nullptr;
+
+  // Only touched from the LVGL task.
+  uint32_t budget_us_;
+  bool locked_ = false;
+  bool in_frame_ = false;
+  bool flushed_ = false;
+  int64_t frame_start_us_ = 0;
+  int64_t prev_start_us_ = 0;
+  uint32_t cost_ema_us_ = 0;
+  uint32_t intervals_[kIntervalWindow] = {};
+  size_t interval_count_ = 0;
+  size_t interval_next_ = 0;
+
+  // Window counters, read by take_stats() from another task.
+  std::atomic<uint32_t> frames_{0};
+  std::atomic<uint32_t> locked_frames_{0};
+  std::atomic<uint64_t> active_us_{0};
+  std::atomic<uint64_t> jitter_sum_us_{0};
+  std::atomic<uint32_t> jitter_max_us_{0};
+  std::atomic<uint32_t> jitter_samples_{0};
+  std::atomic<int64_t> window_start_us_{0};
+};
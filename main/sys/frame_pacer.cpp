@@ -0,0 +1,323 @@
+#include "sys/frame_pacer.h"
+
+#include <algorithm>
+
+#include "esp_log.h"
+#include "sys/telemetry.h"
+
+static const char* TAG = "FramePacer";
+
+/**
+ * FRAME PACING: Implementation
+ * ----------------------------
+ * The slot timer runs in the esp_timer task; everything else runs in the
+ * LVGL task. They share the slot counter, the slot start time and the
+ * clock, all atomics. A rate change restarts the slot timer from the LVGL
+ * task, so the slot in progress may be measured against the old period.
+ *
+ * The refresh runs synchronously inside on_slot(), so its cost is simply
+ * the time refresh_handler_ took; display events inside it only split that
+ * time into render and flush. Refreshes that do not come from a slot (e.g.
+ * lv_refr_now() in FrameBenchmark) are ignored.
+ */
+
+FramePacer* FramePacer::instance_ = nullptr;
+
+FramePacer::FramePacer(const Config& config, RefreshHandler refresh_handler,
+                       WakeHandler wake_handler)
+    : config_(config),
+      refresh_handler_(std::move(refresh_handler)),
+      wake_handler_(std::move(wake_handler)) {}
+
+FramePacer::~FramePacer() {
+  if (slot_timer_) {
+    esp_timer_stop(slot_timer_);
+    esp_timer_delete(slot_timer_);
+  }
+  if (instance_ == this) {
+    lv_tick_set_cb(nullptr);
+    instance_ = nullptr;
+  }
+}
+
+bool FramePacer::init() {
+  if (config_.max_hz == 0 || config_.max_divisor == 0 || !refresh_handler_) {
+    return false;
+  }
+  esp_timer_create_args_t args = {};
+  args.callback = slot_cb;
+  args.arg = this;
+  args.name = "frame_slot";
+  esp_err_t err = esp_timer_create(&args, &slot_timer_);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create slot timer: %s", esp_err_to_name(err));
+    return false;
+  }
+  return true;
+}
+
+void FramePacer::attach(lv_display_t* disp) {
+  if (!slot_timer_ || !disp || instance_) {
+    return;
+  }
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_RENDER_START, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_RENDER_READY, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_FLUSH_START, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_FLUSH_FINISH, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_FLUSH_WAIT_START, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_FLUSH_WAIT_FINISH, this);
+
+  // The timer's period tracks the slot period: on the frame clock it then
+  // fires once per slot, and lv_timer_handler() lets the task sleep until
+  // the slot timer wakes it.
+  timer_ = lv_timer_create(timer_cb, 1, this);
+
+  instance_ = this;
+  offset_ms_ = lv_tick_get();
+  lv_tick_set_cb(frame_clock);
+  set_divisor(1);
+
+  ESP_LOGI(TAG, "Pacing at %u Hz (down to %u Hz), headroom %u%%",
+           (unsigned)config_.max_hz,
+           (unsigned)(config_.max_hz / config_.max_divisor),
+           (unsigned)config_.headroom_pct);
+}
+
+uint32_t FramePacer::frame_clock() {
+  return instance_->offset_ms_.load(std::memory_order_relaxed) +
+         instance_->elapsed_ms_.load(std::memory_order_relaxed);
+}
+
+void FramePacer::resume_clock(uint32_t now_ms) {
+  if (instance_ != this) {
+    return;
+  }
+  const uint32_t clock = frame_clock();
+  if ((int32_t)(now_ms - clock) > 0) {
+    offset_ms_ += now_ms - clock;
+  }
+  lv_tick_set_cb(frame_clock);
+}
+
+uint32_t FramePacer::period_us(uint32_t divisor) const {
+  return (uint32_t)((uint64_t)divisor * 1000000 / config_.max_hz);
+}
+
+void FramePacer::slot_cb(void* arg) {
+  auto* self = static_cast<FramePacer*>(arg);
+  // Whole periods in microseconds: the millisecond clock never drifts, even
+  // though 60 Hz alternates between 16 and 17 ms steps.
+  self->elapsed_us_ += self->period_us_.load(std::memory_order_relaxed);
+  self->elapsed_ms_.store((uint32_t)(self->elapsed_us_ / 1000),
+                          std::memory_order_relaxed);
+  self->slot_start_us_ = esp_timer_get_time();
+  self->slot_++;
+  self->slots_++;
+  if (self->wake_handler_) {
+    self->wake_handler_();
+  }
+}
+
+void FramePacer::timer_cb(lv_timer_t* timer) {
+  static_cast<FramePacer*>(lv_timer_get_user_data(timer))->on_slot();
+}
+
+void FramePacer::event_cb(lv_event_t* e) {
+  auto* self = static_cast<FramePacer*>(lv_event_get_user_data(e));
+  if (!self->in_frame_) {
+    return;
+  }
+  const int64_t now = esp_timer_get_time();
+  switch (lv_event_get_code(e)) {
+    case LV_EVENT_RENDER_START:
+    case LV_EVENT_FLUSH_WAIT_START:
+      self->stage_start_us_ = now;
+      break;
+    case LV_EVENT_RENDER_READY:
+      self->frame_render_us_ += (uint32_t)(now - self->stage_start_us_);
+      break;
+    case LV_EVENT_FLUSH_START:
+      self->flushed_ = true;
+      self->flush_start_us_ = now;
+      break;
+    case LV_EVENT_FLUSH_FINISH:
+      self->frame_flush_us_ += (uint32_t)(now - self->flush_start_us_);
+      break;
+    case LV_EVENT_FLUSH_WAIT_FINISH:
+      self->frame_flush_us_ += (uint32_t)(now - self->stage_start_us_);
+      break;
+    default:
+      break;
+  }
+}
+
+void FramePacer::on_slot() {
+  // The clock also moves without a new slot (resume_clock()).
+  const uint32_t slot = slot_.load();
+  if (slot == handled_slot_) {
+    return;
+  }
+  handled_slot_ = slot;
+
+  // 1. Drop: would a frame started now still finish inside this slot? Only
+  // frames that make a slot when on time are dropped (at the slowest rate
+  // a frame that never fits still renders), and never two slots in a row,
+  // so a task that always wakes late still gets frames out.
+  const int64_t now = esp_timer_get_time();
+  const int64_t slot_start_us = slot_start_us_.load();
+  const uint32_t period = period_us_.load(std::memory_order_relaxed);
+  const uint32_t cost_us = std::max(cost_ema_us_, cost_peak_us_);
+  if (!dropped_last_ && cost_us > 0 && cost_us <= period &&
+      now - slot_start_us + cost_us > period) {
+    dropped_last_ = true;
+    dropped_++;
+    return;
+  }
+  dropped_last_ = false;
+
+  // 2. Render and flush every paced display.
+  in_frame_ = true;
+  flushed_ = false;
+  frame_render_us_ = 0;
+  frame_flush_us_ = 0;
+  refresh_handler_();
+  in_frame_ = false;
+
+  // Only passes that flushed are frames (see FrameGovernor::on_refr_ready).
+  if (flushed_) {
+    on_frame(slot, slot_start_us, now, esp_timer_get_time());
+  }
+}
+
+void FramePacer::on_frame(uint32_t slot, int64_t slot_start_us,
+                          int64_t start_us, int64_t end_us) {
+  const uint32_t period = period_us_.load(std::memory_order_relaxed);
+  const uint32_t cost_us = (uint32_t)(end_us - start_us);
+  frames_++;
+  if (end_us > slot_start_us + period) {
+    overruns_++;
+  }
+
+  // 3. Jitter: starts should be whole slot periods apart; only meaningful
+  // while something is supposed to move.
+  if (prev_start_us_ && lv_anim_count_running() > 0) {
+    const int64_t expected = (int64_t)(slot - prev_slot_) * period;
+    const int64_t interval = start_us - prev_start_us_;
+    const uint32_t deviation =
+        (uint32_t)(interval > expected ? interval - expected
+                                       : expected - interval);
+    jitter_sum_us_ += deviation;
+    jitter_samples_++;
+    if (deviation > jitter_max_us_.load(std::memory_order_relaxed)) {
+      jitter_max_us_.store(deviation, std::memory_order_relaxed);
+    }
+  }
+  prev_start_us_ = start_us;
+  prev_slot_ = slot;
+
+  // 4. Cost: a moving average, and a peak that decays over ~16 frames so
+  // one slow frame is not forgotten at once.
+  render_ema_us_ = render_ema_us_
+                       ? (render_ema_us_ * 7 + frame_render_us_) / 8
+                       : frame_render_us_;
+  flush_ema_us_ = flush_ema_us_ ? (flush_ema_us_ * 7 + frame_flush_us_) / 8
+                                : frame_flush_us_;
+  cost_ema_us_ = cost_ema_us_ ? (cost_ema_us_ * 7 + cost_us) / 8
+                              : std::max<uint32_t>(cost_us, 1);
+  cost_peak_us_ = std::max(cost_us, cost_peak_us_ - cost_peak_us_ / 16);
+
+  // 5. Rate: the fastest one the cost fits with headroom. Slow down at once,
+  // speed up one step after upgrade_frames frames in a row fit.
+  const uint32_t estimate_us = std::max(cost_ema_us_, cost_peak_us_);
+  uint32_t needed = config_.max_divisor;
+  for (uint32_t d = 1; d < config_.max_divisor; d++) {
+    if ((uint64_t)estimate_us * 100 <=
+        (uint64_t)period_us(d) * config_.headroom_pct) {
+      needed = d;
+      break;
+    }
+  }
+  if (needed > divisor_) {
+    set_divisor(needed);
+  } else if (needed < divisor_) {
+    if (++fit_frames_ >= config_.upgrade_frames) {
+      set_divisor(divisor_ - 1);
+    }
+  } else {
+    fit_frames_ = 0;
+  }
+}
+
+void FramePacer::set_divisor(uint32_t divisor) {
+  const bool changed = period_us_.load() != 0 && divisor != divisor_;
+  divisor_ = divisor;
+  fit_frames_ = 0;
+  prev_start_us_ = 0;  // The next interval spans two rates.
+
+  const uint32_t period = period_us(divisor);
+  period_us_ = period;
+  lv_timer_set_period(timer_, std::max<uint32_t>(1, period / 1000));
+  esp_timer_stop(slot_timer_);  // Not running on the first call.
+  esp_timer_start_periodic(slot_timer_, period);
+
+  if (changed) {
+    rate_changes_++;
+    const uint32_t cost_us = std::max(cost_ema_us_, cost_peak_us_);
+    ESP_LOGI(TAG, "Locked to %u Hz (frame cost %.2f ms)", (unsigned)hz(),
+             cost_us / 1000.0f);
+    Telemetry::emit("pacing_rate", "hz=%u cost_us=%u", (unsigned)hz(),
+                    (unsigned)cost_us);
+  }
+}
+
+void FramePacer::set_suspended(bool suspended) {
+  if (!timer_) {
+    return;
+  }
+  esp_timer_stop(slot_timer_);
+  if (suspended) {
+    return;
+  }
+  // The clock stood still; the next frame starts one period from now, and
+  // the interval across the pause is no jitter sample.
+  prev_start_us_ = 0;
+  esp_timer_start_periodic(slot_timer_, period_us_.load());
+}
+
+FramePacer::Stats FramePacer::take_stats() {
+  Stats stats;
+  stats.hz = hz();
+  stats.slots = slots_.exchange(0);
+  stats.frames = frames_.exchange(0);
+  stats.dropped = dropped_.exchange(0);
+  stats.overruns = overruns_.exchange(0);
+  stats.rate_changes = rate_changes_.exchange(0);
+  stats.render_us = render_ema_us_;
+  stats.flush_us = flush_ema_us_;
+  stats.cost_us = cost_ema_us_;
+  stats.jitter_sum_us = jitter_sum_us_.exchange(0);
+  stats.jitter_max_us = jitter_max_us_.exchange(0);
+  stats.jitter_samples = jitter_samples_.exchange(0);
+  return stats;
+}
+
+void FramePacer::report() {
+  Stats s = take_stats();
+  ESP_LOGI(TAG,
+           "%u Hz: %u frames in %u slots, %u dropped, %u overruns, cost "
+           "%.2f ms (render %.2f, flush %.2f), jitter avg %.2f ms max "
+           "%.2f ms",
+           (unsigned)s.hz, (unsigned)s.frames, (unsigned)s.slots,
+           (unsigned)s.dropped, (unsigned)s.overruns, s.cost_us / 1000.0f,
+           s.render_us / 1000.0f, s.flush_us / 1000.0f,
+           s.jitter_avg_us() / 1000.0f, s.jitter_max_us / 1000.0f);
+  Telemetry::emit("pacing",
+                  "hz=%u slots=%u frames=%u dropped=%u overruns=%u "
+                  "rate_changes=%u render_us=%u flush_us=%u cost_us=%u "
+                  "jitter_avg_us=%.0f jitter_max_us=%u",
+                  (unsigned)s.hz, (unsigned)s.slots, (unsigned)s.frames,
+                  (unsigned)s.dropped, (unsigned)s.overruns,
+                  (unsigned)s.rate_changes, (unsigned)s.render_us,
+                  (unsigned)s.flush_us, (unsigned)s.cost_us,
+                  s.jitter_avg_us(), (unsigned)s.jitter_max_us);
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "esp_timer.h"
+#include "lvgl.h"
+
+/**
+ * FRAME PACING
+ * ------------
+ * LV_DEF_REFR_PERIOD asks for a refresh every 16 ms, but a frame that takes
+ * 30 ms to render and flush makes every start late by a different amount:
+ * animations are sampled at uneven times and judder, and a refresh that
+ * starts too late to make its slot still runs in full.
+ *
+ * The pacer puts frames on a fixed grid instead. An esp_timer divides time
+ * into slots of max_hz / n (60, 30, 20, 15 Hz with the defaults), and LVGL's
+ * tick becomes a frame clock: it advances by exactly one slot period when a
+ * slot begins and stands still in between. Animations (and LVGL timers)
+ * therefore move in whole frame periods, two periods after a dropped slot.
+ *
+ * The refresh itself runs from the pacer's LVGL timer, once per slot:
+ *   - Rate: the render and flush cost is measured per frame; the pacer
+ *     locks to the fastest rate whose period the cost fits with headroom.
+ *     It drops to a slower rate at once and only moves up after
+ *     upgrade_frames frames in a row would have fit the faster one.
+ *   - Dropping: a slot that starts so late that the frame cannot finish
+ *     before the next slot is skipped. Nothing is rendered and nothing
+ *     queues; the next slot draws the scene at its own time (and is never
+ *     dropped itself). Slots that passed while a frame overran are skipped
+ *     the same way.
+ *
+ * Reported per window:
+ *   jitter:  deviation of frame start intervals from the whole number of
+ *            slot periods between them, while animations run.
+ *   dropped: slots skipped because they started too late.
+ *   overruns: frames that finished after their slot ended (the slots they
+ *            ran into are skipped without being counted as dropped).
+ *   cost:    the whole refresh; the render/flush split is display 0's.
+ */
+class FramePacer {
+ public:
+  struct Config {
+    uint32_t max_hz = 60;          // Fastest rate; slower ones divide it.
+    uint32_t max_divisor = 4;      // Slowest rate is max_hz / max_divisor.
+    uint32_t headroom_pct = 90;    // Share of a period a frame may use.
+    uint32_t upgrade_frames = 60;  // Fitting frames before a faster rate.
+  };
+
+  struct Stats {
+    uint32_t hz = 0;
+    uint32_t slots = 0;
+    uint32_t frames = 0;
+    uint32_t dropped = 0;
+    uint32_t overruns = 0;
+    uint32_t rate_changes = 0;
+    uint32_t render_us = 0;  // Smoothed per-frame costs.
+    uint32_t flush_us = 0;
+    uint32_t cost_us = 0;
+    uint64_t jitter_sum_us = 0;
+    uint32_t jitter_max_us = 0;
+    uint32_t jitter_samples = 0;
+
+    float jitter_avg_us() const {
+      return jitter_samples ? (float)jitter_sum_us / jitter_samples : 0.0f;
+    }
+  };
+
+  /** Runs one refresh of every paced display, in the LVGL task. */
+  using RefreshHandler = std::function<void()>;
+  /** Called when a slot begins, e.g. to kick the LVGL task. */
+  using WakeHandler = std::function<void()>;
+
+  FramePacer(const Config& config, RefreshHandler refresh_handler,
+             WakeHandler wake_handler);
+  ~FramePacer();
+
+  FramePacer(const FramePacer&) = delete;
+  FramePacer& operator=(const FramePacer&) = delete;
+
+  /**
+   * Create the slot timer.
+   * @return True if the pacer is ready to use.
+   */
+  bool init();
+
+  /**
+   * Measure the display's frames, take over LVGL's tick and start pacing.
+   * The caller parks the display's own refresh timer. Call with the LVGL
+   * lock held.
+   */
+  void attach(lv_display_t* disp);
+
+  /**
+   * The timer that refreshes once per slot; pause it along with
+   * set_suspended() to suspend rendering.
+   */
+  lv_timer_t* timer() const { return timer_; }
+
+  /**
+   * Reinstall the frame clock after someone else drove LVGL's tick (see
+   * FrameBenchmark), moving it forward to `now_ms` if it is behind. Call
+   * with the LVGL lock held.
+   */
+  void resume_clock(uint32_t now_ms);
+
+  uint32_t hz() const { return config_.max_hz / divisor_; }
+  uint32_t slot_us() const {
+    return period_us_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Stop the slot timer (and with it the frame clock and the refreshes)
+   * while nothing needs drawing, e.g. for StaticScene, or start it again.
+   * Call with the LVGL lock held.
+   */
+  void set_suspended(bool suspended);
+
+  /**
+   * Copy and clear the statistics of the current window. Safe to call from
+   * any task.
+   */
+  Stats take_stats();
+
+  /** Log and emit a `TLM pacing` record for the current window, then reset. */
+  void report();
+
+ private:
+  static uint32_t frame_clock();
+  static void slot_cb(void* arg);
+  static void timer_cb(lv_timer_t* timer);
+  static void event_cb(lv_event_t* e);
+  void on_slot();
+  void on_frame(uint32_t slot, int64_t slot_start_us, int64_t start_us,
+                int64_t end_us);
+  void set_divisor(uint32_t divisor);
+  uint32_t period_us(uint32_t divisor) const;
+
+  // LVGL's tick callback takes no argument: one frame clock per program.
+  static FramePacer* instance_;
+
+  Config config_;
+  RefreshHandler refresh_handler_;
+  WakeHandler wake_handler_;
+  esp_timer_handle_t slot_timer_ = nullptr;
+  lv_timer_t* timer_ = nullptr;
+
+  // Written by the slot timer; the clock is offset_ms_ + elapsed_ms_.
+  uint64_t elapsed_us_ = 0;
+  std::atomic<uint32_t> elapsed_ms_{0};
+  std::atomic<uint32_t> offset_ms_{0};
+  std::atomic<uint32_t> slot_{0};
+  std::atomic<int64_t> slot_start_us_{0};
+  std::atomic<uint32_t> period_us_{0};
+
+  // Only touched from the LVGL task.
+  uint32_t divisor_ = 1;
+  uint32_t handled_slot_ = 0;
+  uint32_t fit_frames_ = 0;
+  bool dropped_last_ = false;
+  bool in_frame_ = false;
+  bool flushed_ = false;
+  int64_t stage_start_us_ = 0;
+  int64_t flush_start_us_ = 0;
+  uint32_t frame_render_us_ = 0;
+  uint32_t frame_flush_us_ = 0;
+  uint32_t prev_slot_ = 0;
+  int64_t prev_start_us_ = 0;
+  uint32_t render_ema_us_ = 0;
+  uint32_t flush_ema_us_ = 0;
+  uint32_t cost_ema_us_ = 0;
+  uint32_t cost_peak_us_ = 0;
+
+  // Window counters, read by take_stats() from another task.
+  std::atomic<uint32_t> slots_{0};
+  std::atomic<uint32_t> frames_{0};
+  std::atomic<uint32_t> dropped_{0};
+  std::atomic<uint32_t> overruns_{0};
+  std::atomic<uint32_t> rate_changes_{0};
+  std::atomic<uint64_t> jitter_sum_us_{0};
+  std::atomic<uint32_t> jitter_max_us_{0};
+  std::atomic<uint32_t> jitter_samples_{0};
+};
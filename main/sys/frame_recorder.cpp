@@ -0,0 +1,239 @@
+#include "sys/frame_recorder.h"
+
+#include <cstring>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "FrameRecorder";
+
+/**
+ * FRAME FLIGHT RECORDER: Implementation
+ * -------------------------------------
+ * All frame bookkeeping happens inside LVGL display events, i.e. on the
+ * LVGL task, so the hot path is a handful of timestamp subtractions and
+ * one struct copy into the ring. Printing is deferred to dump_pending().
+ */
+
+FrameRecorder::FrameRecorder(size_t depth, uint32_t budget_ms)
+    : depth_(depth), budget_us_(budget_ms * 1000) {}
+
+FrameRecorder::~FrameRecorder() {
+  heap_caps_free(ring_);
+  heap_caps_free(snapshot_);
+}
+
+bool FrameRecorder::init() {
+  if (depth_ == 0) {
+    return false;
+  }
+
+  // The ring is written once per frame and read only on a dump, so the
+  // slower external RAM is a good home for it. Fall back to internal RAM on
+  // boards without PSRAM.
+  const size_t bytes = depth_ * sizeof(Frame);
+  ring_ = static_cast<Frame*>(heap_caps_calloc(1, bytes, MALLOC_CAP_SPIRAM));
+  snapshot_ =
+      static_cast<Frame*>(heap_caps_calloc(1, bytes, MALLOC_CAP_SPIRAM));
+  if (!ring_ || !snapshot_) {
+    ESP_LOGW(TAG, "No PSRAM for %u frames, using internal RAM",
+             (unsigned)depth_);
+    heap_caps_free(ring_);
+    heap_caps_free(snapshot_);
+    ring_ = static_cast<Frame*>(heap_caps_calloc(1, bytes, MALLOC_CAP_DEFAULT));
+    snapshot_ =
+        static_cast<Frame*>(heap_caps_calloc(1, bytes, MALLOC_CAP_DEFAULT));
+  }
+  if (!ring_ || !snapshot_) {
+    ESP_LOGE(TAG, "Failed to allocate flight recorder ring");
+    return false;
+  }
+
+  ESP_LOGI(TAG, "Recording last %u frames, budget %u ms", (unsigned)depth_,
+           (unsigned)(budget_us_ / 1000));
+  return true;
+}
+
+void FrameRecorder::attach(lv_display_t* disp) {
+  if (!ring_ || !disp) {
+    return;
+  }
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_ALL, this);
+}
+
+void FrameRecorder::event_cb(lv_event_t* e) {
+  auto* self = static_cast<FrameRecorder*>(lv_event_get_user_data(e));
+  self->on_event(lv_event_get_code(e), e);
+}
+
+void FrameRecorder::on_event(lv_event_code_t code, lv_event_t* e) {
+  const int64_t now = esp_timer_get_time();
+
+  switch (code) {
+    case LV_EVENT_INVALIDATE_AREA: {
+      auto* area = static_cast<const lv_area_t*>(lv_event_get_param(e));
+      pending_areas_++;
+      if (area) {
+        pending_dirty_px_ += lv_area_get_size(area);
+      }
+      break;
+    }
+    case LV_EVENT_REFR_START:
+      current_ = Frame{};
+      current_.start_us = now;
+      in_frame_ = true;
+      break;
+    case LV_EVENT_RENDER_START:
+      stage_start_us_ = now;
+      break;
+    case LV_EVENT_RENDER_READY:
+      if (in_frame_) current_.render_us += (uint32_t)(now - stage_start_us_);
+      break;
+    case LV_EVENT_FLUSH_START: {
+      flush_start_us_ = now;
+      auto* area = static_cast<const lv_area_t*>(lv_event_get_param(e));
+      if (in_frame_ && area) {
+        current_.flushed_px += lv_area_get_size(area);
+      }
+      break;
+    }
+    case LV_EVENT_FLUSH_FINISH:
+      if (in_frame_) {
+        current_.flush_us += (uint32_t)(now - flush_start_us_);
+        current_.flushes++;
+      }
+      break;
+    case LV_EVENT_FLUSH_WAIT_START:
+      flush_wait_start_us_ = now;
+      break;
+    case LV_EVENT_FLUSH_WAIT_FINISH:
+      if (in_frame_) {
+        current_.flush_wait_us += (uint32_t)(now - flush_wait_start_us_);
+      }
+      break;
+    case LV_EVENT_REFR_READY:
+      if (in_frame_) {
+        current_.total_us = (uint32_t)(now - current_.start_us);
+        commit_frame();
+      }
+      in_frame_ = false;
+      break;
+    default:
+      break;
+  }
+}
+
+void FrameRecorder::commit_frame() {
+  // Intervals run from the previous refresh pass, empty or not, and only
+  // when it ran while something animated: the first frame after a still
+  // stretch (or a static scene suspension) did not start late.
+  const uint16_t anims = (uint16_t)lv_anim_count_running();
+  const int64_t prev_start_us = prev_animating_ ? prev_start_us_ : 0;
+  prev_start_us_ = current_.start_us;
+  prev_animating_ = anims > 0;
+
+  // The refresh timer fires every period even when nothing changed. Those
+  // empty passes are not frames and would only flush real history out of
+  // the ring.
+  if (current_.flushes == 0 && pending_areas_ == 0) {
+    return;
+  }
+
+  current_.seq = ++seq_;
+  current_.interval_us =
+      prev_start_us ? (uint32_t)(current_.start_us - prev_start_us) : 0;
+
+  current_.dirty_areas = pending_areas_;
+  current_.dirty_px = pending_dirty_px_;
+  pending_areas_ = 0;
+  pending_dirty_px_ = 0;
+
+  current_.lock_wait_us = lock_wait_us_.exchange(0);
+  current_.lock_hold_us = lock_hold_us_.exchange(0);
+  current_.touch_us = touch_us_.exchange(0);
+  current_.active_anims = anims;
+  current_.free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  current_.free_psram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+
+  ring_[head_] = current_;
+  head_ = (head_ + 1) % depth_;
+  if (count_ < depth_) count_++;
+  last_ = current_;
+
+  // A frame is "jank" if it took too long itself, or if it started too late
+  // while something was animating (e.g. the task was stuck in a touch read).
+  const bool slow = current_.total_us > budget_us_;
+  const bool late = current_.active_anims > 0 && current_.interval_us > 0 &&
+                    current_.interval_us > budget_us_;
+  if (slow || late) {
+    jank_count_++;
+    freeze(current_);
+  }
+}
+
+void FrameRecorder::freeze(const Frame& trigger) {
+  if (snapshot_pending_.load(std::memory_order_acquire)) {
+    // The previous snapshot has not been printed yet; keep it intact.
+    suppressed_++;
+    return;
+  }
+
+  // Unroll the ring so the snapshot is oldest-first.
+  const size_t first = (head_ + depth_ - count_) % depth_;
+  for (size_t i = 0; i < count_; i++) {
+    snapshot_[i] = ring_[(first + i) % depth_];
+  }
+  snapshot_count_ = count_;
+  snapshot_trigger_ = trigger;
+  snapshot_pending_.store(true, std::memory_order_release);
+}
+
+size_t FrameRecorder::copy_since(uint32_t since_seq, Frame* out,
+                                 size_t max) const {
+  const size_t first = (head_ + depth_ - count_) % depth_;
+  size_t copied = 0;
+  for (size_t i = 0; i < count_ && copied < max; i++) {
+    const Frame& f = ring_[(first + i) % depth_];
+    if (f.seq > since_seq) {
+      out[copied++] = f;
+    }
+  }
+  return copied;
+}
+
+bool FrameRecorder::dump_pending() {
+  if (!snapshot_pending_.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  const Frame& t = snapshot_trigger_;
+  // Cleared as it is read, so a jank suppressed meanwhile is not lost.
+  const uint32_t suppressed = suppressed_.exchange(0);
+  ESP_LOGW(TAG,
+           "JANK frame #%u: %.1f ms (interval %.1f ms, budget %u ms), "
+           "%u jank total, %u suppressed",
+           (unsigned)t.seq, t.total_us / 1000.0f, t.interval_us / 1000.0f,
+           (unsigned)(budget_us_ / 1000), (unsigned)jank_count_.load(),
+           (unsigned)suppressed);
+  ESP_LOGW(TAG,
+           "  seq  intvl  total render  flush  fwait  lockw  lockh  touch "
+           "areas   dirty_px flushed_px anims   int_free  psram_free");
+  for (size_t i = 0; i < snapshot_count_; i++) {
+    const Frame& f = snapshot_[i];
+    ESP_LOGW(TAG,
+             "%5u %6u %6u %6u %6u %6u %6u %6u %6u %5u %10u %10u %5u %10u "
+             "%11u%s",
+             (unsigned)f.seq, (unsigned)f.interval_us, (unsigned)f.total_us,
+             (unsigned)f.render_us, (unsigned)f.flush_us,
+             (unsigned)f.flush_wait_us, (unsigned)f.lock_wait_us,
+             (unsigned)f.lock_hold_us, (unsigned)f.touch_us,
+             (unsigned)f.dirty_areas, (unsigned)f.dirty_px,
+             (unsigned)f.flushed_px, (unsigned)f.active_anims,
+             (unsigned)f.free_internal, (unsigned)f.free_psram,
+             f.seq == t.seq ? "  <== over budget" : "");
+  }
+
+  snapshot_pending_.store(false, std::memory_order_release);
+  return true;
+}
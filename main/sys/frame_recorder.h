@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "lvgl.h"
+
+/**
+ * FRAME FLIGHT RECORDER
+ * ---------------------
+ * Average FPS hides the occasional 80 ms frame. This recorder is always on:
+ * it listens to the display's refresh events and keeps the last N frames
+ * (stage timings, dirty areas, lock waits, heap and animation counts) in a
+ * ring that lives in PSRAM. When a frame blows the configured budget, the
+ * ring is frozen into a snapshot that the maintenance loop dumps over the
+ * console, so stutter can be diagnosed after the fact.
+ */
+class FrameRecorder {
+ public:
+  struct Frame {
+    uint32_t seq = 0;
+    int64_t start_us = 0;        // LV_EVENT_REFR_START timestamp.
+    uint32_t interval_us = 0;    // Start-to-start distance to previous pass.
+    uint32_t total_us = 0;       // REFR_START -> REFR_READY.
+    uint32_t render_us = 0;      // Sum of RENDER_START -> RENDER_READY.
+    uint32_t flush_us = 0;       // Sum of FLUSH_START -> FLUSH_FINISH.
+    uint32_t flush_wait_us = 0;  // Sum of FLUSH_WAIT_START -> FINISH.
+    uint32_t lock_wait_us = 0;   // Time other tasks waited for the lock.
+    uint32_t lock_hold_us = 0;   // Time other tasks held the lock.
+    uint32_t touch_us = 0;       // Time spent inside the touch read_cb.
+    uint16_t dirty_areas = 0;    // Invalidations since the previous frame.
+    uint16_t flushes = 0;        // flush_cb invocations in this frame.
+    uint32_t dirty_px = 0;       // Invalidated pixels (overlaps counted).
+    uint32_t flushed_px = 0;     // Pixels handed to the panel.
+    uint16_t active_anims = 0;   // lv_anim_count_running() at REFR_READY.
+    uint32_t free_internal = 0;  // Free internal heap at REFR_READY.
+    uint32_t free_psram = 0;     // Free PSRAM heap at REFR_READY.
+  };
+
+  /**
+   * @param depth Number of frames kept in the ring.
+   * @param budget_ms Frames slower than this freeze a snapshot.
+   */
+  FrameRecorder(size_t depth, uint32_t budget_ms);
+  ~FrameRecorder();
+
+  FrameRecorder(const FrameRecorder&) = delete;
+  FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+  /**
+   * Allocate the ring and the snapshot buffer (PSRAM preferred).
+   * @return True if the recorder is ready to use.
+   */
+  bool init();
+
+  /**
+   * Subscribe to the refresh events of a display. Call with the LVGL lock
+   * held.
+   */
+  void attach(lv_display_t* disp);
+
+  /** Account time another task waited for / held the LVGL lock. */
+  void add_lock_wait(uint32_t us) { lock_wait_us_ += us; }
+  void add_lock_hold(uint32_t us) { lock_hold_us_ += us; }
+
+  /** Account time spent reading the touch controller. */
+  void add_touch_read(uint32_t us) { touch_us_ += us; }
+
+  /**
+   * Dump a frozen snapshot, if one is pending, and re-arm the trigger.
+   * Call from a low-priority task: printing is slow.
+   * @return True if a snapshot was dumped.
+   */
+  bool dump_pending();
+
+  /**
+   * Copy the frames after `since_seq` that are still in the ring, oldest
+   * first, into `out`. Call with the LVGL lock held.
+   * @return Number of frames copied (at most `max`).
+   */
+  size_t copy_since(uint32_t since_seq, Frame* out, size_t max) const;
+
+  /** The most recently completed frame. */
+  const Frame& last_frame() const { return last_; }
+
+  uint32_t frame_count() const { return seq_; }
+  size_t depth() const { return depth_; }
+  uint32_t jank_count() const { return jank_count_.load(); }
+  uint32_t budget_ms() const { return budget_us_ / 1000; }
+
+ private:
+  static void event_cb(lv_event_t* e);
+  void on_event(lv_event_code_t code, lv_event_t* e);
+  void commit_frame();
+  void freeze(const Frame& trigger);
+
+  size_t depth_;
+  uint32_t budget_us_;
+
+  Frame* ring_ = nullptr;
+  Frame* snapshot_ = nullptr;
+  size_t head_ = 0;
+  size_t count_ = 0;
+
+  // Frame under construction (only touched from the LVGL task).
+  Frame current_;
+  Frame last_;
+  bool in_frame_ = false;
+  int64_t stage_start_us_ = 0;
+  int64_t flush_start_us_ = 0;
+  int64_t flush_wait_start_us_ = 0;
+  int64_t prev_start_us_ = 0;
+  bool prev_animating_ = false;
+  uint32_t seq_ = 0;
+
+  // Fed from other tasks.
+  std::atomic<uint32_t> lock_wait_us_{0};
+  std::atomic<uint32_t> lock_hold_us_{0};
+  std::atomic<uint32_t> touch_us_{0};
+  uint16_t pending_areas_ = 0;
+  uint32_t pending_dirty_px_ = 0;
+
+  // Snapshot hand-off to the maintenance task.
+  std::atomic<bool> snapshot_pending_{false};
+  Frame snapshot_trigger_;
+  size_t snapshot_count_ = 0;
+  // Counted by the LVGL task, read (and suppressed_ cleared) by others.
+  std::atomic<uint32_t> jank_count_{0};
+  std::atomic<uint32_t> suppressed_{0};
+};
@@ -0,0 +1,144 @@
+#include "sys/hot_path_profiler.h"
+
+#include "esp_log.h"
+#include "esp_memory_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "lv_draw_sw_asm_custom.h"
+#include "lvgl_private.h"  // lv_draw_sw_blend(), lv_draw_sw_mask_apply()
+#include "sys/lvgl_port.h"
+#include "sys/telemetry.h"
+
+static const char* TAG = "HotPath";
+
+/**
+ * HOT PATH PROFILER: Implementation
+ * ---------------------------------
+ * The flush-ready probe runs in the SPI ISR on one core while flush_cb runs
+ * on the other, so updates go through a spinlock. Placement is read back
+ * from the function addresses rather than from Kconfig, so the report tells
+ * the truth even if a linker fragment did not match.
+ *
+ * The wrappers only exist in profiling builds, which link with
+ * --wrap=lv_draw_sw_blend,--wrap=lv_draw_sw_mask_apply,--wrap=tvg_canvas_draw
+ * (main/CMakeLists.txt) and build LVGL without LTO, so that the calls
+ * between its objects stay real calls the linker can redirect.
+ */
+
+HotPathProfiler::Counter HotPathProfiler::counters_[kProbeCount] = {};
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void IRAM_ATTR HotPathProfiler::record(Probe probe, uint32_t cycles) {
+  portENTER_CRITICAL_SAFE(&s_lock);
+  counters_[probe].calls++;
+  counters_[probe].cycles += cycles;
+  portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+void HotPathProfiler::reset() {
+  portENTER_CRITICAL(&s_lock);
+  for (auto& c : counters_) {
+    c = Counter{};
+  }
+  portEXIT_CRITICAL(&s_lock);
+  lv_draw_sw_asm_reset_shim_stats();
+}
+
+#if CONFIG_WORKSHOP_HOT_PATH_PROFILING
+extern "C" {
+void __real_lv_draw_sw_blend(lv_draw_task_t* t,
+                             const lv_draw_sw_blend_dsc_t* dsc);
+#if LV_DRAW_SW_COMPLEX
+lv_draw_sw_mask_res_t __real_lv_draw_sw_mask_apply(void* masks[],
+                                                   lv_opa_t* mask_buf,
+                                                   int32_t abs_x,
+                                                   int32_t abs_y,
+                                                   int32_t len);
+#endif
+#if LV_USE_VECTOR_GRAPHIC
+// Tvg_Result tvg_canvas_draw(Tvg_Canvas*); ThorVG's C API is not on our
+// include path, and both types are opaque here.
+int __real_tvg_canvas_draw(void* canvas);
+#endif
+
+void IRAM_ATTR __wrap_lv_draw_sw_blend(lv_draw_task_t* t,
+                                       const lv_draw_sw_blend_dsc_t* dsc) {
+  HotPathProfiler::Scope probe(HotPathProfiler::kSwBlend);
+  __real_lv_draw_sw_blend(t, dsc);
+}
+
+#if LV_DRAW_SW_COMPLEX
+lv_draw_sw_mask_res_t IRAM_ATTR __wrap_lv_draw_sw_mask_apply(
+    void* masks[], lv_opa_t* mask_buf, int32_t abs_x, int32_t abs_y,
+    int32_t len) {
+  HotPathProfiler::Scope probe(HotPathProfiler::kSwMask);
+  return __real_lv_draw_sw_mask_apply(masks, mask_buf, abs_x, abs_y, len);
+}
+#endif
+
+#if LV_USE_VECTOR_GRAPHIC
+int __wrap_tvg_canvas_draw(void* canvas) {
+  HotPathProfiler::Scope probe(HotPathProfiler::kTvgDraw);
+  return __real_tvg_canvas_draw(canvas);
+}
+#endif
+}
+#endif
+
+static void report_one(const char* label, const char* name, const void* fn,
+                       uint32_t calls, uint64_t cycles) {
+  const char* where = esp_ptr_in_iram(fn) ? "iram" : "flash";
+  const uint32_t per_call = calls ? (uint32_t)(cycles / calls) : 0;
+  ESP_LOGI(TAG, "  %-18s %-5s %8u calls %8u cycles/call", name, where,
+           (unsigned)calls, (unsigned)per_call);
+  Telemetry::emit("hotpath",
+                  "label=%s fn=%s placement=%s calls=%u cycles_per_call=%u",
+                  label, name, where, (unsigned)calls, (unsigned)per_call);
+}
+
+void HotPathProfiler::report(const char* label) {
+  Counter snapshot[kProbeCount];
+  portENTER_CRITICAL(&s_lock);
+  for (int i = 0; i < kProbeCount; i++) {
+    snapshot[i] = counters_[i];
+  }
+  portEXIT_CRITICAL(&s_lock);
+
+  ESP_LOGI(TAG, "Hot path cycles (%s):", label);
+  report_one(label, "flush_cb", (const void*)&LvglPort::flush_cb_trampoline,
+             snapshot[kFlushCb].calls, snapshot[kFlushCb].cycles);
+  report_one(label, "flush_ready_isr",
+             (const void*)&LvglPort::notify_flush_ready_trampoline,
+             snapshot[kFlushReadyIsr].calls, snapshot[kFlushReadyIsr].cycles);
+#if CONFIG_WORKSHOP_HOT_PATH_PROFILING
+  report_one(label, "sw_blend", (const void*)&__real_lv_draw_sw_blend,
+             snapshot[kSwBlend].calls, snapshot[kSwBlend].cycles);
+#if LV_DRAW_SW_COMPLEX
+  report_one(label, "sw_mask", (const void*)&__real_lv_draw_sw_mask_apply,
+             snapshot[kSwMask].calls, snapshot[kSwMask].cycles);
+#endif
+#if LV_USE_VECTOR_GRAPHIC
+  report_one(label, "tvg_draw", (const void*)&__real_tvg_canvas_draw,
+             snapshot[kTvgDraw].calls, snapshot[kTvgDraw].cycles);
+#endif
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32S3
+  // Only the S3 links the assembly routines behind the shims.
+  static const struct {
+    const char* name;
+    const void* fn;
+  } kShims[LV_DRAW_SW_ASM_SHIM_COUNT] = {
+      {"fill_rgb565", (const void*)lv_color_blend_to_rgb565_shim},
+      {"fill_rgb888", (const void*)lv_color_blend_to_rgb888_shim},
+      {"image_rgb565", (const void*)lv_rgb565_blend_normal_to_rgb565_shim},
+      {"image_rgb888", (const void*)lv_rgb888_blend_normal_to_rgb888_shim},
+  };
+  for (int i = 0; i < LV_DRAW_SW_ASM_SHIM_COUNT; i++) {
+    const auto& stat = lv_draw_sw_asm_shim_stats[i];
+    if (stat.calls) {
+      report_one(label, kShims[i].name, kShims[i].fn, stat.calls,
+                 stat.cycles);
+    }
+  }
+#endif
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+#include "esp_attr.h"
+#include "esp_cpu.h"
+
+/**
+ * HOT PATH PROFILER
+ * -----------------
+ * Counts calls and CPU cycles for the functions that are candidates for IRAM
+ * placement. Build once with a placement group enabled and once without,
+ * run the boot benchmark, and compare cycles per call in the "TLM hotpath"
+ * records: IRAM only pays off where the difference is real.
+ *
+ * LVGL's blend dispatch (lv_draw_sw_blend), its mask code
+ * (lv_draw_sw_mask_apply) and ThorVG's raster entry (tvg_canvas_draw, which
+ * generates the RLE spans and rasterizes them) are measured by linker
+ * wrappers, so the IRAM groups of main/linker.lf get a number too. The
+ * blend shims keep their own counters (lv_draw_sw_asm_shim_stats); the
+ * report merges both. Cycle counters are per core, so a task that migrates
+ * inside a probe yields a garbage sample; probes are short enough that this
+ * is rare.
+ */
+class HotPathProfiler {
+ public:
+  enum Probe : uint8_t {
+    kFlushCb = 0,
+    kFlushReadyIsr,
+    kSwBlend,  // WORKSHOP_IRAM_LVGL_BLEND
+    kSwMask,
+    kTvgDraw,  // WORKSHOP_IRAM_THORVG_RASTER
+    kProbeCount
+  };
+
+  /** Account one call. Safe from ISRs and from both cores. */
+  static void IRAM_ATTR record(Probe probe, uint32_t cycles);
+
+  /** Clear all counters, including the shim counters. */
+  static void reset();
+
+  /**
+   * Print cycles per call and where each function actually lives
+   * (IRAM/flash) as logs and TLM records.
+   * @param label Free-form tag for the records (e.g. the animal name).
+   */
+  static void report(const char* label);
+
+  /**
+   * RAII probe: measures the enclosing scope.
+   */
+  class Scope {
+   public:
+    explicit Scope(Probe probe)
+        : probe_(probe), start_(esp_cpu_get_cycle_count()) {}
+    ~Scope() { record(probe_, esp_cpu_get_cycle_count() - start_); }
+
+   private:
+    Probe probe_;
+    uint32_t start_;
+  };
+
+ private:
+  struct Counter {
+    uint32_t calls;
+    uint64_t cycles;
+  };
+  static Counter counters_[kProbeCount];
+};
@@ -0,0 +1,344 @@
+#include "sys/image_cache_monitor.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lvgl_private.h"  // lv_cache_t, lv_cache_class_t, image cache data
+#include "sys/telemetry.h"
+
+static const char* TAG = "ImageCacheMonitor";
+
+/**
+ * IMAGE CACHE MONITOR: Implementation
+ * -----------------------------------
+ * LVGL dispatches every cache operation through the instance's class
+ * (cache->clz). attach() copies the image cache's class, points the hooks
+ * below at our own functions and swaps the copy in; each hook calls the
+ * original, so storage (the red-black tree and size accounting of
+ * lv_cache_class_lru_rb_size) stays LVGL's. All hooks run under the
+ * cache's mutex, which report() and reset() take as well.
+ *
+ * Eviction goes get_victim_cb -> remove_cb, so a removal of the victim we
+ * just chose counts as an eviction. lv_cache_drop() goes through drop_cb
+ * and never reaches remove_cb.
+ *
+ * The cost of a miss is the time until the decoder adds the image for the
+ * same source: for an SVG, the ThorVG rasterization.
+ */
+
+ImageCacheMonitor* ImageCacheMonitor::active_ = nullptr;
+
+namespace {
+
+struct SourceName {
+  const void* data;
+  const char* name;
+};
+
+constexpr size_t kMaxNames = 8;
+SourceName source_names[kMaxNames];
+size_t source_name_count = 0;
+
+// The image cache's class with our hooks; only one monitor is attached.
+lv_cache_class_t hooked_class;
+
+const lv_image_cache_data_t* image_key(const void* key) {
+  return static_cast<const lv_image_cache_data_t*>(key);
+}
+
+// Re-render cost per KB of cache: what evicting the entry costs per byte
+// it frees.
+uint32_t cost_per_kb(const ImageCacheMonitor::EntryInfo& entry) {
+  return entry.cost_us / std::max<size_t>(1, entry.bytes / 1024);
+}
+
+}  // namespace
+
+uint64_t ImageCacheMonitor::CostPolicy::touch(const EntryInfo& entry) {
+  return floor_ + cost_per_kb(entry);
+}
+
+ImageCacheMonitor::ImageCacheMonitor(std::unique_ptr<Policy> policy)
+    : policy_(std::move(policy)) {
+  sources_.reserve(kMaxSources);
+  source_keys_.reserve(kMaxSources);
+}
+
+ImageCacheMonitor::~ImageCacheMonitor() {
+  if (active_ == this && cache_) {
+    lv_mutex_lock(&cache_->lock);
+    cache_->clz = base_class_;
+    lv_mutex_unlock(&cache_->lock);
+    active_ = nullptr;
+  }
+}
+
+bool ImageCacheMonitor::attach() {
+  lv_cache_t* cache = LV_GLOBAL_DEFAULT()->img_cache;
+  if (!cache || !lv_image_cache_is_enabled() || active_) {
+    ESP_LOGW(TAG, "Image cache not available");
+    return false;
+  }
+
+  lv_mutex_lock(&cache->lock);
+  cache_ = cache;
+  base_class_ = cache->clz;
+  hooked_class = *cache->clz;
+  hooked_class.get_cb = get_cb;
+  hooked_class.add_cb = add_cb;
+  hooked_class.remove_cb = remove_cb;
+  hooked_class.drop_cb = drop_cb;
+  hooked_class.drop_all_cb = drop_all_cb;
+  hooked_class.get_victim_cb = get_victim_cb;
+  active_ = this;
+  cache->clz = &hooked_class;
+  lv_mutex_unlock(&cache->lock);
+
+  ESP_LOGI(TAG, "Watching the %u KB image cache, %s eviction",
+           (unsigned)(cache->max_size / 1024), policy_->name());
+  return true;
+}
+
+void ImageCacheMonitor::name_source(const void* data, const char* name) {
+  for (size_t i = 0; i < source_name_count; i++) {
+    if (source_names[i].data == data) {
+      source_names[i].name = name;
+      return;
+    }
+  }
+  if (data && source_name_count < kMaxNames) {
+    source_names[source_name_count++] = {data, name};
+  }
+}
+
+ImageCacheMonitor::Report ImageCacheMonitor::report() const {
+  Report report;
+  report.policy = policy_->name();
+  if (!cache_) {
+    return report;
+  }
+  lv_mutex_lock(&cache_->lock);
+  report.max_bytes = cache_->max_size;
+  report.used_bytes = cache_->size;
+  report.choices = choices_;
+  report.cheapest = cheapest_;
+  report.sources = sources_;
+  lv_mutex_unlock(&cache_->lock);
+  return report;
+}
+
+void ImageCacheMonitor::reset() {
+  if (!cache_) {
+    return;
+  }
+  lv_mutex_lock(&cache_->lock);
+  for (SourceStats& s : sources_) {
+    s.hits = s.misses = s.evictions = s.drops = 0;
+  }
+  choices_ = cheapest_ = 0;
+  lv_mutex_unlock(&cache_->lock);
+}
+
+void ImageCacheMonitor::Report::emit() const {
+  SourceStats total;
+  for (const SourceStats& s : sources) {
+    total.hits += s.hits;
+    total.misses += s.misses;
+    total.evictions += s.evictions;
+    total.drops += s.drops;
+    total.entries += s.entries;
+  }
+  const uint32_t lookups = total.hits + total.misses;
+  Telemetry::emit(
+      "imgcache",
+      "policy=%s hits=%u misses=%u hit_pct=%.1f evictions=%u drops=%u "
+      "entries=%u bytes=%u max_bytes=%u choices=%u cheapest=%u",
+      policy, (unsigned)total.hits, (unsigned)total.misses,
+      lookups ? 100.0f * total.hits / lookups : 0.0f,
+      (unsigned)total.evictions, (unsigned)total.drops,
+      (unsigned)total.entries, (unsigned)used_bytes, (unsigned)max_bytes,
+      (unsigned)choices, (unsigned)cheapest);
+  for (const SourceStats& s : sources) {
+    Telemetry::emit("imgcache_src",
+                    "name=%s hits=%u misses=%u evictions=%u drops=%u "
+                    "entries=%u bytes=%u cost_us=%u cost_max_us=%u",
+                    s.name, (unsigned)s.hits, (unsigned)s.misses,
+                    (unsigned)s.evictions, (unsigned)s.drops,
+                    (unsigned)s.entries, (unsigned)s.bytes,
+                    (unsigned)s.cost_us, (unsigned)s.cost_max_us);
+  }
+}
+
+size_t ImageCacheMonitor::source_for(const void* key) {
+  const lv_image_cache_data_t* data = image_key(key);
+  for (size_t i = 0; i < source_keys_.size(); i++) {
+    if (source_keys_[i] == data->src) {
+      return i;
+    }
+  }
+  if (sources_.size() == kMaxSources) {
+    return kMaxSources - 1;  // The catch-all below.
+  }
+
+  SourceStats s;
+  if (sources_.size() == kMaxSources - 1) {
+    snprintf(s.name, sizeof(s.name), "other");
+  } else if (data->src_type == LV_IMAGE_SRC_VARIABLE) {
+    const void* bytes = static_cast<const lv_image_dsc_t*>(data->src)->data;
+    snprintf(s.name, sizeof(s.name), "dsc_%08x", (unsigned)(uintptr_t)bytes);
+    for (size_t i = 0; i < source_name_count; i++) {
+      if (source_names[i].data == bytes) {
+        snprintf(s.name, sizeof(s.name), "%s", source_names[i].name);
+      }
+    }
+  } else if (data->src_type == LV_IMAGE_SRC_FILE) {
+    const char* path = static_cast<const char*>(data->src);
+    const char* base = strrchr(path, '/');
+    snprintf(s.name, sizeof(s.name), "%s", base ? base + 1 : path);
+  } else {
+    snprintf(s.name, sizeof(s.name), "symbol");
+  }
+  sources_.push_back(s);
+  source_keys_.push_back(data->src);
+  return sources_.size() - 1;
+}
+
+ImageCacheMonitor::Entry* ImageCacheMonitor::find(
+    const lv_cache_entry_t* entry) {
+  for (Entry& e : entries_) {
+    if (e.entry == entry) {
+      return &e;
+    }
+  }
+  return nullptr;
+}
+
+void ImageCacheMonitor::forget(Entry& e) {
+  SourceStats& s = sources_[e.source];
+  s.entries--;
+  s.bytes -= std::min(s.bytes, e.info.bytes);
+  e = Entry{};
+}
+
+lv_cache_entry_t* ImageCacheMonitor::get_cb(lv_cache_t* cache,
+                                            const void* key,
+                                            void* user_data) {
+  ImageCacheMonitor& self = *active_;
+  lv_cache_entry_t* entry = self.base_class_->get_cb(cache, key, user_data);
+  SourceStats& s = self.sources_[self.source_for(key)];
+  if (entry) {
+    s.hits++;
+    if (Entry* e = self.find(entry)) {
+      e->priority = self.policy_->touch(e->info);
+    }
+  } else {
+    s.misses++;
+    self.miss_src_ = image_key(key)->src;
+    self.miss_us_ = esp_timer_get_time();
+  }
+  return entry;
+}
+
+lv_cache_entry_t* ImageCacheMonitor::add_cb(lv_cache_t* cache,
+                                            const void* key,
+                                            void* user_data) {
+  ImageCacheMonitor& self = *active_;
+  lv_cache_entry_t* entry = self.base_class_->add_cb(cache, key, user_data);
+  if (!entry) {
+    return entry;
+  }
+
+  const lv_image_cache_data_t* data = image_key(key);
+  const size_t source = self.source_for(key);
+  EntryInfo info = {data->slot.size, 0};
+  if (self.miss_src_ == data->src) {
+    info.cost_us = (uint32_t)(esp_timer_get_time() - self.miss_us_);
+    self.miss_src_ = nullptr;
+  }
+
+  SourceStats& s = self.sources_[source];
+  if (info.cost_us) {
+    s.cost_us = info.cost_us;
+    s.cost_max_us = std::max(s.cost_max_us, info.cost_us);
+  }
+
+  // Untracked entries (table full) are left to LVGL's own victim order.
+  if (Entry* e = self.find(nullptr)) {
+    *e = {entry, data->src, source, info, self.policy_->touch(info)};
+    s.entries++;
+    s.bytes += info.bytes;
+  }
+  return entry;
+}
+
+void ImageCacheMonitor::remove_cb(lv_cache_t* cache, lv_cache_entry_t* entry,
+                                  void* user_data) {
+  ImageCacheMonitor& self = *active_;
+  if (Entry* e = self.find(entry)) {
+    SourceStats& s = self.sources_[e->source];
+    if (entry == self.victim_) {
+      s.evictions++;
+    } else {
+      s.drops++;
+    }
+    self.forget(*e);
+  }
+  self.victim_ = nullptr;
+  self.base_class_->remove_cb(cache, entry, user_data);
+}
+
+void ImageCacheMonitor::drop_cb(lv_cache_t* cache, const void* key,
+                                void* user_data) {
+  ImageCacheMonitor& self = *active_;
+  for (Entry& e : self.entries_) {
+    if (e.entry && e.src == image_key(key)->src) {
+      self.sources_[e.source].drops++;
+      self.forget(e);
+    }
+  }
+  self.base_class_->drop_cb(cache, key, user_data);
+}
+
+void ImageCacheMonitor::drop_all_cb(lv_cache_t* cache, void* user_data) {
+  ImageCacheMonitor& self = *active_;
+  for (Entry& e : self.entries_) {
+    if (e.entry) {
+      self.sources_[e.source].drops++;
+      self.forget(e);
+    }
+  }
+  self.base_class_->drop_all_cb(cache, user_data);
+}
+
+lv_cache_entry_t* ImageCacheMonitor::get_victim_cb(lv_cache_t* cache,
+                                                   void* user_data) {
+  ImageCacheMonitor& self = *active_;
+  // Entries still referenced by a draw task cannot go.
+  Entry* best = nullptr;
+  size_t candidates = 0;
+  uint32_t min_cost = UINT32_MAX;
+  for (Entry& e : self.entries_) {
+    if (!e.entry || lv_cache_entry_get_ref(e.entry) != 0) {
+      continue;
+    }
+    candidates++;
+    min_cost = std::min(min_cost, cost_per_kb(e.info));
+    if (!best || e.priority < best->priority) {
+      best = &e;
+    }
+  }
+  if (best) {
+    if (candidates > 1) {
+      self.choices_++;
+      self.cheapest_ += cost_per_kb(best->info) == min_cost;
+    }
+    self.policy_->evicted(best->priority);
+    self.victim_ = best->entry;
+  } else {
+    self.victim_ = self.base_class_->get_victim_cb(cache, user_data);
+  }
+  return self.victim_;
+}
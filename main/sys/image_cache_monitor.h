@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "lvgl.h"
+
+/**
+ * IMAGE CACHE MONITOR
+ * -------------------
+ * LVGL keeps decoded images in a 2 MB cache (CONFIG_LV_CACHE_DEF_SIZE), and
+ * for an SVG the "decode" is a full ThorVG rasterization. Whether the three
+ * scene images ever hit it, and what rotation and scale variants do to it,
+ * was invisible. The monitor wraps the cache's class (LVGL's extension
+ * point for cache implementations) and counts, per image source:
+ *
+ *   hits, misses:  lookups by the image decoder.
+ *   evictions:     entries pushed out to make room.
+ *   drops:         entries removed on request (lv_image_cache_drop()).
+ *   bytes:         decoded bytes currently held.
+ *   cost_us:       re-render cost, measured from a miss to the decoded
+ *                  image being added.
+ *
+ * and over all sources, for evictions that had more than one entry to
+ * choose from (choices), how often the victim was the cheapest to re-render
+ * per KB (cheapest).
+ *
+ * It also decides which entry to evict. The Policy is pluggable; the
+ * default LruPolicy reproduces LVGL's own order, CostPolicy keeps expensive
+ * vector rasters ahead of cheap bitmaps (see its comment).
+ */
+class ImageCacheMonitor {
+ public:
+  /** What a policy knows about an entry. */
+  struct EntryInfo {
+    size_t bytes;
+    uint32_t cost_us;  // 0 if the entry was added without a measured miss.
+  };
+
+  /**
+   * Ranks cached entries: the unreferenced entry with the lowest priority
+   * is evicted first.
+   */
+  class Policy {
+   public:
+    virtual ~Policy() = default;
+    virtual const char* name() const = 0;
+    /** Priority of an entry that was just added or hit. */
+    virtual uint64_t touch(const EntryInfo& entry) = 0;
+    /** The entry with `priority` is being evicted. */
+    virtual void evicted(uint64_t priority) {}
+  };
+
+  /** Least recently used first, as LVGL's default cache class. */
+  class LruPolicy : public Policy {
+   public:
+    const char* name() const override { return "lru"; }
+    uint64_t touch(const EntryInfo&) override { return ++clock_; }
+
+   private:
+    uint64_t clock_ = 0;
+  };
+
+  /**
+   * GreedyDual-Size: priority = floor + cost per KB, and every eviction
+   * raises the floor to the victim's priority. An entry that is expensive
+   * to re-render for its size survives several cheap ones, but without
+   * hits it still ages out as the floor rises past it.
+   */
+  class CostPolicy : public Policy {
+   public:
+    const char* name() const override { return "cost"; }
+    uint64_t touch(const EntryInfo& entry) override;
+    void evicted(uint64_t priority) override { floor_ = priority; }
+
+   private:
+    uint64_t floor_ = 0;
+  };
+
+  struct SourceStats {
+    char name[24] = {};
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t evictions = 0;
+    uint32_t drops = 0;
+    uint32_t entries = 0;  // Currently cached.
+    size_t bytes = 0;      // Currently cached.
+    uint32_t cost_us = 0;  // Last measured re-render cost.
+    uint32_t cost_max_us = 0;
+  };
+
+  /** A copy of the counters that can be printed without any lock. */
+  struct Report {
+    const char* policy = "";
+    size_t max_bytes = 0;
+    size_t used_bytes = 0;
+    uint32_t choices = 0;
+    uint32_t cheapest = 0;
+    std::vector<SourceStats> sources;
+
+    /** One "TLM imgcache" total and one "TLM imgcache_src" per source. */
+    void emit() const;
+  };
+
+  explicit ImageCacheMonitor(std::unique_ptr<Policy> policy);
+  ~ImageCacheMonitor();
+
+  ImageCacheMonitor(const ImageCacheMonitor&) = delete;
+  ImageCacheMonitor& operator=(const ImageCacheMonitor&) = delete;
+
+  /**
+   * Wrap LVGL's image cache. Call after lv_init() with the LVGL lock held,
+   * before images are drawn. Only one monitor can be attached.
+   * @return False if the image cache is disabled.
+   */
+  bool attach();
+
+  /**
+   * Give the source whose lv_image_dsc_t points at `data` a readable name
+   * in the report (e.g. an SVG document and "whale").
+   */
+  static void name_source(const void* data, const char* name);
+
+  /** Copy the counters (taking the cache's own mutex). */
+  Report report() const;
+
+  /** Clear the counts, eviction choices included; cached bytes remain. */
+  void reset();
+
+ private:
+  struct Entry {
+    lv_cache_entry_t* entry = nullptr;  // nullptr: free slot.
+    const void* src = nullptr;
+    size_t source = 0;
+    EntryInfo info = {};
+    uint64_t priority = 0;
+  };
+
+  // The cache class hooks: forward to LVGL's class, then account.
+  static lv_cache_entry_t* get_cb(lv_cache_t* cache, const void* key,
+                                  void* user_data);
+  static lv_cache_entry_t* add_cb(lv_cache_t* cache, const void* key,
+                                  void* user_data);
+  static void remove_cb(lv_cache_t* cache, lv_cache_entry_t* entry,
+                        void* user_data);
+  static void drop_cb(lv_cache_t* cache, const void* key, void* user_data);
+  static void drop_all_cb(lv_cache_t* cache, void* user_data);
+  static lv_cache_entry_t* get_victim_cb(lv_cache_t* cache, void* user_data);
+
+  size_t source_for(const void* key);
+  Entry* find(const lv_cache_entry_t* entry);
+  void forget(Entry& e);
+
+  static ImageCacheMonitor* active_;
+
+  std::unique_ptr<Policy> policy_;
+  lv_cache_t* cache_ = nullptr;
+  const lv_cache_class_t* base_class_ = nullptr;
+
+  static constexpr size_t kMaxEntries = 32;
+  static constexpr size_t kMaxSources = 16;
+  Entry entries_[kMaxEntries];
+  std::vector<SourceStats> sources_;
+  std::vector<const void*> source_keys_;
+
+  // The miss that the next add of the same source completes.
+  const void* miss_src_ = nullptr;
+  int64_t miss_us_ = 0;
+  lv_cache_entry_t* victim_ = nullptr;
+  uint32_t choices_ = 0;
+  uint32_t cheapest_ = 0;
+};
@@ -1,15 +1,19 @@
 #include "sys/lvgl_port.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 
 #include "display/drivers/esp32_spi.h"
 #include "esp_heap_caps.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_log.h"
+#include "freertos/timers.h"
+#include "sys/hot_path_profiler.h"
+#include "sys/telemetry.h"
 #include "workshop_config.h"
 
-LvglPort::LvglPort(const Config& config)
-    : config_(config), draw_buf_(nullptr), draw_buf2_(nullptr) {}
+LvglPort::LvglPort(const Config& config) : config_(config) {}
 
 LvglPort::~LvglPort() {
   // Unique pointers and objects will clean themselves up
@@ -17,8 +21,6 @@ LvglPort::~LvglPort() {
 
 void LvglPort::init(esp_lcd_panel_handle_t panel_handle,
                     esp_lcd_panel_io_handle_t io_handle) {
-  panel_handle_ = panel_handle;
-
   // 1. Initialize Port Service (Task & Timer)
   port_service_ = std::make_unique<lvgl::utility::Esp32Port>();
   lvgl::utility::Esp32PortConfig port_cfg;
@@ -50,133 +52,924 @@ void LvglPort::init(esp_lcd_panel_handle_t panel_handle,
     display_cfg.render_mode = Workshop::LVGL_RENDER_MODE;
 
     display_driver_ = std::make_unique<lvgl::Esp32Spi>(display_cfg);
-  } else {
-    // Calculate buffer size based on Workshop mode
-    size_t buffer_lines =
-        (Workshop::BUFFER_MODE == Workshop::BufferMode::FullFrame)
-            ? config_.v_res
-            : 20;
 
-    // Allocate Buffers via Library Helper
-    draw_buf_ = lvgl::draw::DrawBuf::allocate_dma(config_.h_res, buffer_lines,
-                                                  lvgl::ColorFormat::RGB565,
-                                                  Workshop::ALLOC_CAPS);
+    auto out = std::make_unique<Output>();
+    out->port = this;
+    out->panel = panel_handle;
+    out->io = io_handle;
+    out->display = display_driver_->display();
+    outputs_.push_back(std::move(out));
+  } else if (!create_output(panel_handle, io_handle)) {
+    return;
+  }
+
+  // 3. CPU Monitor
+  // --------------
+  // Running before the display events below, so that the first refresh
+  // can hand it the port task (see display_event_cb).
+  if (config_.cpu_monitor_ms > 0) {
+    CpuMonitor::start(config_.cpu_monitor_ms);
+  }
 
-    if (Workshop::USE_DOUBLE_BUFFERING) {
-      draw_buf2_ = lvgl::draw::DrawBuf::allocate_dma(
-          config_.h_res, buffer_lines, lvgl::ColorFormat::RGB565,
-          Workshop::ALLOC_CAPS);
+  // 4. Initialize Input Device
+  auto ptr_input = lvgl::PointerInput::create();
+  lvgl::Display* target_disp = get_display();
+  if (target_disp) {
+    lv_indev_set_disp(ptr_input.raw(), target_disp->raw());
+  }
+  indev_ = std::make_unique<lvgl::PointerInput>(std::move(ptr_input));
+
+  // 5. Port-level display events
+  if (target_disp) {
+    Lock guard(*this);
+    lv_display_add_event_cb(target_disp->raw(), display_event_cb,
+                            LV_EVENT_REFR_START, this);
+    lv_display_add_event_cb(target_disp->raw(), display_event_cb,
+                            LV_EVENT_FLUSH_FINISH, this);
+    attach_output_events(*outputs_[0]);
+  }
+
+  // 6. Flight Recorder
+  // ------------------
+  // Subscribes to the display's refresh events, so it works the same for the
+  // legacy flush path and the native driver.
+  if (config_.recorder_depth > 0 && target_disp) {
+    auto recorder = std::make_unique<FrameRecorder>(config_.recorder_depth,
+                                                    config_.jank_budget_ms);
+    if (recorder->init()) {
+      Lock guard(*this);
+      recorder->attach(target_disp->raw());
+      recorder_ = std::move(recorder);
     }
+  }
 
-    if (!draw_buf_.raw() ||
-        (Workshop::USE_DOUBLE_BUFFERING && !draw_buf2_.raw())) {
-      ESP_LOGE("LvglPort", "Failed to allocate display buffer(s)!");
-      return;
+  // 7. Redraw Heatmap (instrumentation mode)
+  if (config_.heatmap_tile_size > 0 && target_disp) {
+    heatmap_ = std::make_unique<RedrawHeatmap>(
+        config_.h_res, config_.v_res, config_.heatmap_tile_size);
+    Lock guard(*this);
+    heatmap_->attach(target_disp->raw());
+  }
+
+  // 8. Image Cache Monitor
+  // ---------------------
+  // Wraps the cache LVGL created in lv_init(), before the first image is
+  // decoded into it.
+  if (config_.image_cache_report_ms > 0) {
+    std::unique_ptr<ImageCacheMonitor::Policy> policy;
+    if (config_.image_cache_cost_eviction) {
+      policy = std::make_unique<ImageCacheMonitor::CostPolicy>();
+    } else {
+      policy = std::make_unique<ImageCacheMonitor::LruPolicy>();
+    }
+    auto monitor = std::make_unique<ImageCacheMonitor>(std::move(policy));
+    Lock guard(*this);
+    if (monitor->attach()) {
+      image_cache_ = std::move(monitor);
+      image_cache_reported_us_ = esp_timer_get_time();
+    }
+  }
+
+  // 9. Frame Governor
+  // -----------------
+  // esp_pm is already configured (see app_main); the governor only decides
+  // when the max-frequency lock is held.
+  if (config_.governor_min_mhz > 0 && target_disp) {
+    FrameGovernor::Config gov_cfg;
+    gov_cfg.max_mhz = config_.governor_max_mhz;
+    gov_cfg.min_mhz = config_.governor_min_mhz;
+    gov_cfg.budget_ms = config_.governor_budget_ms;
+    auto governor = std::make_unique<FrameGovernor>(gov_cfg);
+    if (governor->init()) {
+      Lock guard(*this);
+      governor->attach(target_disp->raw());
+      governor_ = std::move(governor);
+      governor_reported_us_ = esp_timer_get_time();
+    }
+  }
+
+  // 10. Static Scene Detection
+  // --------------------------
+  // Suspends the refresh loop while nothing changes. Panel sleep turns the
+  // backlight off first and wakes the panel before the next flush.
+  if (config_.static_idle_frames > 0 && target_disp) {
+#if LV_USE_PERF_MONITOR
+    ESP_LOGW("LvglPort", "The performance monitor redraws its label "
+                         "periodically: static scenes will not suspend. "
+                         "Disable LV_USE_PERF_MONITOR.");
+#endif
+    StaticScene::Config scene_cfg;
+    scene_cfg.idle_frames = config_.static_idle_frames;
+    scene_cfg.refr_period_ms = LV_DEF_REFR_PERIOD;
+    scene_cfg.sleep_ms = config_.static_sleep_ms;
+    auto static_scene = std::make_unique<StaticScene>(
+        scene_cfg,
+        [this](bool asleep) {
+          if (asleep && backlight_handler_) backlight_handler_(false);
+          for (auto& out : outputs_) {
+            esp_lcd_panel_disp_sleep(out->panel, asleep);
+          }
+          if (!asleep && backlight_handler_) backlight_handler_(true);
+        },
+        [this]() { notify_event(0); },
+        [this]() {
+          // From the esp_timer task: on to the timer task, which may wait
+          // for the LVGL lock.
+          xTimerPendFunctionCall(scene_sleep_deferred, this, 0, 0);
+        });
+    if (static_scene->init()) {
+      Lock guard(*this);
+      static_scene->attach(target_disp->raw(), indev_->raw());
+      static_scene_ = std::move(static_scene);
+    }
+  }
+
+  // 11. Event Trace
+  // ---------------
+  // Task switches and the flush path log themselves; the refresh phases
+  // come from display 0's events. The native driver's flush_cb is not ours
+  // to instrument, so it is timed from the events around its call.
+  if (config_.trace_events > 0 && target_disp &&
+      TraceRecorder::init(config_.trace_events)) {
+    Lock guard(*this);
+    TraceRecorder::attach(target_disp->raw(), display_driver_ != nullptr);
+  }
+
+  // 12. Frame Pacing
+  // ----------------
+  // Refreshes move from the display's own timer to the pacer's, which runs
+  // once per slot; static scene detection then suspends the pacer, and the
+  // governor budgets frames by the pacer's slot period.
+  if (config_.pacing_max_hz > 0 && target_disp) {
+    FramePacer::Config pace_cfg;
+    pace_cfg.max_hz = config_.pacing_max_hz;
+    pace_cfg.headroom_pct = config_.pacing_headroom_pct;
+    auto pacer = std::make_unique<FramePacer>(
+        pace_cfg, [this]() { paced_refresh(); },
+        [this]() { notify_event(0); });
+    if (pacer->init()) {
+      Lock guard(*this);
+      park_refresh_timer(*outputs_[0]);
+      pacer->attach(target_disp->raw());
+      if (static_scene_) {
+        // Pausing the timer is not enough: the slots would keep waking
+        // the task.
+        FramePacer* paced = pacer.get();
+        static_scene_->set_refresh_timer(
+            pacer->timer(),
+            [paced](bool suspended) { paced->set_suspended(suspended); },
+            [paced]() { return paced->slot_us(); });
+      }
+      pacer_ = std::move(pacer);
+      pacer_reported_us_ = esp_timer_get_time();
+    }
+  }
+}
+
+LvglPort::Output* LvglPort::create_output(
+    esp_lcd_panel_handle_t panel_handle, esp_lcd_panel_io_handle_t io_handle) {
+  auto out = std::make_unique<Output>();
+  out->port = this;
+  out->index = outputs_.size();
+  out->panel = panel_handle;
+  out->io = io_handle;
+
+  // Calculate buffer size based on Workshop mode
+  size_t buffer_lines =
+      (Workshop::BUFFER_MODE == Workshop::BufferMode::FullFrame)
+          ? config_.v_res
+          : config_.strip_lines;
+
+  // Allocate Buffers via Library Helper
+  out->buf = lvgl::draw::DrawBuf::allocate_dma(config_.h_res, buffer_lines,
+                                               lvgl::ColorFormat::RGB565,
+                                               Workshop::ALLOC_CAPS);
+
+  if (Workshop::USE_DOUBLE_BUFFERING) {
+    out->buf2 = lvgl::draw::DrawBuf::allocate_dma(
+        config_.h_res, buffer_lines, lvgl::ColorFormat::RGB565,
+        Workshop::ALLOC_CAPS);
+  }
+
+  if (!out->buf.raw() || (Workshop::USE_DOUBLE_BUFFERING && !out->buf2.raw())) {
+    ESP_LOGE("LvglPort", "Failed to allocate display buffer(s)!");
+    return nullptr;
+  }
+
+  report_buffers(*out, buffer_lines);
+
+  // Create Legacy Display Wrapper
+  out->owned_display = std::make_unique<lvgl::Display>(
+      lvgl::Display::create(config_.h_res, config_.v_res));
+  out->display = out->owned_display.get();
+
+  lv_display_set_user_data(out->display->raw(), out.get());
+  lv_display_set_flush_cb(out->display->raw(), flush_cb_trampoline);
+
+  out->display->set_buffers(out->buf.data(), out->buf2.data(),
+                            out->buf.data_size(), Workshop::LVGL_RENDER_MODE);
+
+  register_io_callbacks(*out);
+
+  outputs_.push_back(std::move(out));
+  return outputs_.back().get();
+}
+
+void LvglPort::register_io_callbacks(Output& out) {
+  // Register IO Callback for flush readiness
+  esp_lcd_panel_io_callbacks_t cbs = {
+      .on_color_trans_done = notify_flush_ready_trampoline,
+  };
+  esp_lcd_panel_io_register_event_callbacks(out.io, &cbs, &out);
+}
+
+void LvglPort::report_buffers(const Output& out, size_t lines) {
+  // Memory cost of this display, for comparing resolutions.
+  const unsigned buffer_count = Workshop::USE_DOUBLE_BUFFERING ? 2 : 1;
+  const char* mode =
+      (Workshop::BUFFER_MODE == Workshop::BufferMode::FullFrame) ? "full"
+                                                                 : "strip";
+  ESP_LOGI("LvglPort", "Display %u: %dx%d, %u %s buffer(s) of %u lines",
+           (unsigned)out.index, config_.h_res, config_.v_res, buffer_count,
+           mode, (unsigned)lines);
+  Telemetry::emit("buffers",
+                  "id=%u h_res=%d v_res=%d mode=%s lines=%u count=%u "
+                  "bytes=%u",
+                  (unsigned)out.index, config_.h_res, config_.v_res, mode,
+                  (unsigned)lines, buffer_count,
+                  (unsigned)(out.buf.data_size() * buffer_count));
+}
+
+lvgl::Display* LvglPort::add_display(esp_lcd_panel_handle_t panel_handle,
+                                     esp_lcd_panel_io_handle_t io_handle) {
+  if (!port_service_ || outputs_.empty()) {
+    ESP_LOGE("LvglPort", "add_display() needs init() first");
+    return nullptr;
+  }
+
+  Lock guard(*this);
+  Output* out = create_output(panel_handle, io_handle);
+  if (!out) {
+    return nullptr;
+  }
+  attach_output_events(*out);
+  if (static_scene_) {
+    static_scene_->observe(out->display->raw());
+  }
+
+  // MULTI-DISPLAY ARBITRATION
+  // -------------------------
+  // Every display has its own refresh timer, and LVGL runs them in creation
+  // order: display 0 would always get the bus first and the last one would
+  // wait behind everybody. With more than one display, a single shared
+  // timer refreshes them instead, rotating which one goes first.
+  if (!shared_refr_timer_) {
+    shared_refr_timer_ =
+        lv_timer_create(shared_refresh_cb, LV_DEF_REFR_PERIOD, this);
+    if (pacer_) {
+      // The pacer runs the rotation once per slot (see paced_refresh()).
+      lv_timer_pause(shared_refr_timer_);
+    } else if (static_scene_) {
+      static_scene_->set_refresh_timer(shared_refr_timer_);
+    }
+  }
+  for (auto& o : outputs_) {
+    if (pacer_) {
+      park_refresh_timer(*o);
+    } else {
+      lv_timer_pause(lv_display_get_refr_timer(o->display->raw()));
+    }
+    o->stats = DisplayStats{};
+  }
+  displays_reported_us_ = esp_timer_get_time();
+
+  ESP_LOGI("LvglPort", "Display %u added", (unsigned)out->index);
+  return out->display;
+}
+
+void LvglPort::attach_output_events(Output& out) {
+  lv_display_add_event_cb(out.display->raw(), output_event_cb,
+                          LV_EVENT_FLUSH_START, &out);
+  lv_display_add_event_cb(out.display->raw(), output_event_cb,
+                          LV_EVENT_REFR_READY, &out);
+}
+
+void LvglPort::output_event_cb(lv_event_t* e) {
+  auto* out = static_cast<Output*>(lv_event_get_user_data(e));
+  switch (lv_event_get_code(e)) {
+    case LV_EVENT_FLUSH_START: {
+      auto* area = static_cast<const lv_area_t*>(lv_event_get_param(e));
+      out->flushed = true;
+      out->stats.flushes++;
+      if (area) out->stats.flushed_px += lv_area_get_size(area);
+      break;
+    }
+    case LV_EVENT_REFR_READY:
+      if (out->flushed) {
+        out->stats.frames++;
+        out->flushed = false;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void LvglPort::shared_refresh_cb(lv_timer_t* timer) {
+  auto* port = static_cast<LvglPort*>(lv_timer_get_user_data(timer));
+  const size_t n = port->outputs_.size();
+  for (size_t i = 0; i < n; i++) {
+    Output& out = *port->outputs_[(port->refresh_first_ + i) % n];
+    lv_timer_t* refr_timer = lv_display_get_refr_timer(out.display->raw());
+    // LVGL may resume a display's own timer on invalidation; keep it parked
+    // so the rotation stays the only thing that refreshes.
+    lv_timer_pause(refr_timer);
+    if (!out.clip_buffers) {
+      lv_display_refr_timer(refr_timer);
+    }
+  }
+  port->refresh_first_ = (port->refresh_first_ + 1) % n;
+}
+
+void LvglPort::paced_refresh() {
+  if (governor_ && pacer_) {
+    governor_->set_budget_us(pacer_->slot_us());
+  }
+  if (shared_refr_timer_) {
+    shared_refresh_cb(shared_refr_timer_);
+    return;
+  }
+  Output& out = *outputs_[0];
+  if (!out.clip_buffers) {
+    lv_display_refr_timer(lv_display_get_refr_timer(out.display->raw()));
+  }
+}
+
+void LvglPort::park_refresh_timer(Output& out) {
+  // LVGL resumes a display's refresh timer on every invalidation. With a
+  // period the frame clock never reaches, it still never fires.
+  static constexpr uint32_t kParkedPeriodMs = 24 * 3600 * 1000;
+  lv_timer_t* timer = lv_display_get_refr_timer(out.display->raw());
+  lv_timer_pause(timer);
+  lv_timer_set_period(timer, kParkedPeriodMs);
+}
+
+/**
+ * BOUNCE BUFFERS
+ * --------------
+ * Pixels that live in memory-mapped flash (the splash, clips) cannot be
+ * read by the SPI DMA, so they are staged through two small internal
+ * buffers: while one chunk is on the wire the CPU fills the other. A
+ * counting semaphore holds one token per idle buffer; whoever owns the
+ * panel's IO callback gives a token back per completed transfer.
+ */
+bool LvglPort::Bounce::alloc(size_t size) {
+  bytes = size;
+  next = 0;
+  for (auto*& b : buf) {
+    b = static_cast<uint8_t*>(
+        heap_caps_malloc(size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL));
+  }
+  free = xSemaphoreCreateCounting(2, 2);
+  return buf[0] && buf[1] && free;
+}
+
+void LvglPort::Bounce::wait_idle() {
+  if (!free) {
+    return;
+  }
+  // Both tokens back means nothing is in flight.
+  for (int i = 0; i < 2; i++) {
+    xSemaphoreTake(free, pdMS_TO_TICKS(100));
+  }
+  for (int i = 0; i < 2; i++) {
+    xSemaphoreGive(free);
+  }
+}
+
+void LvglPort::Bounce::release() {
+  wait_idle();
+  if (free) {
+    vSemaphoreDelete(free);
+    free = nullptr;
+  }
+  for (auto*& b : buf) {
+    heap_caps_free(b);
+    b = nullptr;
+  }
+}
+
+bool LvglPort::stream_rows(esp_lcd_panel_handle_t panel, Bounce& bounce,
+                           int x1, int y1, int x2, int y2,
+                           const PixelReader& read) {
+  const size_t row_bytes = (size_t)(x2 - x1) * sizeof(uint16_t);
+  const int chunk_lines = std::max(1, (int)(bounce.bytes / row_bytes));
+  bool ok = true;
+  for (int y = y1; ok && y < y2; y += chunk_lines) {
+    const int lines = std::min(chunk_lines, y2 - y);
+    uint8_t* buf = bounce.buf[bounce.next];
+    bounce.next ^= 1;
+    // Transfers complete in order, so a token means this buffer is idle.
+    xSemaphoreTake(bounce.free, portMAX_DELAY);
+    ok = read(buf, lines * row_bytes) &&
+         esp_lcd_panel_draw_bitmap(panel, x1, y, x2, y + lines, buf) ==
+             ESP_OK;
+    if (!ok) {
+      xSemaphoreGive(bounce.free);
     }
+  }
+  return ok;
+}
 
-    // Create Legacy Display Wrapper
-    display_ = std::make_unique<lvgl::Display>(
-        lvgl::Display::create(config_.h_res, config_.v_res));
+/**
+ * SPLASH FRAME
+ * ------------
+ * The baked frame is streamed through the bounce buffers before LVGL owns
+ * the panel. A compressed frame is decoded straight into the bounce
+ * buffers by the reader, overlapping decode with transfer.
+ */
+static constexpr int kSplashChunkLines = 10;
 
-    lv_display_set_user_data(display_->raw(), this);
-    lv_display_set_flush_cb(display_->raw(), flush_cb_trampoline);
+bool LvglPort::show_splash(esp_lcd_panel_handle_t panel_handle,
+                           esp_lcd_panel_io_handle_t io_handle,
+                           const uint8_t* frame, size_t size) {
+  if (!frame) {
+    return false;
+  }
+  return show_splash(panel_handle, io_handle, size,
+                     [frame, offset = (size_t)0](uint8_t* dst,
+                                                 size_t len) mutable {
+                       memcpy(dst, frame + offset, len);
+                       offset += len;
+                       return true;
+                     });
+}
 
-    display_->set_buffers(draw_buf_.data(), draw_buf2_.data(),
-                          draw_buf_.data_size(), Workshop::LVGL_RENDER_MODE);
+bool LvglPort::show_splash(esp_lcd_panel_handle_t panel_handle,
+                           esp_lcd_panel_io_handle_t io_handle, size_t size,
+                           const PixelReader& read) {
+  const size_t row_bytes = (size_t)config_.h_res * sizeof(uint16_t);
+  if (size != row_bytes * config_.v_res) {
+    ESP_LOGW("LvglPort", "Splash frame has %u bytes, expected %u",
+             (unsigned)size, (unsigned)(row_bytes * config_.v_res));
+    return false;
+  }
 
-    // Register IO Callback for flush readiness
+  Bounce bounce;
+  bool ok = bounce.alloc(row_bytes * kSplashChunkLines);
+  if (ok) {
     esp_lcd_panel_io_callbacks_t cbs = {
-        .on_color_trans_done = notify_flush_ready_trampoline,
+        .on_color_trans_done = splash_chunk_done,
     };
-    esp_lcd_panel_io_register_event_callbacks(io_handle, &cbs, this);
+    esp_lcd_panel_io_register_event_callbacks(io_handle, &cbs, bounce.free);
+    ok = stream_rows(panel_handle, bounce, 0, 0, config_.h_res,
+                     config_.v_res, read);
+    // Only with nothing in flight may init() take the IO callbacks over.
+    bounce.wait_idle();
+    esp_lcd_panel_io_callbacks_t none = {};
+    esp_lcd_panel_io_register_event_callbacks(io_handle, &none, nullptr);
   }
+  bounce.release();
 
-  // 3. Initialize Input Device
-  auto ptr_input = lvgl::PointerInput::create();
-  lvgl::Display* target_disp = get_display();
-  if (target_disp) {
-    lv_indev_set_disp(ptr_input.raw(), target_disp->raw());
+  if (!ok) {
+    ESP_LOGW("LvglPort", "Splash frame not shown");
   }
-  indev_ = std::make_unique<lvgl::PointerInput>(std::move(ptr_input));
+  return ok;
+}
+
+bool LvglPort::splash_chunk_done(esp_lcd_panel_io_handle_t panel_io,
+                                 esp_lcd_panel_io_event_data_t* edata,
+                                 void* user_ctx) {
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(static_cast<SemaphoreHandle_t>(user_ctx), &woken);
+  return woken == pdTRUE;
+}
+
+/**
+ * CLIP PLAYBACK
+ * -------------
+ * A timer on the LVGL task sends one frame per period: the key frame
+ * first, then the deltas in a loop. Each delta only covers the box that
+ * changed, decoded row by row into the bounce buffers. Meanwhile the
+ * display ignores invalidations, so the scene's animations keep running
+ * without waking the renderer, and anything LVGL flushes anyway is
+ * dropped: the clip owns the panel. The panel's IO callback tells the two
+ * apart by counting LVGL's transfers: completions beyond those are clip
+ * chunks (transfers complete in order).
+ */
+static constexpr int kClipChunkLines = 10;
+
+esp_err_t LvglPort::play_clip(const uint8_t* data, size_t size,
+                              size_t display) {
+  stop_clip();
+  if (display >= outputs_.size() || !outputs_[display]->owned_display) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+  Output& out = *outputs_[display];
+
+  auto playback = std::make_unique<ClipPlayback>();
+  esp_err_t err = playback->clip.open(data, size);
+  if (err != ESP_OK) {
+    return err;
+  }
+  const Clip& clip = playback->clip;
+  if (clip.width() != config_.h_res || clip.height() != config_.v_res) {
+    ESP_LOGE("LvglPort", "Clip is %ux%u, display %u is %dx%d",
+             clip.width(), clip.height(), (unsigned)display, config_.h_res,
+             config_.v_res);
+    return ESP_ERR_INVALID_SIZE;
+  }
+  if (!playback->bounce.alloc((size_t)config_.h_res * sizeof(uint16_t) *
+                              kClipChunkLines)) {
+    playback->bounce.release();
+    return ESP_ERR_NO_MEM;
+  }
+
+  playback->out = &out;
+  playback->period_us = 1000000 / clip.fps();
+  playback->timer = lv_timer_create(clip_timer_cb,
+                                    std::max(1, 1000 / clip.fps()), this);
+  lv_display_enable_invalidation(out.display->raw(), false);
+  lv_timer_pause(lv_display_get_refr_timer(out.display->raw()));
+  out.clip_buffers = playback->bounce.free;
+  clip_ = std::move(playback);
+  clip_reported_us_ = esp_timer_get_time();
+
+  ESP_LOGI("LvglPort", "Playing a %u-frame clip at %u fps on display %u",
+           clip.frames(), clip.fps(), (unsigned)display);
+  return ESP_OK;
 }
 
-void LvglPort::flush_cb_trampoline(lv_display_t* disp, const lv_area_t* area,
-                                   uint8_t* px_map) {
-  auto* port = static_cast<LvglPort*>(lv_display_get_user_data(disp));
-  if (port) {
-    auto target_disp = port->get_display();
-    if (target_disp) {
-      port->flush_cb(*target_disp, *area, px_map);
+void LvglPort::stop_clip() {
+  if (!clip_) {
+    return;
+  }
+  Output& out = *clip_->out;
+  lv_timer_delete(clip_->timer);
+  clip_->bounce.wait_idle();
+  out.clip_buffers = nullptr;
+  clip_->bounce.release();
+  report_clip();
+  clip_.reset();
+
+  // Hand the panel back: LVGL repaints it from scratch.
+  lv_display_enable_invalidation(out.display->raw(), true);
+  lv_obj_invalidate(lv_display_get_screen_active(out.display->raw()));
+  if (shared_refr_timer_) {
+    lv_timer_pause(lv_display_get_refr_timer(out.display->raw()));
+  }
+}
+
+bool LvglPort::clip_position(ClipPosition* position) const {
+  if (!clip_ || !clip_->keyed) {
+    return false;
+  }
+  const uint32_t frames = clip_->clip.frames();
+  position->frame = (clip_->next + frames - 1) % frames;
+  position->frames = frames;
+  position->sent = clip_->sent;
+  return true;
+}
+
+void LvglPort::clip_timer_cb(lv_timer_t* timer) {
+  static_cast<LvglPort*>(lv_timer_get_user_data(timer))->step_clip();
+}
+
+void LvglPort::step_clip() {
+  ClipPlayback& p = *clip_;
+  const int64_t start_us = esp_timer_get_time();
+  if (p.last_us && start_us - p.last_us > p.period_us * 3 / 2) {
+    p.late++;
+  }
+  p.last_us = start_us;
+
+  const Clip::Frame frame = p.keyed ? p.clip.delta(p.next) : p.clip.key();
+  if (!frame.empty()) {
+    const uint8_t* src = frame.data;
+    const uint8_t* end = frame.data + frame.size;
+    const int width = frame.width();
+    const bool ok = stream_rows(
+        p.out->panel, p.bounce, frame.x1, frame.y1, frame.x2, frame.y2,
+        [&](uint8_t* dst, size_t len) {
+          const int64_t decode_start_us = esp_timer_get_time();
+          src = Clip::decode_rows(src, end, reinterpret_cast<uint16_t*>(dst),
+                                  width, len / (width * sizeof(uint16_t)));
+          p.decode_us += esp_timer_get_time() - decode_start_us;
+          return src != nullptr;
+        });
+    if (!ok) {
+      ESP_LOGE("LvglPort", "Clip frame %u is corrupt, stopping",
+               (unsigned)p.next);
+      stop_clip();
+      return;
     }
+    p.px += (uint64_t)width * frame.height();
+    p.bytes += frame.size;
+  }
+  if (p.keyed) {
+    p.next = (p.next + 1) % p.clip.frames();
+  } else {
+    p.keyed = true;
+    p.next = 1 % p.clip.frames();
+  }
+
+  const uint32_t frame_us = (uint32_t)(esp_timer_get_time() - start_us);
+  p.sent++;
+  p.frames++;
+  p.frame_us += frame_us;
+  p.max_frame_us = std::max(p.max_frame_us, frame_us);
+}
+
+void LvglPort::report_clip() {
+  ClipPlayback& p = *clip_;
+  const int64_t now = esp_timer_get_time();
+  const float window_s = (now - clip_reported_us_) / 1e6f;
+  clip_reported_us_ = now;
+  if (p.frames == 0) {
+    return;
+  }
+  const float fps = window_s > 0 ? p.frames / window_s : 0.0f;
+  ESP_LOGI("LvglPort",
+           "Clip: %.1f fps (target %u), %.2f ms/frame (%.2f decoding), "
+           "%u late",
+           fps, p.clip.fps(), p.frame_us / 1000.0f / p.frames,
+           p.decode_us / 1000.0f / p.frames, (unsigned)p.late);
+  Telemetry::emit("clip",
+                  "frames=%u fps=%.1f target_fps=%u frame_ms=%.2f "
+                  "max_frame_ms=%.2f decode_ms=%.2f late=%u px_per_frame=%u "
+                  "bytes_per_frame=%u",
+                  (unsigned)p.frames, fps, p.clip.fps(),
+                  p.frame_us / 1000.0f / p.frames, p.max_frame_us / 1000.0f,
+                  p.decode_us / 1000.0f / p.frames, (unsigned)p.late,
+                  (unsigned)(p.px / p.frames),
+                  (unsigned)(p.bytes / p.frames));
+  p.frames = 0;
+  p.late = 0;
+  p.decode_us = 0;
+  p.frame_us = 0;
+  p.max_frame_us = 0;
+  p.px = 0;
+  p.bytes = 0;
+}
+
+void LvglPort::display_event_cb(lv_event_t* e) {
+  auto* port = static_cast<LvglPort*>(lv_event_get_user_data(e));
+  switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+      if (!port->task_handle_) {
+        // The refresh always runs on the port task: remember it for reports.
+        port->task_handle_ = xTaskGetCurrentTaskHandle();
+        if (CpuMonitor::ready()) {
+          CpuMonitor::watch(port->task_handle_);
+        }
+      }
+      break;
+    case LV_EVENT_FLUSH_FINISH:
+      if (port->first_flush_us_ == 0) {
+        port->first_flush_us_ = esp_timer_get_time();
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+WORKSHOP_HOT_FLUSH void LvglPort::flush_cb_trampoline(lv_display_t* disp,
+                                                      const lv_area_t* area,
+                                                      uint8_t* px_map) {
+  auto* out = static_cast<Output*>(lv_display_get_user_data(disp));
+  if (out) {
+    out->port->flush_cb(*out, *area, px_map);
   }
 }
 
-void LvglPort::flush_cb(lvgl::Display& disp, const lv_area_t& area,
-                        uint8_t* px_map) {
-  uint32_t w = lv_area_get_width(&area);
-  uint32_t h = lv_area_get_height(&area);
-  uint32_t len = w * h;
+WORKSHOP_HOT_FLUSH void LvglPort::flush_cb(Output& out, const lv_area_t& area,
+                                           uint8_t* px_map) {
+#ifdef CONFIG_WORKSHOP_HOT_PATH_PROFILING
+  HotPathProfiler::Scope probe(HotPathProfiler::kFlushCb);
+#endif
+#ifdef CONFIG_WORKSHOP_TRACE
+  TraceRecorder::Scope trace(TraceRecorder::kFlushCb);
+#endif
+  if (out.clip_buffers) {
+    // A clip owns the panel (see play_clip()).
+    lv_display_flush_ready(out.display->raw());
+    return;
+  }
 
-  uint16_t* buf16 = (uint16_t*)px_map;
+  const uint32_t w = lv_area_get_width(&area);
+  const uint32_t h = lv_area_get_height(&area);
 
   // BYTE SWAPPING & COLOR CORRECTION:
   // We must swap the Little-Endian bytes from the CPU for the Big-Endian LCD.
   // NOTE: Some panels require bitwise inversion (~), but the GC9A01 on the
   // Seeed XIAO Round Display uses standard logic. If your colors appear
-  // inverted (negative), toggle inversion with the ~ operator.
-  if (Workshop::USE_XTENSA_INTRINSICS) {
-    while (len > 0) {
-      *buf16 = __builtin_bswap16(*buf16);
-      buf16++;
-      len--;
-    }
-  } else {
-    while (len > 0) {
-      *buf16 = (uint16_t)((*buf16 >> 8) | (*buf16 << 8));
-      buf16++;
-      len--;
-    }
-  }
+  // inverted (negative), add the Invert stage to Workshop::FlushStages.
+  Workshop::FlushStages::run(reinterpret_cast<uint16_t*>(px_map), w, h);
 
-  // Transmit to panel
-  esp_lcd_panel_draw_bitmap(panel_handle_, area.x1, area.y1, area.x2 + 1,
-                            area.y2 + 1, px_map);
+  // Transmit to panel. Queuing blocks while the bus is saturated, e.g. by
+  // another panel's transfer: that is the bus contention we report.
+  const int64_t queue_start_us = esp_timer_get_time();
+  out.lvgl_in_flight++;
+  esp_err_t err = esp_lcd_panel_draw_bitmap(out.panel, area.x1, area.y1,
+                                            area.x2 + 1, area.y2 + 1, px_map);
+  out.stats.bus_wait_us += esp_timer_get_time() - queue_start_us;
+  if (err != ESP_OK) {
+    // Nothing was queued, so no completion will release the buffer: drop
+    // the area and hand the buffer back now instead of stalling LVGL.
+    out.lvgl_in_flight--;
+    ESP_LOGE("LvglPort", "Display %u: cannot send the area: %s",
+             (unsigned)out.index, esp_err_to_name(err));
+    lv_display_flush_ready(out.display->raw());
+  }
 }
 
-bool LvglPort::notify_flush_ready_trampoline(
+WORKSHOP_HOT_FLUSH bool LvglPort::notify_flush_ready_trampoline(
     esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t* edata,
     void* user_ctx) {
-  auto* port = static_cast<LvglPort*>(user_ctx);
-  auto target_disp = port->get_display();
-  if (target_disp) {
-    lv_display_flush_ready(target_disp->raw());
+#ifdef CONFIG_WORKSHOP_HOT_PATH_PROFILING
+  HotPathProfiler::Scope probe(HotPathProfiler::kFlushReadyIsr);
+#endif
+#ifdef CONFIG_WORKSHOP_TRACE
+  TraceRecorder::Scope trace(TraceRecorder::kFlushReadyIsr);
+#endif
+  auto* out = static_cast<Output*>(user_ctx);
+  if (out->lvgl_in_flight == 0) {
+    // Not LVGL's: a clip chunk finished (see play_clip()).
+    BaseType_t woken = pdFALSE;
+    if (out->clip_buffers) {
+      xSemaphoreGiveFromISR(out->clip_buffers, &woken);
+    }
+    return woken == pdTRUE;
   }
+  out->lvgl_in_flight--;
+  lv_display_flush_ready(out->display->raw());
   return false;
 }
 
 bool LvglPort::lock(uint32_t timeout_ms) {
   if (port_service_ && port_service_->get_lock()) {
-    return xSemaphoreTakeRecursive(port_service_->get_lock(),
-                                   timeout_ms == 0xFFFFFFFF
-                                       ? portMAX_DELAY
-                                       : pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+    int64_t start_us = esp_timer_get_time();
+    bool taken = xSemaphoreTakeRecursive(port_service_->get_lock(),
+                                         timeout_ms == 0xFFFFFFFF
+                                             ? portMAX_DELAY
+                                             : pdMS_TO_TICKS(timeout_ms)) ==
+                 pdTRUE;
+    if (taken && lock_depth_++ == 0) {
+      // Only the outermost acquisition counts; recursive re-entry is free.
+      lock_acquired_us_ = esp_timer_get_time();
+      if (recorder_) {
+        recorder_->add_lock_wait((uint32_t)(lock_acquired_us_ - start_us));
+      }
+    }
+    return taken;
   }
   return false;
 }
 
 void LvglPort::unlock() {
   if (port_service_ && port_service_->get_lock()) {
+    if (lock_depth_ > 0 && --lock_depth_ == 0 && recorder_) {
+      recorder_->add_lock_hold(
+          (uint32_t)(esp_timer_get_time() - lock_acquired_us_));
+    }
     xSemaphoreGiveRecursive(port_service_->get_lock());
   }
 }
 
-lvgl::Display* LvglPort::get_display() {
-  if (display_driver_ && display_driver_->display()) {
-    return display_driver_->display();
+/**
+ * RUNTIME TUNING
+ * --------------
+ * Both changes run with the LVGL lock held, so no refresh is in progress;
+ * only the transfers LVGL already queued can still be reading the old
+ * buffers or using the old IO, and those are waited out first.
+ */
+void LvglPort::wait_flushes_idle() {
+  for (auto& out : outputs_) {
+    while (out->lvgl_in_flight > 0) {
+      vTaskDelay(1);
+    }
+  }
+}
+
+esp_err_t LvglPort::set_strip_lines(int lines) {
+  if (display_driver_ ||
+      Workshop::BUFFER_MODE == Workshop::BufferMode::FullFrame) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+  if (lines <= 0 || lines > config_.v_res) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  struct Buffers {
+    lvgl::draw::DrawBuf buf{nullptr};
+    lvgl::draw::DrawBuf buf2{nullptr};
+  };
+  std::vector<Buffers> fresh(outputs_.size());
+  for (Buffers& b : fresh) {
+    b.buf = lvgl::draw::DrawBuf::allocate_dma(config_.h_res, lines,
+                                              lvgl::ColorFormat::RGB565,
+                                              Workshop::ALLOC_CAPS);
+    if (Workshop::USE_DOUBLE_BUFFERING) {
+      b.buf2 = lvgl::draw::DrawBuf::allocate_dma(config_.h_res, lines,
+                                                 lvgl::ColorFormat::RGB565,
+                                                 Workshop::ALLOC_CAPS);
+    }
+    if (!b.buf.raw() || (Workshop::USE_DOUBLE_BUFFERING && !b.buf2.raw())) {
+      ESP_LOGE("LvglPort", "No memory for %d-line strips", lines);
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
+  wait_flushes_idle();
+  for (size_t i = 0; i < outputs_.size(); i++) {
+    Output& out = *outputs_[i];
+    out.display->set_buffers(fresh[i].buf.data(), fresh[i].buf2.data(),
+                             fresh[i].buf.data_size(),
+                             Workshop::LVGL_RENDER_MODE);
+    out.buf = std::move(fresh[i].buf);
+    out.buf2 = std::move(fresh[i].buf2);
+    report_buffers(out, lines);
+    lv_obj_invalidate(lv_display_get_screen_active(out.display->raw()));
+  }
+  config_.strip_lines = lines;
+  return ESP_OK;
+}
+
+int LvglPort::strip_lines() const {
+  return Workshop::BUFFER_MODE == Workshop::BufferMode::FullFrame
+             ? config_.v_res
+             : config_.strip_lines;
+}
+
+size_t LvglPort::sram_bytes() const {
+  size_t bytes = config_.task_stack_size;
+  if (display_driver_) {
+    lv_display_t* disp = outputs_[0]->display->raw();
+    const lv_draw_buf_t* buf = lv_display_get_buf_active(disp);
+    if (buf) {
+      bytes += buf->data_size * (lv_display_is_double_buffered(disp) ? 2 : 1);
+    }
+    return bytes;
+  }
+  if (Workshop::ALLOC_CAPS & MALLOC_CAP_SPIRAM) {
+    return bytes;
+  }
+  for (const auto& out : outputs_) {
+    bytes += out->buf.data_size() * (out->buf2.raw() ? 2 : 1);
+  }
+  return bytes;
+}
+
+esp_err_t LvglPort::set_bus_clock(uint32_t hz) {
+  if (display_driver_ || !bus_clock_handler_) {
+    return ESP_ERR_NOT_SUPPORTED;
   }
-  return display_.get();
+  if (clip_) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  wait_flushes_idle();
+  // The panels share one clock: if one cannot take the new one (and so
+  // stays on the old one, see BusClockHandler), put back the ones already
+  // changed.
+  auto retune = [this](Output& out, uint32_t clock_hz) {
+    esp_lcd_panel_io_handle_t io = out.io;
+    esp_err_t err = bus_clock_handler_(out.index, clock_hz, &out.panel, &io);
+    if (io != out.io) {
+      out.io = io;
+      register_io_callbacks(out);
+    }
+    return err;
+  };
+  for (size_t i = 0; i < outputs_.size(); i++) {
+    esp_err_t err = retune(*outputs_[i], hz);
+    if (err == ESP_OK) {
+      continue;
+    }
+    ESP_LOGE("LvglPort", "Display %u cannot run at %u Hz: %s",
+             (unsigned)outputs_[i]->index, (unsigned)hz, esp_err_to_name(err));
+    for (size_t j = 0; j < i; j++) {
+      if (retune(*outputs_[j], config_.bus_clock_hz) != ESP_OK) {
+        ESP_LOGE("LvglPort", "Display %u lost its panel IO",
+                 (unsigned)outputs_[j]->index);
+      }
+    }
+    return err;
+  }
+  config_.bus_clock_hz = hz;
+  ESP_LOGI("LvglPort", "SPI clock now %u MHz", (unsigned)(hz / 1000000));
+  return ESP_OK;
 }
 
+lvgl::Display* LvglPort::get_display() { return get_display(0); }
+
+lvgl::Display* LvglPort::get_display(size_t index) {
+  return index < outputs_.size() ? outputs_[index]->display : nullptr;
+}
+
+size_t LvglPort::display_count() const { return outputs_.size(); }
+
 void LvglPort::set_rotation(lvgl::Display::Rotation rotation) {
   lvgl::Display* target_disp = get_display();
   if (target_disp) {
@@ -184,6 +977,160 @@ void LvglPort::set_rotation(lvgl::Display::Rotation rotation) {
   }
 }
 
+void LvglPort::poll_diagnostics() {
+  if (recorder_) {
+    recorder_->dump_pending();
+  }
+
+  if (heatmap_ && heatmap_->frames() >= config_.heatmap_report_frames) {
+    // Copy under the lock, print without it.
+    RedrawHeatmap::Report report;
+    {
+      Lock guard(*this);
+      report = heatmap_->report();
+      heatmap_->reset();
+    }
+    report.dump_console();
+#if CONFIG_IDF_TARGET_LINUX
+    // The host build has a filesystem: keep an image next to the binary.
+    report.write_ppm("redraw_heatmap.ppm");
+#endif
+  }
+
+  if (image_cache_) {
+    const int64_t now = esp_timer_get_time();
+    if (now - image_cache_reported_us_ >=
+        (int64_t)config_.image_cache_report_ms * 1000) {
+      image_cache_reported_us_ = now;
+      // Copies under the cache's own mutex; hit rates are per window.
+      image_cache_->report().emit();
+      image_cache_->reset();
+    }
+  }
+
+  if (governor_) {
+    const int64_t now = esp_timer_get_time();
+    if (now - governor_reported_us_ >=
+        (int64_t)config_.governor_report_ms * 1000) {
+      governor_reported_us_ = now;
+      governor_->report();
+    }
+  }
+
+  if (pacer_) {
+    const int64_t now = esp_timer_get_time();
+    if (now - pacer_reported_us_ >= (int64_t)config_.pacing_report_ms * 1000) {
+      pacer_reported_us_ = now;
+      pacer_->report();
+    }
+  }
+
+  if (outputs_.size() > 1) {
+    const int64_t now = esp_timer_get_time();
+    if (now - displays_reported_us_ >=
+        (int64_t)config_.display_report_ms * 1000) {
+      report_displays(now - displays_reported_us_);
+      displays_reported_us_ = now;
+    }
+  }
+
+  if (clip_) {
+    const int64_t now = esp_timer_get_time();
+    if (now - clip_reported_us_ >=
+        (int64_t)config_.display_report_ms * 1000) {
+      Lock guard(*this);
+      if (clip_) report_clip();
+    }
+  }
+
+  if (static_scene_) {
+    // Report once per suspend, not every poll.
+    StaticScene::Stats stats = static_scene_->stats();
+    if (stats.suspends != static_reported_suspends_) {
+      static_reported_suspends_ = stats.suspends;
+      static_scene_->report();
+    }
+  }
+}
+
+void LvglPort::report_displays(int64_t window_us) {
+  // Copy under the lock, print without it.
+  std::vector<DisplayStats> stats;
+  {
+    Lock guard(*this);
+    for (auto& out : outputs_) {
+      stats.push_back(out->stats);
+      out->stats = DisplayStats{};
+    }
+  }
+
+  const float window_s = window_us / 1e6f;
+  for (size_t i = 0; i < stats.size(); i++) {
+    const DisplayStats& s = stats[i];
+    const float fps = window_s > 0 ? s.frames / window_s : 0.0f;
+    const float contention_pct =
+        window_us > 0 ? 100.0f * s.bus_wait_us / window_us : 0.0f;
+    ESP_LOGI("LvglPort",
+             "Display %u: %.1f fps, %u flushes, bus wait %.1f ms (%.1f%%)",
+             (unsigned)i, fps, (unsigned)s.flushes, s.bus_wait_us / 1000.0f,
+             contention_pct);
+    Telemetry::emit("display",
+                    "id=%u fps=%.1f frames=%u flushes=%u flushed_px=%llu "
+                    "bus_wait_us=%llu contention_pct=%.1f",
+                    (unsigned)i, fps, (unsigned)s.frames, (unsigned)s.flushes,
+                    (unsigned long long)s.flushed_px,
+                    (unsigned long long)s.bus_wait_us, contention_pct);
+  }
+}
+
+void LvglPort::set_touch_wakeup(bool enabled) {
+  if (static_scene_) {
+    static_scene_->set_input_wakeup(enabled);
+  }
+}
+
+void LvglPort::wake_from_isr(void* arg) {
+  BaseType_t woken = pdFALSE;
+  xTimerPendFunctionCallFromISR(wake_deferred, arg, 0, &woken);
+  if (woken == pdTRUE) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+void LvglPort::wake_deferred(void* arg, uint32_t unused) {
+  auto* port = static_cast<LvglPort*>(arg);
+  if (!port->static_scene_ || !port->static_scene_->suspended()) {
+    return;
+  }
+  // A touch must not be lost to a busy lock: queue the wake again.
+  if (!port->lock(50)) {
+    xTimerPendFunctionCall(wake_deferred, arg, 0, 0);
+    return;
+  }
+  port->static_scene_->wake();
+  port->unlock();
+}
+
+void LvglPort::scene_sleep_deferred(void* arg, uint32_t unused) {
+  auto* port = static_cast<LvglPort*>(arg);
+  if (!port->lock(50)) {
+    xTimerPendFunctionCall(scene_sleep_deferred, arg, 0, 0);
+    return;
+  }
+  // The panel commands go out from the LVGL task, which owns the panels
+  // (set_bus_clock() may replace them) and the bus.
+  lv_async_call(
+      [](void* p) {
+        auto* self = static_cast<LvglPort*>(p);
+        if (self->static_scene_) {
+          self->static_scene_->sleep_panel();
+        }
+      },
+      port);
+  port->unlock();
+  port->notify_event(0);
+}
+
 void LvglPort::notify_event(uint32_t event_bit) {
   if (port_service_) {
     // If we're calling from an interrupt, use the ISR-safe notification
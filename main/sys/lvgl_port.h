@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -13,6 +15,15 @@
 #include "lvgl.h"
 #include "lvgl_cpp/draw/draw_buf.h"
 #include "lvgl_cpp/indev/pointer_input.h"
+#include "sys/clip.h"
+#include "sys/cpu_monitor.h"
+#include "sys/frame_governor.h"
+#include "sys/frame_pacer.h"
+#include "sys/frame_recorder.h"
+#include "sys/image_cache_monitor.h"
+#include "sys/redraw_heatmap.h"
+#include "sys/static_scene.h"
+#include "sys/trace_recorder.h"
 #include "utility/portable/esp32/port.h"
 
 // ... (rest of includes)
@@ -35,8 +46,61 @@ class LvglPort {
     int v_res = 240;
     uint32_t tick_period_ms = 5;
     uint32_t task_stack_size = 32 * 1024;
+    // Lines per draw buffer when the port manages partial strips.
+    int strip_lines = 20;
+    // SPI clock the panels were brought up with (see set_bus_clock()).
+    uint32_t bus_clock_hz = 0;
     int task_priority = 5;
     BaseType_t task_affinity = tskNO_AFFINITY;
+    // Flight recorder: frames kept in the ring (0 disables it) and the
+    // frame time that triggers a jank snapshot.
+    size_t recorder_depth = 0;
+    uint32_t jank_budget_ms = 50;
+    // Redraw heatmap: tile size in pixels (0 disables it) and how many
+    // frames to accumulate between console reports.
+    int heatmap_tile_size = 0;
+    uint32_t heatmap_report_frames = 300;
+    // Image cache monitor: report interval (0 disables it) and whether
+    // eviction weighs re-render cost instead of recency.
+    uint32_t image_cache_report_ms = 0;
+    bool image_cache_cost_eviction = false;
+    // Frame governor: CPU frequency between frames (0 disables it), the
+    // frequency held while rendering, the frame budget it adapts to and how
+    // often its statistics are reported.
+    int governor_min_mhz = 0;
+    int governor_max_mhz = 240;
+    uint32_t governor_budget_ms = 33;
+    uint32_t governor_report_ms = 10000;
+    // Static scene detection: idle refresh passes before rendering is
+    // suspended (0 disables it) and the stillness after which the backlight
+    // and panel go to sleep (0 = never).
+    uint32_t static_idle_frames = 0;
+    uint32_t static_sleep_ms = 0;
+    // How often per-display FPS and bus contention are reported when more
+    // than one display is attached.
+    uint32_t display_report_ms = 10000;
+    // Event trace: capacity in events (0 disables it); captures are started
+    // and stopped through TraceRecorder.
+    size_t trace_events = 0;
+    // CPU monitor: report period (0 disables it); the port task is watched
+    // for core placement and migrations.
+    uint32_t cpu_monitor_ms = 0;
+    // Frame pacing: fastest locked rate in Hz (0 disables it; the slower
+    // rates divide it), the share of a slot period a frame may use and how
+    // often the pacing statistics are reported.
+    uint32_t pacing_max_hz = 0;
+    uint32_t pacing_headroom_pct = 90;
+    uint32_t pacing_report_ms = 10000;
+  };
+
+  /**
+   * Per-display counters, reset on every report.
+   */
+  struct DisplayStats {
+    uint32_t frames = 0;       // Refreshes that flushed something.
+    uint32_t flushes = 0;      // flush_cb invocations.
+    uint64_t flushed_px = 0;   // Pixels handed to the panel.
+    uint64_t bus_wait_us = 0;  // Time spent queuing transfers on the bus.
   };
 
   explicit LvglPort(const Config& config);
@@ -50,6 +114,77 @@ class LvglPort {
   void init(esp_lcd_panel_handle_t panel_handle,
             esp_lcd_panel_io_handle_t io_handle);
 
+  /**
+   * Add another panel to the render loop, e.g. a second GC9A01 on the same
+   * SPI bus with its own CS pin. Extra displays use the port's flush path
+   * with their own draw buffers, and refreshes are arbitrated round-robin.
+   * Instrumentation (recorder, heatmap, governor) stays on display 0. Call
+   * after init(), without holding the lock.
+   * @return The new display, or nullptr on failure.
+   */
+  lvgl::Display* add_display(esp_lcd_panel_handle_t panel_handle,
+                             esp_lcd_panel_io_handle_t io_handle);
+
+  /**
+   * Stream a pre-rendered, panel-ready frame (RGB565, byte-swapped, h_res x
+   * v_res) straight from flash to the panel through a small DMA bounce
+   * buffer. Call after the panel is initialized and before init(): the
+   * frame stays on the glass until LVGL's first flush paints over it.
+   * @return True if the whole frame was sent.
+   */
+  bool show_splash(esp_lcd_panel_handle_t panel_handle,
+                   esp_lcd_panel_io_handle_t io_handle, const uint8_t* frame,
+                   size_t size);
+
+  /**
+   * Fills `len` bytes of panel-ready pixels, in order, into a bounce buffer.
+   * @return False to abort.
+   */
+  using PixelReader = std::function<bool(uint8_t* dst, size_t len)>;
+
+  /**
+   * Same as above, but the frame (`size` bytes) is produced chunk by chunk,
+   * e.g. decompressed from the asset partition straight into the bounce
+   * buffers.
+   */
+  bool show_splash(esp_lcd_panel_handle_t panel_handle,
+                   esp_lcd_panel_io_handle_t io_handle, size_t size,
+                   const PixelReader& read);
+
+  /**
+   * Play a pre-rendered animation clip (see sys/clip.h) on a display in
+   * place of LVGL's rendering, looping until stop_clip(). Frames are
+   * decoded from the blob (e.g. the mapped asset partition) row by row
+   * into DMA bounce buffers and sent as they fill. LVGL keeps running
+   * (input, timers) but nothing it renders reaches that panel. Needs the
+   * port's own flush path (not the native driver). Call with the LVGL lock
+   * held.
+   * @return ESP_OK, ESP_ERR_INVALID_STATE for a bad clip,
+   *         ESP_ERR_INVALID_SIZE if it does not match the panel,
+   *         ESP_ERR_NOT_SUPPORTED with the native driver or ESP_ERR_NO_MEM.
+   */
+  esp_err_t play_clip(const uint8_t* data, size_t size, size_t display = 0);
+
+  /**
+   * Stop the clip, report its statistics and let LVGL repaint the panel.
+   * Call with the LVGL lock held.
+   */
+  void stop_clip();
+
+  bool clip_playing() const { return clip_ != nullptr; }
+
+  struct ClipPosition {
+    uint32_t frame;   // Last sent; on the panel once the bus is idle.
+    uint32_t frames;  // In the clip.
+    uint32_t sent;    // Since play_clip(), key frame included.
+  };
+
+  /**
+   * Where the clip is. Call with the LVGL lock held.
+   * @return False if no clip plays or its key frame is not out yet.
+   */
+  bool clip_position(ClipPosition* position) const;
+
   /**
    * Lock the LVGL API for thread-safe access.
    * @param timeout_ms The timeout in milliseconds.
@@ -92,6 +227,15 @@ class LvglPort {
    */
   lvgl::Display* get_display();
 
+  /**
+   * Get a display by index (0 is the one passed to init()).
+   * @return A pointer to the display object, or nullptr.
+   */
+  lvgl::Display* get_display(size_t index);
+
+  /** Number of displays driven by this port. */
+  size_t display_count() const;
+
   /**
    * Set the display rotation.
    */
@@ -108,7 +252,16 @@ class LvglPort {
       indev_->set_read_cb([this, driver](lvgl::IndevData& data) {
         uint16_t x = 0, y = 0;
         bool pressed = false;
-        if (driver->read(&x, &y, &pressed) == ESP_OK) {
+        int64_t start_us = esp_timer_get_time();
+#ifdef CONFIG_WORKSHOP_TRACE
+        TraceRecorder::Scope trace(TraceRecorder::kTouchRead);
+#endif
+        esp_err_t err = driver->read(&x, &y, &pressed);
+        if (recorder_) {
+          recorder_->add_touch_read(
+              (uint32_t)(esp_timer_get_time() - start_us));
+        }
+        if (err == ESP_OK) {
           if (pressed) {
             data.set_point(x, y);
             data.set_state(lvgl::IndevState::Pressed);
@@ -120,15 +273,211 @@ class LvglPort {
     }
   }
 
+  /**
+   * Set the backlight control used when the panel sleeps on a static scene.
+   */
+  void set_backlight_handler(std::function<void(bool on)> handler) {
+    backlight_handler_ = std::move(handler);
+  }
+
+  /**
+   * Re-create the IO of display `index` at `hz`, replacing *panel and *io
+   * with the new handles (or leaving them if they did not change). On
+   * failure the display must be left working at its previous clock.
+   */
+  using BusClockHandler =
+      std::function<esp_err_t(size_t index, uint32_t hz,
+                              esp_lcd_panel_handle_t* panel,
+                              esp_lcd_panel_io_handle_t* io)>;
+
+  /**
+   * Set how the panels change their SPI clock; without a handler
+   * set_bus_clock() is not supported.
+   */
+  void set_bus_clock_handler(BusClockHandler handler) {
+    bus_clock_handler_ = std::move(handler);
+  }
+
+  /**
+   * RUNTIME TUNING
+   * --------------
+   * Re-allocate every display's draw buffers with `lines` lines per strip.
+   * The new buffers are allocated before the old ones are released, so a
+   * failure leaves the displays as they were. Needs the port's own flush
+   * path in strip mode. Call with the LVGL lock held.
+   * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NOT_SUPPORTED (native
+   *         driver or full-frame buffers) or ESP_ERR_NO_MEM.
+   */
+  esp_err_t set_strip_lines(int lines);
+
+  /** Lines per draw buffer (v_res with full-frame buffers). */
+  int strip_lines() const;
+
+  /**
+   * Internal SRAM held by the port: every display's draw buffers (unless
+   * they are in PSRAM) and the port task's stack. The native driver's
+   * buffers are internal by design. Call with the LVGL lock held.
+   */
+  size_t sram_bytes() const;
+
+  /**
+   * Move every panel to a new SPI clock through the bus clock handler,
+   * once the transfers in flight have landed. Call with the LVGL lock held.
+   * @return ESP_OK, ESP_ERR_NOT_SUPPORTED (native driver or no handler),
+   *         ESP_ERR_INVALID_STATE while a clip plays, or the handler's
+   *         error.
+   */
+  esp_err_t set_bus_clock(uint32_t hz);
+
+  uint32_t bus_clock_hz() const { return config_.bus_clock_hz; }
+
+  /**
+   * Tell the static scene monitor that touch can wake it by interrupt
+   * (wake_from_isr), so input polling may stop while suspended. Call with
+   * the LVGL lock held.
+   */
+  void set_touch_wakeup(bool enabled);
+
+  /**
+   * GPIO ISR handler (arg: the LvglPort) that resumes a suspended static
+   * scene. The wake itself is deferred to the FreeRTOS timer task, and
+   * retried there until the LVGL lock is free.
+   */
+  static void wake_from_isr(void* arg);
+
   /**
    * Wake the rendering task via event bits.
    */
   void notify_event(uint32_t event_bit);
 
+  /**
+   * Print any pending diagnostics (e.g. a frozen jank snapshot). Call
+   * periodically from a low-priority task, never from the LVGL task.
+   */
+  void poll_diagnostics();
+
+  /**
+   * Get the flight recorder, or nullptr if it is disabled.
+   */
+  FrameRecorder* get_recorder() { return recorder_.get(); }
+
+  /**
+   * Get the frame pacer, or nullptr if it is disabled.
+   */
+  FramePacer* get_pacer() { return pacer_.get(); }
+
+  /**
+   * Get the task that runs LVGL, or nullptr before the first refresh.
+   */
+  TaskHandle_t get_task_handle() const { return task_handle_; }
+
+  /**
+   * Time (esp_timer, us) at which the first pixels were flushed to the
+   * panel, or 0 if nothing has been flushed yet.
+   */
+  int64_t first_flush_us() const { return first_flush_us_; }
+
  private:
+  friend class HotPathProfiler;  // Reads the flush path addresses.
+
+  /**
+   * One panel: its LVGL display, draw buffers and flush statistics.
+   * Heap-allocated so the address handed to LVGL and esp_lcd stays fixed.
+   */
+  struct Output {
+    LvglPort* port = nullptr;
+    size_t index = 0;
+    esp_lcd_panel_handle_t panel = nullptr;
+    esp_lcd_panel_io_handle_t io = nullptr;
+    lvgl::Display* display = nullptr;  // owned_display or the native driver's.
+    std::unique_ptr<lvgl::Display> owned_display;
+    lvgl::draw::DrawBuf buf{nullptr};
+    lvgl::draw::DrawBuf buf2{nullptr};
+    bool flushed = false;  // Current refresh flushed something.
+    DisplayStats stats;    // Only touched with the LVGL lock held.
+    // LVGL transfers on the bus; completions beyond these are clip chunks.
+    std::atomic<uint32_t> lvgl_in_flight{0};
+    // Free clip bounce buffers while a clip plays on this panel, else null.
+    SemaphoreHandle_t clip_buffers = nullptr;
+  };
+
+  /**
+   * Two internal DMA buffers that pixels from flash (which the SPI DMA
+   * cannot read) are staged through, with one semaphore token per idle
+   * buffer: the CPU fills one while the other is on the wire.
+   */
+  struct Bounce {
+    uint8_t* buf[2] = {nullptr, nullptr};
+    size_t bytes = 0;
+    SemaphoreHandle_t free = nullptr;
+    int next = 0;
+
+    bool alloc(size_t size);
+    /** Wait until nothing is in flight. */
+    void wait_idle();
+    /** wait_idle(), then free everything. */
+    void release();
+  };
+
+  /** A clip playing on one display (see play_clip()). */
+  struct ClipPlayback {
+    Output* out = nullptr;
+    Clip clip;
+    Bounce bounce;
+    lv_timer_t* timer = nullptr;
+    bool keyed = false;   // Key frame sent.
+    uint32_t next = 0;    // Next delta.
+    uint32_t sent = 0;    // Frames sent since play_clip().
+    int64_t last_us = 0;  // Start of the previous frame.
+    int64_t period_us = 0;
+
+    // Statistics since the last report.
+    uint32_t frames = 0;
+    uint32_t late = 0;       // Started more than half a period late.
+    uint64_t decode_us = 0;  // Filling bounce buffers.
+    uint64_t frame_us = 0;   // Decode plus waiting for the bus.
+    uint32_t max_frame_us = 0;
+    uint64_t px = 0;
+    uint64_t bytes = 0;
+  };
+
+  /**
+   * Send the area (end-exclusive) through the bounce buffers, as many
+   * whole rows per transfer as fit.
+   */
+  bool stream_rows(esp_lcd_panel_handle_t panel, Bounce& bounce, int x1,
+                   int y1, int x2, int y2, const PixelReader& read);
+
+  Output* create_output(esp_lcd_panel_handle_t panel_handle,
+                        esp_lcd_panel_io_handle_t io_handle);
+  void attach_output_events(Output& out);
+  void register_io_callbacks(Output& out);
+  void report_buffers(const Output& out, size_t lines);
+  /** Wait until every LVGL transfer in flight has completed. */
+  void wait_flushes_idle();
+  void report_displays(int64_t window_us);
+  static void output_event_cb(lv_event_t* e);
+  static void shared_refresh_cb(lv_timer_t* timer);
+  /** One refresh of every display, as the pacer runs it once per slot. */
+  void paced_refresh();
+  /** Keep a display's own refresh timer from ever firing by itself. */
+  void park_refresh_timer(Output& out);
+
+  static void display_event_cb(lv_event_t* e);
+  static void wake_deferred(void* arg, uint32_t unused);
+  static void scene_sleep_deferred(void* arg, uint32_t unused);
+
   static void flush_cb_trampoline(lv_display_t* disp, const lv_area_t* area,
                                   uint8_t* px_map);
-  void flush_cb(lvgl::Display& disp, const lv_area_t& area, uint8_t* px_map);
+  void flush_cb(Output& out, const lv_area_t& area, uint8_t* px_map);
+
+  static bool splash_chunk_done(esp_lcd_panel_io_handle_t panel_io,
+                                esp_lcd_panel_io_event_data_t* edata,
+                                void* user_ctx);
+
+  static void clip_timer_cb(lv_timer_t* timer);
+  void step_clip();
+  void report_clip();
 
   static bool notify_flush_ready_trampoline(
       esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t* edata,
@@ -136,11 +485,32 @@ class LvglPort {
 
   Config config_;
   std::unique_ptr<lvgl::utility::Esp32Port> port_service_;
-  esp_lcd_panel_handle_t panel_handle_ = nullptr;
 
   std::unique_ptr<lvgl::Esp32Spi> display_driver_;
-  std::unique_ptr<lvgl::Display> display_;
-  lvgl::draw::DrawBuf draw_buf_;
-  lvgl::draw::DrawBuf draw_buf2_;
+  std::vector<std::unique_ptr<Output>> outputs_;
+  lv_timer_t* shared_refr_timer_ = nullptr;
+  size_t refresh_first_ = 0;
+  int64_t displays_reported_us_ = 0;
   std::unique_ptr<lvgl::PointerInput> indev_;
+
+  TaskHandle_t task_handle_ = nullptr;
+  std::atomic<int64_t> first_flush_us_{0};
+
+  std::unique_ptr<FrameRecorder> recorder_;
+  std::unique_ptr<RedrawHeatmap> heatmap_;
+  std::unique_ptr<ImageCacheMonitor> image_cache_;
+  int64_t image_cache_reported_us_ = 0;
+  std::unique_ptr<FrameGovernor> governor_;
+  int64_t governor_reported_us_ = 0;
+  std::unique_ptr<StaticScene> static_scene_;
+  std::unique_ptr<FramePacer> pacer_;
+  int64_t pacer_reported_us_ = 0;
+  std::unique_ptr<ClipPlayback> clip_;
+  int64_t clip_reported_us_ = 0;
+  std::function<void(bool on)> backlight_handler_;
+  BusClockHandler bus_clock_handler_;
+  uint32_t static_reported_suspends_ = 0;
+  // Lock bookkeeping for the recorder (only touched by the lock holder).
+  uint32_t lock_depth_ = 0;
+  int64_t lock_acquired_us_ = 0;
 };
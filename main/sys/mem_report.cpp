@@ -0,0 +1,148 @@
+#include "sys/mem_report.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sys/telemetry.h"
+
+static const char* TAG = "MemReport";
+
+/**
+ * STACK & MEMORY HIGH-WATER REPORTER: Implementation
+ * --------------------------------------------------
+ * On ESP-IDF the stack type is a byte, so high-water marks are already in
+ * bytes. Tasks are tracked by handle: a task that is deleted keeps its last
+ * mark, which is what we want for a post-benchmark report.
+ */
+
+MemReport::MemReport() {
+  heaps_ = {
+      {"internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT},
+      {"dma", MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL},
+      {"spiram", MALLOC_CAP_SPIRAM},
+      {"default", MALLOC_CAP_DEFAULT},
+  };
+  for (auto& heap : heaps_) {
+    heap.total = heap_caps_get_total_size(heap.caps);
+  }
+}
+
+MemReport::~MemReport() { stop_sampler(); }
+
+bool MemReport::start_sampler(uint32_t period_ms) {
+  if (sampler_done_) {
+    return true;
+  }
+  sampler_done_ = xSemaphoreCreateBinary();
+  if (!sampler_done_) {
+    return false;
+  }
+  sampler_period_ms_ = period_ms;
+  sampler_stop_ = false;
+  if (xTaskCreate(sampler_task, "mem_sample", 4096, this, 2, nullptr) !=
+      pdPASS) {
+    ESP_LOGE(TAG, "Failed to start the sampler task");
+    vSemaphoreDelete(sampler_done_);
+    sampler_done_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void MemReport::stop_sampler() {
+  if (!sampler_done_) {
+    return;
+  }
+  sampler_stop_ = true;
+  xSemaphoreTake(sampler_done_, portMAX_DELAY);
+  vSemaphoreDelete(sampler_done_);
+  sampler_done_ = nullptr;
+}
+
+void MemReport::sampler_task(void* arg) {
+  auto* self = static_cast<MemReport*>(arg);
+  while (!self->sampler_stop_) {
+    self->sample();
+    vTaskDelay(pdMS_TO_TICKS(self->sampler_period_ms_) + 1);
+  }
+  self->sample();
+  xSemaphoreGive(self->sampler_done_);
+  vTaskDelete(nullptr);
+}
+
+void MemReport::sample() {
+  samples_++;
+
+  // 1. Task stacks
+  status_.resize(uxTaskGetNumberOfTasks() + 4);
+  UBaseType_t count =
+      uxTaskGetSystemState(status_.data(), status_.size(), nullptr);
+  for (UBaseType_t i = 0; i < count; i++) {
+    const TaskStatus_t& st = status_[i];
+    auto it = std::find_if(tasks_.begin(), tasks_.end(), [&](const auto& t) {
+      return t.handle == st.xHandle;
+    });
+    if (it == tasks_.end()) {
+      TaskStack entry;
+      entry.handle = st.xHandle;
+      strlcpy(entry.name, st.pcTaskName, sizeof(entry.name));
+      tasks_.push_back(entry);
+      it = tasks_.end() - 1;
+    }
+    it->min_free_bytes =
+        std::min<uint32_t>(it->min_free_bytes, st.usStackHighWaterMark);
+  }
+
+  // 2. Heap capabilities
+  for (auto& heap : heaps_) {
+    if (heap.total == 0) continue;  // e.g. no PSRAM fitted
+    heap.min_free =
+        std::min(heap.min_free, heap_caps_get_free_size(heap.caps));
+    heap.min_largest_block = std::min(
+        heap.min_largest_block, heap_caps_get_largest_free_block(heap.caps));
+  }
+}
+
+void MemReport::report() const {
+  ESP_LOGI(TAG, "High-water marks over %u samples:", (unsigned)samples_);
+  ESP_LOGI(TAG, "  %-16s %10s", "task", "min free");
+  for (const auto& t : tasks_) {
+    ESP_LOGI(TAG, "  %-16s %10u", t.name, (unsigned)t.min_free_bytes);
+    Telemetry::emit("stack", "task=%s min_free=%u", t.name,
+                    (unsigned)t.min_free_bytes);
+  }
+
+  ESP_LOGI(TAG, "  %-10s %10s %10s %12s", "caps", "total", "min free",
+           "min largest");
+  for (const auto& h : heaps_) {
+    if (h.total == 0) continue;
+    ESP_LOGI(TAG, "  %-10s %10u %10u %12u", h.name, (unsigned)h.total,
+             (unsigned)h.min_free, (unsigned)h.min_largest_block);
+    Telemetry::emit("heap",
+                    "caps=%s total=%u min_free=%u min_largest=%u "
+                    "boot_min_free=%u",
+                    h.name, (unsigned)h.total, (unsigned)h.min_free,
+                    (unsigned)h.min_largest_block,
+                    (unsigned)heap_caps_get_minimum_free_size(h.caps));
+  }
+}
+
+uint32_t MemReport::task_min_free(TaskHandle_t handle) const {
+  for (const auto& t : tasks_) {
+    if (t.handle == handle) return t.min_free_bytes;
+  }
+  return UINT32_MAX;
+}
+
+uint32_t MemReport::recommend_stack(uint32_t configured, uint32_t min_free,
+                                    uint32_t margin_pct) {
+  if (min_free > configured) {
+    return configured;  // Never sampled.
+  }
+  uint32_t peak = configured - min_free;
+  uint32_t with_margin = peak + peak * margin_pct / 100;
+  uint32_t rounded = (with_margin + 1023) & ~1023u;
+  return std::max<uint32_t>(rounded, 8 * 1024);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+/**
+ * STACK & MEMORY HIGH-WATER REPORTER
+ * ----------------------------------
+ * Internal SRAM is shared by the framebuffers, ThorVG and every task stack,
+ * so stack sizes should be measured rather than guessed. sample() records,
+ * for every task, the lowest stack headroom ever seen
+ * (uxTaskGetStackHighWaterMark) and, per heap capability, the lowest free
+ * size and the smallest "largest free block" (fragmentation). report()
+ * prints both as logs and telemetry records.
+ *
+ * Sample from a task other than the one being measured: sample() walks every
+ * task and heap on the caller's stack, which would inflate that task's own
+ * high-water mark. start_sampler() runs it from a task of its own.
+ *
+ * Requires CONFIG_FREERTOS_USE_TRACE_FACILITY for uxTaskGetSystemState().
+ */
+class MemReport {
+ public:
+  struct TaskStack {
+    TaskHandle_t handle = nullptr;
+    char name[configMAX_TASK_NAME_LEN] = {};
+    uint32_t min_free_bytes = UINT32_MAX;
+  };
+
+  struct HeapCaps {
+    const char* name;
+    uint32_t caps;
+    size_t total = 0;
+    size_t min_free = SIZE_MAX;
+    size_t min_largest_block = SIZE_MAX;
+  };
+
+  MemReport();
+  ~MemReport();
+
+  MemReport(const MemReport&) = delete;
+  MemReport& operator=(const MemReport&) = delete;
+
+  /** Take one sample of every task stack and heap capability. */
+  void sample();
+
+  /**
+   * Call sample() every `period_ms` from a background task until
+   * stop_sampler().
+   * @return True if the sampler task was started.
+   */
+  bool start_sampler(uint32_t period_ms);
+
+  /** Stop the sampler and wait for its last sample. */
+  void stop_sampler();
+
+  /** Print the high-water marks (logs + TLM records). */
+  void report() const;
+
+  /** Lowest stack headroom seen for a task, or UINT32_MAX if unknown. */
+  uint32_t task_min_free(TaskHandle_t handle) const;
+
+  uint32_t samples() const { return samples_; }
+
+  /**
+   * Smallest safe stack: the measured peak usage plus a margin, rounded up
+   * to 1 KB and never below 8 KB.
+   * @param configured The stack size the task was created with.
+   * @param min_free The lowest headroom observed for it.
+   * @param margin_pct Extra headroom on top of the peak, in percent.
+   */
+  static uint32_t recommend_stack(uint32_t configured, uint32_t min_free,
+                                  uint32_t margin_pct);
+
+ private:
+  static void sampler_task(void* arg);
+
+  std::vector<TaskStack> tasks_;
+  std::vector<TaskStatus_t> status_;
+  std::vector<HeapCaps> heaps_;
+  uint32_t samples_ = 0;
+
+  uint32_t sampler_period_ms_ = 0;
+  std::atomic<bool> sampler_stop_{false};
+  SemaphoreHandle_t sampler_done_ = nullptr;
+};
@@ -0,0 +1,247 @@
+#include "sys/redraw_heatmap.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "esp_log.h"
+#include "lvgl_private.h"  // lv_draw_unit_t, lv_draw_task_t, lv_layer_t
+
+static const char* TAG = "RedrawHeatmap";
+
+/**
+ * REDRAW HEATMAP: Implementation
+ * ------------------------------
+ * Blends are observed where LVGL creates them rather than where they run: a
+ * passive draw unit is registered whose evaluate_cb sees every draw task
+ * before a real unit claims it, so image blends that the SIMD shims do not
+ * cover (ARGB8888 -> RGB565, transformed images, glyphs) are counted too.
+ * The unit never takes a task and its dispatch_cb always reports idle.
+ *
+ * Draw tasks are created by the task that holds the LVGL lock, so the
+ * counters are only written with that lock held, even when draw threads
+ * render the tasks in parallel. A task's area is in screen coordinates;
+ * clipping it to the task's clip area gives the pixels it covers.
+ */
+
+lv_draw_unit_t* RedrawHeatmap::unit_ = nullptr;
+RedrawHeatmap* RedrawHeatmap::active_ = nullptr;
+
+static const char* const kCounterNames[] = {"invalidated", "blended",
+                                            "flushed"};
+
+RedrawHeatmap::RedrawHeatmap(int h_res, int v_res, int tile_size)
+    : h_res_(h_res), v_res_(v_res) {
+  counters_.tile_size = tile_size;
+  counters_.tiles_x = (h_res + tile_size - 1) / tile_size;
+  counters_.tiles_y = (v_res + tile_size - 1) / tile_size;
+  counters_.tiles.assign(kCounters * counters_.tiles_x * counters_.tiles_y,
+                         0);
+}
+
+RedrawHeatmap::~RedrawHeatmap() {
+  if (active_ == this) {
+    active_ = nullptr;
+  }
+  if (disp_) {
+    lv_display_remove_event_cb_with_user_data(disp_, event_cb, this);
+  }
+}
+
+void RedrawHeatmap::attach(lv_display_t* disp) {
+  disp_ = disp;
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_ALL, this);
+
+  if (!unit_) {
+    unit_ = static_cast<lv_draw_unit_t*>(
+        lv_draw_create_unit(sizeof(lv_draw_unit_t)));
+    unit_->evaluate_cb = evaluate_cb;
+    unit_->dispatch_cb = dispatch_cb;
+    unit_->name = "HEATMAP";
+  }
+  active_ = this;
+
+  ESP_LOGI(TAG, "Accumulating %dx%d tiles of %d px", counters_.tiles_x,
+           counters_.tiles_y, counters_.tile_size);
+}
+
+void RedrawHeatmap::reset() {
+  std::fill(counters_.tiles.begin(), counters_.tiles.end(), 0);
+  std::fill(std::begin(counters_.totals), std::end(counters_.totals), 0);
+  counters_.offscreen_px = 0;
+  counters_.frames = 0;
+}
+
+RedrawHeatmap::Report RedrawHeatmap::report() const { return counters_; }
+
+void RedrawHeatmap::event_cb(lv_event_t* e) {
+  auto* self = static_cast<RedrawHeatmap*>(lv_event_get_user_data(e));
+  auto* area = static_cast<const lv_area_t*>(lv_event_get_param(e));
+
+  switch (lv_event_get_code(e)) {
+    case LV_EVENT_INVALIDATE_AREA:
+      if (area) {
+        self->add_area(Counter::Invalidated, area->x1, area->y1, area->x2,
+                       area->y2);
+      }
+      break;
+    case LV_EVENT_FLUSH_START:
+      if (area) {
+        self->add_area(Counter::Flushed, area->x1, area->y1, area->x2,
+                       area->y2);
+        self->frame_flushed_ = true;
+      }
+      break;
+    case LV_EVENT_REFR_READY:
+      if (self->frame_flushed_) {
+        self->counters_.frames++;
+        self->frame_flushed_ = false;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+int32_t RedrawHeatmap::evaluate_cb(lv_draw_unit_t* unit,
+                                   lv_draw_task_t* task) {
+  (void)unit;
+  if (active_) {
+    active_->on_draw_task(task);
+  }
+  // Leave preference_score and preferred_draw_unit_id to the real units.
+  return 0;
+}
+
+int32_t RedrawHeatmap::dispatch_cb(lv_draw_unit_t* unit, lv_layer_t* layer) {
+  (void)unit;
+  (void)layer;
+  return LV_DRAW_UNIT_IDLE;
+}
+
+void RedrawHeatmap::on_draw_task(const lv_draw_task_t* task) {
+  lv_area_t covered;
+  if (!lv_area_intersect(&covered, &task->area, &task->clip_area)) {
+    return;
+  }
+  const lv_layer_t* layer = task->target_layer;
+  if (!disp_ || lv_refr_get_disp_refreshing() != disp_ || !layer ||
+      layer->parent) {
+    // An intermediate layer (transform, opacity, snapshot...) or another
+    // display.
+    counters_.offscreen_px += lv_area_get_size(&covered);
+    return;
+  }
+  add_area(Counter::Blended, covered.x1, covered.y1, covered.x2,
+           covered.y2);
+}
+
+void RedrawHeatmap::add_area(Counter counter, int32_t x1, int32_t y1,
+                             int32_t x2, int32_t y2) {
+  x1 = std::max<int32_t>(x1, 0);
+  y1 = std::max<int32_t>(y1, 0);
+  x2 = std::min<int32_t>(x2, h_res_ - 1);
+  y2 = std::min<int32_t>(y2, v_res_ - 1);
+  if (x2 < x1 || y2 < y1) {
+    return;
+  }
+
+  // Split the area over the tiles it overlaps.
+  const int ts = counters_.tile_size;
+  for (int ty = y1 / ts; ty <= y2 / ts; ty++) {
+    const int32_t cy1 = std::max<int32_t>(y1, ty * ts);
+    const int32_t cy2 = std::min<int32_t>(y2, ty * ts + ts - 1);
+    for (int tx = x1 / ts; tx <= x2 / ts; tx++) {
+      const int32_t cx1 = std::max<int32_t>(x1, tx * ts);
+      const int32_t cx2 = std::min<int32_t>(x2, tx * ts + ts - 1);
+      counters_.tiles[((size_t)counter * counters_.tiles_y + ty) *
+                          counters_.tiles_x +
+                      tx] += (cx2 - cx1 + 1) * (cy2 - cy1 + 1);
+    }
+  }
+  counters_.totals[(size_t)counter] +=
+      (uint64_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+}
+
+void RedrawHeatmap::Report::dump_console() const {
+  const uint32_t n = frames ? frames : 1;
+  ESP_LOGI(TAG, "Heatmap over %u frames (tile %d px):", (unsigned)frames,
+           tile_size);
+  for (size_t c = 0; c < kCounters; c++) {
+    ESP_LOGI(TAG, "  %-11s %10llu px total, %8llu px/frame", kCounterNames[c],
+             (unsigned long long)totals[c],
+             (unsigned long long)(totals[c] / n));
+  }
+  const uint64_t flushed = totals[(size_t)Counter::Flushed];
+  if (flushed) {
+    ESP_LOGI(TAG, "  overdraw    %.2fx (blended / flushed)",
+             (double)totals[(size_t)Counter::Blended] / flushed);
+  }
+  ESP_LOGI(TAG, "  offscreen   %10llu px drawn into layers",
+           (unsigned long long)offscreen_px);
+
+  // Ten-step ramp, normalised per counter to its hottest tile.
+  static const char kRamp[] = " .:-=+*#%@";
+  std::vector<char> line(tiles_x + 1, '\0');
+  for (size_t c = 0; c < kCounters; c++) {
+    uint32_t max = 1;
+    for (int ty = 0; ty < tiles_y; ty++) {
+      for (int tx = 0; tx < tiles_x; tx++) {
+        max = std::max(max, at((Counter)c, tx, ty));
+      }
+    }
+    ESP_LOGI(TAG, "%s (max %u px/tile/frame):", kCounterNames[c],
+             (unsigned)(max / n));
+    for (int ty = 0; ty < tiles_y; ty++) {
+      for (int tx = 0; tx < tiles_x; tx++) {
+        line[tx] = kRamp[(uint64_t)at((Counter)c, tx, ty) * 9 / max];
+      }
+      ESP_LOGI(TAG, "|%s|", line.data());
+    }
+  }
+}
+
+bool RedrawHeatmap::Report::write_ppm(const char* path, int scale) const {
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    ESP_LOGE(TAG, "Cannot open %s", path);
+    return false;
+  }
+
+  // Three panels side by side with a one-tile gap.
+  const int panel_w = tiles_x * scale;
+  const int width = panel_w * (int)kCounters + scale * ((int)kCounters - 1);
+  const int height = tiles_y * scale;
+  fprintf(f, "P6\n%d %d\n255\n", width, height);
+
+  uint32_t max[kCounters];
+  for (size_t c = 0; c < kCounters; c++) {
+    max[c] = 1;
+    for (int ty = 0; ty < tiles_y; ty++) {
+      for (int tx = 0; tx < tiles_x; tx++) {
+        max[c] = std::max(max[c], at((Counter)c, tx, ty));
+      }
+    }
+  }
+
+  std::vector<uint8_t> row(width * 3);
+  for (int y = 0; y < height; y++) {
+    std::fill(row.begin(), row.end(), 0x20);
+    for (size_t c = 0; c < kCounters; c++) {
+      for (int x = 0; x < panel_w; x++) {
+        // Blue (cold) to red (hot).
+        const uint32_t v =
+            (uint64_t)at((Counter)c, x / scale, y / scale) * 255 / max[c];
+        uint8_t* px = &row[((int)c * (panel_w + scale) + x) * 3];
+        px[0] = (uint8_t)v;
+        px[1] = (uint8_t)(v < 128 ? v * 2 : (255 - v) * 2);
+        px[2] = (uint8_t)(255 - v);
+      }
+    }
+    fwrite(row.data(), 1, row.size(), f);
+  }
+
+  fclose(f);
+  ESP_LOGI(TAG, "Wrote %s (%dx%d)", path, width, height);
+  return true;
+}
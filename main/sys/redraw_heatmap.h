@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "lvgl.h"
+
+/**
+ * REDRAW HEATMAP
+ * --------------
+ * Instrumentation mode that answers "which parts of the screen cost us
+ * pixels?". The screen is split into square tiles and three counters are
+ * accumulated per tile:
+ *
+ *   - Invalidated: areas LVGL marked dirty (LV_EVENT_INVALIDATE_AREA).
+ *   - Blended:     pixels covered by draw tasks (fills, images, labels,
+ *                  borders...), whichever draw unit or blend routine ends
+ *                  up rendering them. A pixel that is drawn twice
+ *                  (background + image) counts twice, so Blended / Flushed
+ *                  is the overdraw factor.
+ *   - Flushed:     pixels handed to the panel (LV_EVENT_FLUSH_START).
+ *
+ * Draws into intermediate layers (e.g. the rotated whale) are reported as a
+ * single "offscreen" total; the layer's own blend onto the screen is counted
+ * like any other image.
+ */
+class RedrawHeatmap {
+ public:
+  enum class Counter : uint8_t { Invalidated = 0, Blended, Flushed, Count };
+  static constexpr size_t kCounters = (size_t)Counter::Count;
+
+  /**
+   * A copy of the counters that can be printed without the LVGL lock.
+   */
+  struct Report {
+    int tile_size = 0;
+    int tiles_x = 0;
+    int tiles_y = 0;
+    std::vector<uint32_t> tiles;  // [counter][ty][tx]
+    uint64_t totals[kCounters] = {};
+    uint64_t offscreen_px = 0;
+    uint32_t frames = 0;
+
+    uint32_t at(Counter c, int tx, int ty) const {
+      return tiles[((size_t)c * tiles_y + ty) * tiles_x + tx];
+    }
+
+    /** Print one ASCII heatmap per counter plus totals. */
+    void dump_console() const;
+
+    /**
+     * Write the three heatmaps side by side as a binary PPM image (one
+     * block of `scale` x `scale` pixels per tile).
+     * @return True if the file was written.
+     */
+    bool write_ppm(const char* path, int scale = 8) const;
+  };
+
+  RedrawHeatmap(int h_res, int v_res, int tile_size);
+  ~RedrawHeatmap();
+
+  RedrawHeatmap(const RedrawHeatmap&) = delete;
+  RedrawHeatmap& operator=(const RedrawHeatmap&) = delete;
+
+  /**
+   * Subscribe to the display's events and start observing draw tasks. Call
+   * with the LVGL lock held. Only one heatmap observes draw tasks at a time.
+   */
+  void attach(lv_display_t* disp);
+
+  /** Frames accumulated since the last reset(). */
+  uint32_t frames() const { return counters_.frames; }
+
+  /** Copy the counters. Call with the LVGL lock held. */
+  Report report() const;
+
+  /** Clear all counters. Call with the LVGL lock held. */
+  void reset();
+
+ private:
+  static void event_cb(lv_event_t* e);
+  static int32_t evaluate_cb(lv_draw_unit_t* unit, lv_draw_task_t* task);
+  static int32_t dispatch_cb(lv_draw_unit_t* unit, lv_layer_t* layer);
+  void on_draw_task(const lv_draw_task_t* task);
+  void add_area(Counter counter, int32_t x1, int32_t y1, int32_t x2,
+                int32_t y2);
+
+  // Draw units cannot be removed again: one passive unit per program, bound
+  // to the attached heatmap.
+  static lv_draw_unit_t* unit_;
+  static RedrawHeatmap* active_;
+
+  int h_res_;
+  int v_res_;
+  Report counters_;
+  bool frame_flushed_ = false;
+
+  lv_display_t* disp_ = nullptr;
+};
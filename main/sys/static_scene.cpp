@@ -0,0 +1,238 @@
+#include "sys/static_scene.h"
+
+#include "esp_log.h"
+#include "sys/telemetry.h"
+
+static const char* TAG = "StaticScene";
+
+StaticScene::StaticScene(const Config& config, SleepHandler sleep_handler,
+                         WakeHandler wake_handler,
+                         SleepRequestHandler sleep_request_handler)
+    : config_(config),
+      sleep_handler_(std::move(sleep_handler)),
+      wake_handler_(std::move(wake_handler)),
+      sleep_request_handler_(std::move(sleep_request_handler)) {}
+
+StaticScene::~StaticScene() {
+  if (sleep_timer_) {
+    esp_timer_stop(sleep_timer_);
+    esp_timer_delete(sleep_timer_);
+  }
+  if (state_mutex_) {
+    vSemaphoreDelete(state_mutex_);
+  }
+}
+
+bool StaticScene::init() {
+  if (config_.idle_frames == 0) {
+    return false;
+  }
+  state_mutex_ = xSemaphoreCreateMutex();
+  if (!state_mutex_) {
+    return false;
+  }
+  if (config_.sleep_ms > 0) {
+    esp_timer_create_args_t args = {};
+    args.callback = sleep_timer_cb;
+    args.arg = this;
+    args.name = "scene_sleep";
+    if (esp_timer_create(&args, &sleep_timer_) != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to create sleep timer");
+      return false;
+    }
+  }
+  ESP_LOGI(TAG, "Suspend after %u idle passes, panel sleep after %u ms",
+           (unsigned)config_.idle_frames, (unsigned)config_.sleep_ms);
+  return true;
+}
+
+void StaticScene::attach(lv_display_t* disp, lv_indev_t* indev) {
+  if (!state_mutex_ || !disp) {
+    return;
+  }
+  disp_ = disp;
+  refr_timer_ = lv_display_get_refr_timer(disp);
+  indev_ = indev;
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_INVALIDATE_AREA, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_REFR_START, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_FLUSH_START, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_REFR_READY, this);
+}
+
+void StaticScene::set_refresh_timer(lv_timer_t* timer,
+                                    SuspendHandler suspend_handler,
+                                    PeriodHandler period_handler) {
+  refr_timer_ = timer;
+  suspend_handler_ = std::move(suspend_handler);
+  period_handler_ = std::move(period_handler);
+}
+
+void StaticScene::observe(lv_display_t* disp) {
+  if (!state_mutex_ || !disp) {
+    return;
+  }
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_INVALIDATE_AREA, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_REFR_START, this);
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_FLUSH_START, this);
+}
+
+void StaticScene::event_cb(lv_event_t* e) {
+  auto* self = static_cast<StaticScene*>(lv_event_get_user_data(e));
+  switch (lv_event_get_code(e)) {
+    case LV_EVENT_INVALIDATE_AREA:
+      // Whoever invalidates holds the LVGL lock, so resuming here is safe.
+      self->pass_active_ = true;
+      self->wake();
+      break;
+    case LV_EVENT_REFR_START:
+      self->on_refr_start(
+          static_cast<lv_display_t*>(lv_event_get_target(e)));
+      break;
+    case LV_EVENT_FLUSH_START:
+      self->pass_active_ = true;
+      break;
+    case LV_EVENT_REFR_READY:
+      self->on_refr_ready();
+      break;
+    default:
+      break;
+  }
+}
+
+void StaticScene::on_refr_start(lv_display_t* disp) {
+  // The first refresh after a wake, on the LVGL task and before anything
+  // is flushed: bring the panel back.
+  if (panel_wake_pending_) {
+    panel_wake_pending_ = false;
+    if (sleep_handler_) {
+      sleep_handler_(false);
+    }
+  }
+  if (disp == disp_) {
+    pass_active_ = false;
+  }
+}
+
+void StaticScene::on_refr_ready() {
+  const bool pressed =
+      indev_ && lv_indev_get_state(indev_) == LV_INDEV_STATE_PRESSED;
+  if (pass_active_ || pressed || lv_anim_count_running() > 0) {
+    idle_passes_ = 0;
+    return;
+  }
+  if (++idle_passes_ >= config_.idle_frames && state_ == State::Awake) {
+    suspend();
+  }
+}
+
+void StaticScene::suspend() {
+  // 1. Stop the refresh loop (and input polling if touch can wake us).
+  lv_timer_pause(refr_timer_);
+  if (suspend_handler_) {
+    suspend_handler_(true);
+  }
+  if (indev_ && input_wakeup_) {
+    lv_timer_pause(lv_indev_get_read_timer(indev_));
+  }
+  const uint32_t period_us = period_handler_ ? period_handler_() : 0;
+
+  xSemaphoreTake(state_mutex_, portMAX_DELAY);
+  state_ = State::Suspended;
+  suspended_at_us_ = esp_timer_get_time();
+  skip_period_us_ = period_us > 0 ? period_us : config_.refr_period_ms * 1000;
+  stats_.suspends++;
+  xSemaphoreGive(state_mutex_);
+  suspend_seq_++;
+
+  // 2. Arm the panel sleep timeout.
+  if (sleep_timer_) {
+    esp_timer_start_once(sleep_timer_, (uint64_t)config_.sleep_ms * 1000);
+  }
+}
+
+void StaticScene::wake() {
+  if (state_ == State::Awake) {
+    return;
+  }
+
+  if (sleep_timer_) {
+    esp_timer_stop(sleep_timer_);
+  }
+  // wake() runs on whichever task invalidated; leave the SPI traffic to
+  // the LVGL task.
+  if (state_ == State::PanelAsleep) {
+    panel_wake_pending_ = true;
+  }
+
+  xSemaphoreTake(state_mutex_, portMAX_DELAY);
+  const int64_t asleep_us = esp_timer_get_time() - suspended_at_us_;
+  stats_.asleep_us += asleep_us;
+  stats_.frames_skipped += asleep_us / skip_period_us_;
+  state_ = State::Awake;
+  xSemaphoreGive(state_mutex_);
+
+  if (suspend_handler_) {
+    suspend_handler_(false);
+  }
+  lv_timer_resume(refr_timer_);
+  if (indev_) {
+    lv_timer_resume(lv_indev_get_read_timer(indev_));
+  }
+  idle_passes_ = 0;
+
+  if (wake_handler_) {
+    wake_handler_();
+  }
+}
+
+void StaticScene::sleep_timer_cb(void* arg) {
+  // Runs in the esp_timer task, without the LVGL lock: only note which
+  // suspension timed out and ask for sleep_panel().
+  auto* self = static_cast<StaticScene*>(arg);
+  self->sleep_due_seq_ = self->suspend_seq_.load();
+  if (self->sleep_request_handler_) {
+    self->sleep_request_handler_();
+  }
+}
+
+void StaticScene::sleep_panel() {
+  // A wake (and maybe a new suspension) may have come in while the request
+  // was on its way.
+  if (state_ != State::Suspended || sleep_due_seq_ != suspend_seq_) {
+    return;
+  }
+  if (sleep_handler_) {
+    sleep_handler_(true);
+  }
+  xSemaphoreTake(state_mutex_, portMAX_DELAY);
+  state_ = State::PanelAsleep;
+  stats_.panel_sleeps++;
+  xSemaphoreGive(state_mutex_);
+}
+
+StaticScene::Stats StaticScene::stats() const {
+  xSemaphoreTake(state_mutex_, portMAX_DELAY);
+  Stats stats = stats_;
+  if (state_ != State::Awake) {
+    const int64_t asleep_us = esp_timer_get_time() - suspended_at_us_;
+    stats.asleep_us += asleep_us;
+    stats.frames_skipped += asleep_us / skip_period_us_;
+  }
+  xSemaphoreGive(state_mutex_);
+  return stats;
+}
+
+void StaticScene::report() const {
+  Stats s = stats();
+  ESP_LOGI(TAG,
+           "%u suspends, %u panel sleeps, %llu frames skipped, asleep "
+           "%.1f s",
+           (unsigned)s.suspends, (unsigned)s.panel_sleeps,
+           (unsigned long long)s.frames_skipped, s.asleep_us / 1e6f);
+  Telemetry::emit("idle",
+                  "suspends=%u panel_sleeps=%u frames_skipped=%llu "
+                  "asleep_us=%llu",
+                  (unsigned)s.suspends, (unsigned)s.panel_sleeps,
+                  (unsigned long long)s.frames_skipped,
+                  (unsigned long long)s.asleep_us);
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lvgl.h"
+
+/**
+ * STATIC SCENE DETECTION
+ * ----------------------
+ * A scene without animations (the hummingbird) still wakes the LVGL task
+ * every refresh period just to find nothing to draw. After a few refresh
+ * passes with no flush, no running animation, no pressed pointer and no new
+ * invalidation, this monitor pauses the display's refresh timer and, when
+ * the touch controller can wake us by interrupt, the input read timer too:
+ * lv_timer_handler() then has nothing to run and the task sleeps until an
+ * event arrives.
+ *
+ * Any invalidation (LV_EVENT_INVALIDATE_AREA) or wake() resumes rendering.
+ * Optionally, after sleep_ms of stillness the sleep handler is called to
+ * turn the backlight off and put the panel to sleep.
+ *
+ * The panel is only ever touched from the LVGL task: the sleep timeout asks
+ * for sleep_panel() through the sleep request handler, and a wake defers
+ * the panel wake-up to the start of the next refresh.
+ */
+class StaticScene {
+ public:
+  struct Config {
+    uint32_t idle_frames = 3;      // Idle refresh passes before suspending.
+    uint32_t refr_period_ms = 16;  // Counts skipped frames (unpaced).
+    uint32_t sleep_ms = 0;         // Panel sleep timeout (0 = never).
+  };
+
+  struct Stats {
+    uint32_t suspends = 0;
+    uint32_t panel_sleeps = 0;
+    uint64_t frames_skipped = 0;
+    uint64_t asleep_us = 0;  // Time spent suspended.
+  };
+
+  /**
+   * Called with true to sleep the panel, false to wake it, on the LVGL task
+   * with the lock held.
+   */
+  using SleepHandler = std::function<void(bool asleep)>;
+  /** Called after rendering resumed, e.g. to kick the LVGL task. */
+  using WakeHandler = std::function<void()>;
+  /**
+   * Called from the sleep timer (esp_timer task) when the timeout expires;
+   * must get sleep_panel() called on the LVGL task.
+   */
+  using SleepRequestHandler = std::function<void()>;
+  /**
+   * Called with true once rendering is suspended and with false before it
+   * resumes, on the LVGL task with the lock held.
+   */
+  using SuspendHandler = std::function<void(bool suspended)>;
+  /** Returns the refresh period in microseconds. */
+  using PeriodHandler = std::function<uint32_t()>;
+
+  StaticScene(const Config& config, SleepHandler sleep_handler,
+              WakeHandler wake_handler,
+              SleepRequestHandler sleep_request_handler);
+  ~StaticScene();
+
+  StaticScene(const StaticScene&) = delete;
+  StaticScene& operator=(const StaticScene&) = delete;
+
+  /**
+   * Create the sleep timer and its mutex.
+   * @return True if the monitor is ready to use.
+   */
+  bool init();
+
+  /**
+   * Subscribe to the display's events. Call with the LVGL lock held.
+   * @param indev Input device whose read timer may be paused, or nullptr.
+   */
+  void attach(lv_display_t* disp, lv_indev_t* indev);
+
+  /**
+   * Also resume on invalidations of another display. Call with the LVGL
+   * lock held.
+   */
+  void observe(lv_display_t* disp);
+
+  /**
+   * Pause this timer instead of the display's own refresh timer, e.g. when
+   * one timer refreshes several displays. If something else drives it (the
+   * frame pacer's slots), `suspend_handler` stops and restarts that too,
+   * and skipped frames are counted at the period `period_handler` reports
+   * when a suspension starts instead of Config::refr_period_ms. Call with
+   * the LVGL lock held.
+   */
+  void set_refresh_timer(lv_timer_t* timer,
+                         SuspendHandler suspend_handler = nullptr,
+                         PeriodHandler period_handler = nullptr);
+
+  /**
+   * Allow pausing the input read timer while suspended. Only enable this
+   * when an interrupt calls wake() on touch. Call with the LVGL lock held.
+   */
+  void set_input_wakeup(bool enabled) { input_wakeup_ = enabled; }
+
+  /**
+   * Resume rendering; a sleeping panel wakes when the next refresh starts.
+   * Call with the LVGL lock held.
+   */
+  void wake();
+
+  /**
+   * Put the panel to sleep if the scene is still in the suspension the
+   * sleep timeout was armed for. Call on the LVGL task with the lock held.
+   */
+  void sleep_panel();
+
+  bool suspended() const { return state_ != State::Awake; }
+
+  /** Counters including the sleep currently in progress. */
+  Stats stats() const;
+
+  /** Log and emit a `TLM idle` record with the counters. */
+  void report() const;
+
+ private:
+  enum class State : uint8_t { Awake, Suspended, PanelAsleep };
+
+  static void event_cb(lv_event_t* e);
+  static void sleep_timer_cb(void* arg);
+  void on_refr_start(lv_display_t* disp);
+  void on_refr_ready();
+  void suspend();
+
+  Config config_;
+  SleepHandler sleep_handler_;
+  WakeHandler wake_handler_;
+  SleepRequestHandler sleep_request_handler_;
+  SuspendHandler suspend_handler_;
+  PeriodHandler period_handler_;
+
+  lv_display_t* disp_ = nullptr;
+  lv_timer_t* refr_timer_ = nullptr;
+  lv_indev_t* indev_ = nullptr;
+  bool input_wakeup_ = false;
+
+  // Idle detection and the pending panel wake (LVGL lock held).
+  uint32_t idle_passes_ = 0;
+  bool pass_active_ = false;
+  bool panel_wake_pending_ = false;
+
+  // Changed with the LVGL lock held; state_mutex_ keeps stats() (any task)
+  // consistent with them.
+  volatile State state_ = State::Awake;
+  SemaphoreHandle_t state_mutex_ = nullptr;
+  int64_t suspended_at_us_ = 0;
+  uint32_t skip_period_us_ = 0;  // Refresh period of this suspension.
+  Stats stats_;
+
+  // The sleep timer only records which suspension it expired in.
+  esp_timer_handle_t sleep_timer_ = nullptr;
+  std::atomic<uint32_t> suspend_seq_{0};
+  std::atomic<uint32_t> sleep_due_seq_{0};
+};
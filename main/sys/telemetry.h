@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstdio>
+
+/**
+ * TELEMETRY CHANNEL
+ * -----------------
+ * Machine-readable records printed on the console next to the human logs.
+ * Every record is a single line:
+ *
+ *     TLM <kind> key=value key=value ...
+ *
+ * The "TLM " prefix is printed without the ESP_LOG colour/timestamp
+ * decoration so that host-side scripts (pytest, sweep tools) can grep for it
+ * with a trivial regular expression.
+ */
+namespace Telemetry {
+
+__attribute__((format(printf, 2, 3))) inline void emit(const char* kind,
+                                                      const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  flockfile(stdout);
+  printf("TLM %s ", kind);
+  vprintf(fmt, args);
+  putchar('\n');
+  funlockfile(stdout);
+  fflush(stdout);
+  va_end(args);
+}
+
+}  // namespace Telemetry
@@ -0,0 +1,56 @@
+#pragma once
+
+/**
+ * FREERTOS TRACE HOOKS
+ * --------------------
+ * Force-included into FreeRTOS's own sources when WORKSHOP_TRACE or
+ * WORKSHOP_CPU_MONITOR is on (see the project CMakeLists.txt), so tasks.c
+ * picks these definitions up instead of its empty defaults. Plain C: it is
+ * compiled as part of the kernel.
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_WORKSHOP_TRACE || CONFIG_WORKSHOP_CPU_MONITOR
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void workshop_trace_task_switched_in(void);
+void workshop_trace_task_switched_out(void);
+void workshop_cpu_task_switched_in(void);
+void workshop_cpu_task_switched_out(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if CONFIG_WORKSHOP_TRACE
+#define WORKSHOP_TRACE_SWITCHED_IN() workshop_trace_task_switched_in()
+#define WORKSHOP_TRACE_SWITCHED_OUT() workshop_trace_task_switched_out()
+#else
+#define WORKSHOP_TRACE_SWITCHED_IN()
+#define WORKSHOP_TRACE_SWITCHED_OUT()
+#endif
+
+#if CONFIG_WORKSHOP_CPU_MONITOR
+#define WORKSHOP_CPU_SWITCHED_IN() workshop_cpu_task_switched_in()
+#define WORKSHOP_CPU_SWITCHED_OUT() workshop_cpu_task_switched_out()
+#else
+#define WORKSHOP_CPU_SWITCHED_IN()
+#define WORKSHOP_CPU_SWITCHED_OUT()
+#endif
+
+#define traceTASK_SWITCHED_IN()   \
+  do {                            \
+    WORKSHOP_TRACE_SWITCHED_IN(); \
+    WORKSHOP_CPU_SWITCHED_IN();   \
+  } while (0)
+#define traceTASK_SWITCHED_OUT()   \
+  do {                             \
+    WORKSHOP_TRACE_SWITCHED_OUT(); \
+    WORKSHOP_CPU_SWITCHED_OUT();   \
+  } while (0)
+
+#endif  // CONFIG_WORKSHOP_TRACE || CONFIG_WORKSHOP_CPU_MONITOR
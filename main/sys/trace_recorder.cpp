@@ -0,0 +1,235 @@
+#include "sys/trace_recorder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "sys/telemetry.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_private/cache_utils.h"
+#endif
+
+static const char* TAG = "TraceRecorder";
+
+/**
+ * EVENT TRACE RECORDER: Implementation
+ * ------------------------------------
+ * Writers claim a slot with one atomic increment and fill it; no lock is
+ * taken, so the scheduler, ISRs and both cores can log at once. Slots past
+ * the capacity are not written, which makes "dropped" simply the number of
+ * claims beyond it.
+ *
+ * Task switches also happen while a flash operation has the cache (and
+ * with it PSRAM) disabled; those events are skipped before the task is
+ * even looked up.
+ *
+ * Tasks get small ids the first time they are switched in, and the name
+ * is copied right away, so tasks deleted before the dump keep theirs. Two
+ * cores registering the same task at once may give it two ids; both carry
+ * its name.
+ */
+
+static const char* const kSpanNames[TraceRecorder::kSpanCount] = {
+    "refresh", "render", "flush_wait", "flush_cb", "flush_ready_isr",
+    "touch_read", "snapshot", "rebuild",
+};
+
+namespace {
+
+// False while a flash operation has the cache disabled.
+inline bool IRAM_ATTR cache_enabled() {
+#if CONFIG_IDF_TARGET_LINUX
+  return true;
+#else
+  return spi_flash_cache_enabled();
+#endif
+}
+
+}  // namespace
+
+TraceRecorder::Event* TraceRecorder::events_ = nullptr;
+size_t TraceRecorder::capacity_ = 0;
+std::atomic<bool> TraceRecorder::recording_{false};
+std::atomic<uint32_t> TraceRecorder::next_{0};
+int64_t TraceRecorder::start_us_ = 0;
+TraceRecorder::Task TraceRecorder::tasks_[kMaxTasks] = {};
+std::atomic<uint32_t> TraceRecorder::task_count_{0};
+
+extern "C" void IRAM_ATTR workshop_trace_task_switched_in(void) {
+  TraceRecorder::record_task(TraceRecorder::kTaskIn,
+                             xTaskGetCurrentTaskHandle());
+}
+
+extern "C" void IRAM_ATTR workshop_trace_task_switched_out(void) {
+  TraceRecorder::record_task(TraceRecorder::kTaskOut,
+                             xTaskGetCurrentTaskHandle());
+}
+
+bool TraceRecorder::init(size_t capacity) {
+  if (events_ || capacity == 0) {
+    return events_ != nullptr;
+  }
+  const size_t bytes = capacity * sizeof(Event);
+  events_ = static_cast<Event*>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM));
+  if (!events_) {
+    ESP_LOGW(TAG, "No PSRAM for %u events, using internal RAM",
+             (unsigned)capacity);
+    events_ = static_cast<Event*>(heap_caps_malloc(bytes, MALLOC_CAP_DEFAULT));
+  }
+  if (!events_) {
+    ESP_LOGE(TAG, "Failed to allocate the trace buffer");
+    return false;
+  }
+  capacity_ = capacity;
+  ESP_LOGI(TAG, "Trace buffer: %u events (%u KB)", (unsigned)capacity,
+           (unsigned)(bytes / 1024));
+  return true;
+}
+
+void TraceRecorder::attach(lv_display_t* disp, bool flush_cb) {
+  if (!events_ || !disp) {
+    return;
+  }
+  lv_display_add_event_cb(disp, event_cb, LV_EVENT_ALL, nullptr);
+  if (flush_cb) {
+    // LVGL sends these right around its call of the flush callback.
+    lv_display_add_event_cb(disp, flush_event_cb, LV_EVENT_FLUSH_START,
+                            nullptr);
+    lv_display_add_event_cb(disp, flush_event_cb, LV_EVENT_FLUSH_FINISH,
+                            nullptr);
+  }
+}
+
+void TraceRecorder::event_cb(lv_event_t* e) {
+  switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+      record(kBegin, kRefresh);
+      break;
+    case LV_EVENT_REFR_READY:
+      record(kEnd, kRefresh);
+      break;
+    case LV_EVENT_RENDER_START:
+      record(kBegin, kRender);
+      break;
+    case LV_EVENT_RENDER_READY:
+      record(kEnd, kRender);
+      break;
+    case LV_EVENT_FLUSH_WAIT_START:
+      record(kBegin, kFlushWait);
+      break;
+    case LV_EVENT_FLUSH_WAIT_FINISH:
+      record(kEnd, kFlushWait);
+      break;
+    default:
+      break;
+  }
+}
+
+void TraceRecorder::flush_event_cb(lv_event_t* e) {
+  record(lv_event_get_code(e) == LV_EVENT_FLUSH_START ? kBegin : kEnd,
+         kFlushCb);
+}
+
+void TraceRecorder::start() {
+  if (!events_) {
+    return;
+  }
+  recording_ = false;
+  start_us_ = esp_timer_get_time();
+  next_ = 0;
+  recording_ = true;
+}
+
+void TraceRecorder::stop() { recording_ = false; }
+
+void IRAM_ATTR TraceRecorder::record(Type type, uint16_t arg) {
+  if (!recording_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  if (!cache_enabled()) {
+    return;
+  }
+#if CONFIG_IDF_TARGET_LINUX
+  const uint8_t core = 0;
+#else
+  const uint8_t core = (uint8_t)esp_cpu_get_core_id();
+#endif
+  const uint32_t slot = next_.fetch_add(1, std::memory_order_relaxed);
+  if (slot < capacity_) {
+    events_[slot] = {(uint32_t)(esp_timer_get_time() - start_us_), arg,
+                     (uint8_t)type, core};
+  }
+}
+
+void IRAM_ATTR TraceRecorder::record_task(Type type, TaskHandle_t task) {
+  // task_id() looks the task up and may copy its name: not with the cache
+  // off either.
+  if (recording_.load(std::memory_order_relaxed) && cache_enabled()) {
+    record(type, task_id(task));
+  }
+}
+
+uint16_t IRAM_ATTR TraceRecorder::task_id(TaskHandle_t task) {
+  const uint32_t known = std::min(task_count_.load(), kMaxTasks);
+  for (uint32_t i = 0; i < known; i++) {
+    if (tasks_[i].handle == task) {
+      return (uint16_t)i;
+    }
+  }
+  const uint32_t id = task_count_.fetch_add(1);
+  if (id >= kMaxTasks) {
+    return kUnknownTask;
+  }
+  const char* name = pcTaskGetName(task);
+  size_t i = 0;
+  for (; i + 1 < sizeof(tasks_[id].name) && name[i]; i++) {
+    tasks_[id].name[i] = name[i];
+  }
+  tasks_[id].name[i] = '\0';
+  tasks_[id].handle = task;
+  return (uint16_t)id;
+}
+
+void TraceRecorder::dump() {
+  if (!events_) {
+    return;
+  }
+  const uint32_t claimed = next_.load();
+  const uint32_t count = std::min<uint32_t>(claimed, capacity_);
+  const uint32_t tasks = std::min(task_count_.load(), kMaxTasks);
+
+  char spans[128] = "";
+  for (int i = 0; i < kSpanCount; i++) {
+    strlcat(spans, i ? "," : "", sizeof(spans));
+    strlcat(spans, kSpanNames[i], sizeof(spans));
+  }
+  Telemetry::emit("trace_start",
+                  "version=1 events=%u dropped=%u tasks=%u event_bytes=%u "
+                  "spans=%s",
+                  (unsigned)count, (unsigned)(claimed - count),
+                  (unsigned)tasks, (unsigned)sizeof(Event), spans);
+  for (uint32_t i = 0; i < tasks; i++) {
+    Telemetry::emit("trace_task", "id=%u name=%s", (unsigned)i,
+                    tasks_[i].name);
+  }
+
+  // 64 events (1 KB of hex) per line.
+  static constexpr uint32_t kPerLine = 64;
+  static const char kHex[] = "0123456789abcdef";
+  char hex[kPerLine * sizeof(Event) * 2 + 1];
+  for (uint32_t first = 0; first < count; first += kPerLine) {
+    const uint32_t n = std::min(kPerLine, count - first);
+    const auto* bytes = reinterpret_cast<const uint8_t*>(events_ + first);
+    for (size_t b = 0; b < n * sizeof(Event); b++) {
+      hex[2 * b] = kHex[bytes[b] >> 4];
+      hex[2 * b + 1] = kHex[bytes[b] & 0xF];
+    }
+    hex[n * sizeof(Event) * 2] = '\0';
+    Telemetry::emit("trace_data", "index=%u hex=%s", (unsigned)first, hex);
+  }
+  Telemetry::emit("trace_end", "events=%u", (unsigned)count);
+}
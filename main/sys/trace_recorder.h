@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "lvgl.h"
+
+/**
+ * EVENT TRACE RECORDER
+ * --------------------
+ * Per-stage averages cannot show interleaving: whether the SPI done ISR,
+ * the touch read and ThorVG fight over a core. This recorder logs, with a
+ * microsecond timestamp and the core they ran on:
+ *
+ *   - FreeRTOS task switch-in / switch-out (traceTASK_SWITCHED_IN/OUT,
+ *     see sys/trace_hooks.h),
+ *   - begin / end of the flush-ready ISR, flush_cb and the touch read
+ *     (the native driver's flush_cb from display events; its flush-ready
+ *     ISR is the driver's own and is not traced),
+ *   - LVGL's refresh, render and flush-wait phases (display events),
+ *   - the snapshot and scene rebuild of a scene transition,
+ *
+ * as 8-byte events in a PSRAM buffer. A capture runs from start() until
+ * stop() or until the buffer is full (later events count as dropped), and
+ * dump() prints it as TLM trace_* records. tools/trace_to_perfetto.py
+ * turns a console log holding those records into Chrome trace JSON for
+ * ui.perfetto.dev.
+ *
+ * ESP-IDF's SystemView tracing hooks the same FreeRTOS macros; the two
+ * cannot be enabled together.
+ */
+class TraceRecorder {
+ public:
+  enum Span : uint8_t {
+    kRefresh = 0,
+    kRender,
+    kFlushWait,
+    kFlushCb,
+    kFlushReadyIsr,
+    kTouchRead,
+    kSnapshot,  // Scene transitions (WorkshopUI::transition_to()).
+    kRebuild,
+    kSpanCount
+  };
+
+  enum Type : uint8_t { kTaskIn = 0, kTaskOut, kBegin, kEnd };
+
+  struct Event {
+    uint32_t ts_us;  // Since start().
+    uint16_t arg;    // Task id (see dump()) or Span.
+    uint8_t type;    // Type.
+    uint8_t core;
+  };
+  static_assert(sizeof(Event) == 8, "events are packed 8 bytes");
+
+  /**
+   * Allocate room for `capacity` events (PSRAM preferred).
+   * @return True if the recorder is ready to use.
+   */
+  static bool init(size_t capacity);
+
+  /**
+   * Record the refresh phases of a display, and with `flush_cb` also its
+   * flush callback, for drivers whose flush_cb cannot log itself (the
+   * native driver). Call with the LVGL lock held.
+   */
+  static void attach(lv_display_t* disp, bool flush_cb = false);
+
+  /** Start a new capture, discarding the previous one. */
+  static void start();
+
+  /** Stop recording; the capture stays until the next start(). */
+  static void stop();
+
+  static bool ready() { return events_ != nullptr; }
+
+  /**
+   * Print the capture as TLM records: trace_start, one trace_task per
+   * task seen, trace_data lines of hex-encoded events, trace_end. Call
+   * after stop(), from a low-priority task: printing is slow.
+   */
+  static void dump();
+
+  /** Log one event. Safe from ISRs, the scheduler and both cores. */
+  static void IRAM_ATTR record(Type type, uint16_t arg);
+
+  /** Log a task switch; called from the FreeRTOS trace hooks. */
+  static void IRAM_ATTR record_task(Type type, TaskHandle_t task);
+
+  /**
+   * RAII span: begin and end of the enclosing scope.
+   */
+  class Scope {
+   public:
+    explicit Scope(Span span) : span_(span) { record(kBegin, span_); }
+    ~Scope() { record(kEnd, span_); }
+
+   private:
+    Span span_;
+  };
+
+ private:
+  static constexpr uint32_t kMaxTasks = 32;
+  static constexpr uint16_t kUnknownTask = 0xFFFF;
+
+  struct Task {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+  };
+
+  static void event_cb(lv_event_t* e);
+  static void flush_event_cb(lv_event_t* e);
+  static uint16_t IRAM_ATTR task_id(TaskHandle_t task);
+
+  static Event* events_;
+  static size_t capacity_;
+  static std::atomic<bool> recording_;
+  static std::atomic<uint32_t> next_;
+  static int64_t start_us_;
+  static Task tasks_[kMaxTasks];
+  static std::atomic<uint32_t> task_count_;
+};
@@ -0,0 +1,170 @@
+#include "ui/bitmap_cache.h"
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "BitmapCache";
+
+/**
+ * CACHE AS BITMAP: Implementation
+ * -------------------------------
+ * Hidden objects are skipped by LVGL's refresh and never invalidate, so
+ * content changes are tracked through the events LVGL sends to the
+ * changed object or its parent; every object in the subtree gets our
+ * callback, and children created later are picked up from
+ * LV_EVENT_CHILD_CREATED. The layer is outside the subtree, so animating
+ * it is invisible to the tracking by construction.
+ *
+ * Rendering happens on LV_EVENT_REFR_START, before the display lays out
+ * and redraws its invalid areas: lv_snapshot renders the source (and its
+ * extra draw area) into an ARGB8888 buffer in PSRAM. The source stays
+ * hidden throughout, as lv_snapshot draws the object it is given even when
+ * hidden, so the render never invalidates the source's area on screen.
+ * The buffer is reused while it is large enough. If a render fails, the
+ * subtree is shown as-is until its next change.
+ */
+
+namespace {
+
+template <typename Fn>
+void for_subtree(lv_obj_t* obj, Fn fn) {
+  fn(obj);
+  for (uint32_t i = 0; i < lv_obj_get_child_count(obj); i++) {
+    for_subtree(lv_obj_get_child(obj, i), fn);
+  }
+}
+
+}  // namespace
+
+BitmapCache::BitmapCache(lvgl::Object& parent, lvgl::Object& source)
+    : source_(source.raw()),
+      display_(lv_obj_get_display(source.raw())),
+      layer_(std::make_unique<lvgl::Image>(parent)) {
+  lv_obj_t* layer = layer_->raw();
+  lv_obj_move_to_index(layer, lv_obj_get_index(source_) + 1);
+  for_subtree(source_, [this](lv_obj_t* obj) { watch(obj); });
+  lv_obj_add_flag(source_, LV_OBJ_FLAG_HIDDEN);
+  lv_display_add_event_cb(display_, refresh_start_cb, LV_EVENT_REFR_START,
+                          this);
+}
+
+BitmapCache::~BitmapCache() {
+  lv_display_remove_event_cb_with_user_data(display_, refresh_start_cb,
+                                            this);
+  if (source_) {
+    for_subtree(source_, [this](lv_obj_t* obj) {
+      lv_obj_remove_event_cb_with_user_data(obj, source_event_cb, this);
+    });
+    lv_obj_remove_flag(source_, LV_OBJ_FLAG_HIDDEN);
+  }
+  layer_.reset();
+  lv_image_cache_drop(&buf_);
+  heap_caps_free(data_);
+}
+
+void BitmapCache::watch(lv_obj_t* obj) {
+  lv_obj_add_event_cb(obj, source_event_cb, LV_EVENT_ALL, this);
+}
+
+void BitmapCache::source_event_cb(lv_event_t* e) {
+  auto* self = static_cast<BitmapCache*>(lv_event_get_user_data(e));
+  if (self->rendering_) {
+    return;
+  }
+  switch (lv_event_get_code(e)) {
+    case LV_EVENT_STYLE_CHANGED:
+    case LV_EVENT_SIZE_CHANGED:
+    case LV_EVENT_REFR_EXT_DRAW_SIZE:
+    case LV_EVENT_CHILD_CHANGED:
+    case LV_EVENT_CHILD_DELETED:
+      self->dirty_ = true;
+      break;
+    case LV_EVENT_CHILD_CREATED:
+      self->watch(static_cast<lv_obj_t*>(lv_event_get_param(e)));
+      self->dirty_ = true;
+      break;
+    case LV_EVENT_DELETE:
+      if (lv_event_get_current_target(e) == self->source_) {
+        self->source_ = nullptr;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void BitmapCache::refresh_start_cb(lv_event_t* e) {
+  auto* self = static_cast<BitmapCache*>(lv_event_get_user_data(e));
+  if (self->dirty_ && self->source_) {
+    self->render();
+  }
+}
+
+void BitmapCache::render() {
+  const int64_t start_us = esp_timer_get_time();
+  lv_obj_t* layer = layer_->raw();
+  rendering_ = true;
+  dirty_ = false;
+  lv_obj_update_layout(source_);
+
+  // lv_snapshot covers the coordinates plus the extra draw area.
+  lv_area_t area;
+  lv_obj_get_coords(source_, &area);
+  const int32_t ext = lv_obj_get_ext_draw_size(source_);
+  lv_area_increase(&area, ext, ext);
+  const uint32_t w = lv_area_get_width(&area);
+  const uint32_t h = lv_area_get_height(&area);
+  const uint32_t stride =
+      lv_draw_buf_width_to_stride(w, LV_COLOR_FORMAT_ARGB8888);
+  const size_t size = (size_t)stride * h;
+
+  // The buffer is rewritten: no decoder may keep serving the old pixels.
+  lv_image_cache_drop(&buf_);
+  if (data_ && buf_.data_size < size) {
+    heap_caps_free(data_);
+    data_ = nullptr;
+  }
+  if (!data_) {
+    data_ = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, size,
+                                    MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  }
+  const bool ok =
+      data_ &&
+      lv_draw_buf_init(&buf_, w, h, LV_COLOR_FORMAT_ARGB8888, stride, data_,
+                       size) == LV_RESULT_OK &&
+      lv_snapshot_take_to_draw_buf(source_, LV_COLOR_FORMAT_ARGB8888,
+                                   &buf_) == LV_RESULT_OK;
+  if (ok && !lv_obj_has_flag(source_, LV_OBJ_FLAG_HIDDEN)) {
+    // A failed render showed it.
+    lv_obj_add_flag(source_, LV_OBJ_FLAG_HIDDEN);
+  }
+  rendering_ = false;
+  if (!ok) {
+    ESP_LOGW(TAG, "Cannot render a %ux%u layer, drawing the subtree",
+             (unsigned)w, (unsigned)h);
+    lv_obj_remove_flag(source_, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_flag(layer, LV_OBJ_FLAG_HIDDEN);
+    return;
+  }
+
+  // Place the layer over the area the snapshot covers. Its own translation
+  // is a blit transform and stays out of the position.
+  lv_image_set_src(layer, &buf_);
+  lv_obj_set_size(layer, w, h);
+  lv_obj_remove_flag(layer, LV_OBJ_FLAG_HIDDEN);
+  lv_obj_update_layout(layer);
+  lv_area_t placed;
+  lv_obj_get_coords(layer, &placed);
+  const int32_t dx = area.x1 - (placed.x1 - lv_obj_get_style_translate_x(
+                                                layer, LV_PART_MAIN));
+  const int32_t dy = area.y1 - (placed.y1 - lv_obj_get_style_translate_y(
+                                                layer, LV_PART_MAIN));
+  lv_obj_set_pos(layer, lv_obj_get_x_aligned(layer) + dx,
+                 lv_obj_get_y_aligned(layer) + dy);
+  lv_obj_invalidate(layer);
+
+  stats_.renders++;
+  stats_.render_us = (uint32_t)(esp_timer_get_time() - start_us);
+  stats_.bytes = size;
+}
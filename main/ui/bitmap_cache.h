@@ -0,0 +1,81 @@
+#pragma once
+
+#if defined(noreturn)
+#undef noreturn
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "lvgl.h"
+#include "lvgl_cpp.h"
+
+/**
+ * CACHE AS BITMAP
+ * ---------------
+ * LVGL redraws a subtree from scratch whenever its area is invalidated,
+ * even if only its position or opacity changed: the whale's bob re-runs
+ * the image pipeline for every frame of the loop. A BitmapCache renders
+ * the subtree once with lv_snapshot into a PSRAM layer and shows that
+ * layer instead; the subtree itself stays hidden.
+ *
+ * Transforms go to layer(): translation, image_opa and rotation are
+ * applied when the layer is blitted and never re-render it. The content
+ * is re-rendered, once, at the start of the next refresh after:
+ *
+ *   - a style, size or child change anywhere in the subtree,
+ *   - a change of an object's extra draw area (image rotation, scale or
+ *     source),
+ *   - invalidate(), for changes LVGL does not signal (e.g. a new image
+ *     source of the same size).
+ *
+ * This is what lvgl::Object::set_cached_as_bitmap() would do; lvgl_cpp is
+ * an external component, so it lives here and takes any lvgl::Object.
+ */
+class BitmapCache {
+ public:
+  struct Stats {
+    uint32_t renders = 0;    // Content (re-)renders so far.
+    uint32_t render_us = 0;  // Last render.
+    size_t bytes = 0;        // PSRAM held by the layer.
+  };
+
+  /**
+   * Start caching `source`, a child of `parent`. The layer is created on
+   * `parent` and rendered at the next refresh. Call with the LVGL lock
+   * held.
+   */
+  BitmapCache(lvgl::Object& parent, lvgl::Object& source);
+
+  /** Shows `source` again if it still exists. Call with the LVGL lock held. */
+  ~BitmapCache();
+
+  BitmapCache(const BitmapCache&) = delete;
+  BitmapCache& operator=(const BitmapCache&) = delete;
+
+  /**
+   * The image that stands in for the subtree: animate its translation,
+   * image_opa and rotation (pivot at its center) instead of the source's.
+   */
+  lvgl::Image& layer() { return *layer_; }
+
+  /** Re-render the content at the next refresh. */
+  void invalidate() { dirty_ = true; }
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  static void source_event_cb(lv_event_t* e);
+  static void refresh_start_cb(lv_event_t* e);
+  void watch(lv_obj_t* obj);
+  void render();
+
+  lv_obj_t* source_;  // nullptr once LVGL deleted it.
+  lv_display_t* display_;
+  std::unique_ptr<lvgl::Image> layer_;
+  lv_draw_buf_t buf_ = {};
+  void* data_ = nullptr;
+  bool dirty_ = true;
+  bool rendering_ = false;
+  Stats stats_;
+};
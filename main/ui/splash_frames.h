@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sdkconfig.h"
+#include "ui/workshop_ui.h"
+
+/**
+ * SPLASH FRAMES
+ * -------------
+ * The first frame of every scene, rasterized at build time by
+ * tools/bake_splash.py and embedded into flash (see main/CMakeLists.txt).
+ * Each blob is a full-screen RGB565 frame, already byte-swapped for the
+ * panel, so it can be streamed before ThorVG has parsed a single SVG.
+ *
+ * With the asset partition the frames are packed into it instead, as
+ * "splash_<animal>" (see main.cpp).
+ */
+#if CONFIG_WORKSHOP_SPLASH && !CONFIG_WORKSHOP_ASSET_PARTITION
+
+extern const uint8_t splash_hummingbird_start[] asm(
+    "_binary_splash_hummingbird_bin_start");
+extern const uint8_t splash_hummingbird_end[] asm(
+    "_binary_splash_hummingbird_bin_end");
+extern const uint8_t splash_raccoon_start[] asm(
+    "_binary_splash_raccoon_bin_start");
+extern const uint8_t splash_raccoon_end[] asm("_binary_splash_raccoon_bin_end");
+extern const uint8_t splash_whale_start[] asm("_binary_splash_whale_bin_start");
+extern const uint8_t splash_whale_end[] asm("_binary_splash_whale_bin_end");
+
+/**
+ * Get the baked first frame of a scene.
+ * @param size Receives the blob size in bytes.
+ */
+inline const uint8_t* splash_frame(WorkshopUI::Animal animal, size_t* size) {
+  const uint8_t* start = splash_hummingbird_start;
+  const uint8_t* end = splash_hummingbird_end;
+  switch (animal) {
+    case WorkshopUI::Animal::Raccoon:
+      start = splash_raccoon_start;
+      end = splash_raccoon_end;
+      break;
+    case WorkshopUI::Animal::Whale:
+      start = splash_whale_start;
+      end = splash_whale_end;
+      break;
+    default:
+      break;
+  }
+  *size = end - start;
+  return start;
+}
+
+#endif  // CONFIG_WORKSHOP_SPLASH && !CONFIG_WORKSHOP_ASSET_PARTITION
@@ -1,12 +1,23 @@
 #include "workshop_ui.h"
 
 #include <cstring>
+#include <iterator>
 
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "misc/constants.h"
+#include "sdkconfig.h"
+#include "sys/image_cache_monitor.h"
+#include "sys/trace_recorder.h"
+#if CONFIG_WORKSHOP_ASSET_PARTITION
+#include "sys/asset_store.h"
+#include "sys/asset_stream.h"
+#else
 #include "../hummingbird.h"
 #include "../raccoon.h"
 #include "../whale.h"
-#include "esp_log.h"
-#include "misc/constants.h"
+#endif
 
 /**
  * WORKSHOP UI: Implementation
@@ -18,12 +29,79 @@
 
 static const char* TAG = "WorkshopUI";
 
+/**
+ * SVG SOURCES
+ * -----------
+ * With the asset partition the documents come from the flash mapping (see
+ * AssetStore), otherwise from the strings compiled into the app. Either way
+ * the descriptors point at the bytes in place, except for compressed
+ * assets: ThorVG needs the whole document, so those are decoded once into
+ * PSRAM (internal RAM without it) and kept for the life of the app.
+ */
+struct SvgSource {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+};
+
+static SvgSource load_animal_svg(WorkshopUI::Animal animal) {
+#if CONFIG_WORKSHOP_ASSET_PARTITION
+  const char* name = WorkshopUI::animal_name(animal);
+  const AssetStore::Asset* asset = AssetStore::find(name);
+  if (!asset || asset->format != AssetStore::Format::Svg) {
+    ESP_LOGE(TAG, "No SVG asset '%s'", name);
+    return {};
+  }
+  if (asset->stored()) {
+    return {asset->data, asset->size};
+  }
+
+  static const uint8_t* decoded[std::size(WorkshopUI::kAnimals)] = {};
+  const uint8_t*& data = decoded[(size_t)animal];
+  if (!data) {
+    data = AssetStream::load(*asset, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  }
+  if (!data) {
+    data = AssetStream::load(*asset, MALLOC_CAP_DEFAULT);
+  }
+  if (!data) {
+    return {};
+  }
+  return {data, asset->raw_size};
+#else
+  const char* raw_svg_ptr = hummingbird_svg;
+  if (animal == WorkshopUI::Animal::Raccoon) raw_svg_ptr = raccoon_svg;
+  if (animal == WorkshopUI::Animal::Whale) raw_svg_ptr = whale_svg;
+
+  // SVG pointer logic:
+  // We skip any leading metadata/whitespace in the header file to find
+  // the actual XML start tag '<'.
+  while (*raw_svg_ptr && *raw_svg_ptr != '<') raw_svg_ptr++;
+  return {reinterpret_cast<const uint8_t*>(raw_svg_ptr),
+          strlen(raw_svg_ptr) + 1};
+#endif
+}
+
+static SvgSource animal_svg(WorkshopUI::Animal animal) {
+  const SvgSource svg = load_animal_svg(animal);
+  // Image cache reports name the document instead of its address.
+  ImageCacheMonitor::name_source(svg.data, WorkshopUI::animal_name(animal));
+  return svg;
+}
+
 WorkshopUI::WorkshopUI() : current_animal_(Animal::Hummingbird) {}
 
+WorkshopUI::~WorkshopUI() {
+  finish_transition();
+  heap_caps_free(snapshot_data_);
+}
+
 void WorkshopUI::init(lvgl::Display& display) {
   ESP_LOGI(TAG, "Initializing UI");
 
-  // Create and load the base screen object.
+  // Create and load the base screen object. New objects land on the default
+  // display, so point it at ours while building (there may be several).
+  lv_display_t* previous_default = lv_display_get_default();
+  lv_display_set_default(display.raw());
   screen_ = std::make_unique<lvgl::Object>();
   display.load_screen(*screen_);
 
@@ -40,24 +118,198 @@ void WorkshopUI::init(lvgl::Display& display) {
 
   // Start with the Hummingbird view.
   setup_hummingbird(*screen_);
+
+  lv_display_set_default(previous_default);
 }
 
 void WorkshopUI::next_animal() {
+  Animal next = Animal::Hummingbird;
   if (current_animal_ == Animal::Hummingbird) {
-    current_animal_ = Animal::Raccoon;
-    setup_raccoon(*screen_);
+    next = Animal::Raccoon;
   } else if (current_animal_ == Animal::Raccoon) {
-    current_animal_ = Animal::Whale;
-    setup_whale(*screen_);
-  } else {
-    current_animal_ = Animal::Hummingbird;
-    setup_hummingbird(*screen_);
+    next = Animal::Whale;
+  }
+  transition_to(next, transition_, transition_ms_);
+}
+
+void WorkshopUI::show(Animal animal) {
+  // A direct switch ends a running transition.
+  finish_transition();
+  current_animal_ = animal;
+  switch (animal) {
+    case Animal::Hummingbird:
+      setup_hummingbird(*screen_);
+      break;
+    case Animal::Raccoon:
+      setup_raccoon(*screen_);
+      break;
+    case Animal::Whale:
+      setup_whale(*screen_);
+      break;
+  }
+  if (scene_hook_) {
+    scene_hook_(animal);
   }
 }
 
+uint32_t WorkshopUI::loop_ms(Animal animal) {
+  switch (animal) {
+    case Animal::Hummingbird:
+      return 0;  // No animations.
+    case Animal::Raccoon:
+      return 6000;  // Breathing: 3 s each way.
+    case Animal::Whale:
+      return 4000;  // Bobbing: 2 s each way. Tilt: 1 s each way.
+  }
+  return 0;
+}
+
+/**
+ * SCENE TRANSITIONS
+ * -----------------
+ * A cut pays teardown, rebuild and the first rasterization of the new
+ * scene in one frame. A transition instead renders the outgoing scene once
+ * more with lv_snapshot into a PSRAM buffer, builds the incoming scene
+ * underneath and animates an image of the snapshot on the top layer:
+ * sliding it off the screen, or fading its image_opa to zero. The snapshot
+ * blends like any RGB565 bitmap, so the old scene's vector content is
+ * never rasterized again, and the incoming scene rasterizes once into the
+ * image cache. The buffer is kept for the next transition.
+ */
+void WorkshopUI::transition_to(Animal animal, Transition transition,
+                               uint32_t duration_ms) {
+  finish_transition();
+  transition_stats_ = {};
+  if (transition != Transition::Cut && duration_ms > 0 && take_snapshot()) {
+    const int64_t start_us = esp_timer_get_time();
+    {
+      TraceRecorder::Scope trace(TraceRecorder::kRebuild);
+      show(animal);
+    }
+    transition_stats_.rebuild_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    lv_display_t* disp = lv_obj_get_display(screen_->raw());
+    overlay_ = lv_image_create(lv_display_get_layer_top(disp));
+    lv_image_set_src(overlay_, &snapshot_);
+    lv_obj_set_pos(overlay_, 0, 0);
+
+    lv_anim_t anim;
+    lv_anim_init(&anim);
+    lv_anim_set_var(&anim, overlay_);
+    lv_anim_set_duration(&anim, duration_ms);
+    lv_anim_set_path_cb(&anim, lv_anim_path_ease_in_out);
+    if (transition == Transition::Slide) {
+      lv_anim_set_values(&anim, 0, -lv_display_get_horizontal_resolution(disp));
+      lv_anim_set_exec_cb(&anim, [](void* obj, int32_t val) {
+        lv_obj_set_x(static_cast<lv_obj_t*>(obj), val);
+      });
+    } else {
+      // image_opa is applied while blending; plain opa would need a layer.
+      lv_anim_set_values(&anim, LV_OPA_COVER, LV_OPA_TRANSP);
+      lv_anim_set_exec_cb(&anim, [](void* obj, int32_t val) {
+        lv_obj_set_style_image_opa(static_cast<lv_obj_t*>(obj),
+                                   (lv_opa_t)val, 0);
+      });
+    }
+    lv_anim_set_user_data(&anim, this);
+    lv_anim_set_completed_cb(&anim, transition_done_cb);
+    lv_anim_start(&anim);
+    return;
+  }
+
+  const int64_t start_us = esp_timer_get_time();
+  {
+    TraceRecorder::Scope trace(TraceRecorder::kRebuild);
+    show(animal);
+  }
+  transition_stats_.rebuild_us = (uint32_t)(esp_timer_get_time() - start_us);
+}
+
+bool WorkshopUI::take_snapshot() {
+  TraceRecorder::Scope trace(TraceRecorder::kSnapshot);
+  const int64_t start_us = esp_timer_get_time();
+  lv_obj_t* screen = screen_->raw();
+  const uint32_t w = lv_obj_get_width(screen);
+  const uint32_t h = lv_obj_get_height(screen);
+  const uint32_t stride =
+      lv_draw_buf_width_to_stride(w, LV_COLOR_FORMAT_RGB565);
+  const size_t size = (size_t)stride * h;
+
+  if (snapshot_data_ && snapshot_.data_size < size) {
+    heap_caps_free(snapshot_data_);
+    snapshot_data_ = nullptr;
+  }
+  if (!snapshot_data_) {
+    snapshot_data_ = heap_caps_aligned_alloc(
+        LV_DRAW_BUF_ALIGN, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  }
+  if (!snapshot_data_) {
+    ESP_LOGW(TAG, "No PSRAM for a %ux%u snapshot, cutting", (unsigned)w,
+             (unsigned)h);
+    return false;
+  }
+
+  lv_draw_buf_init(&snapshot_, w, h, LV_COLOR_FORMAT_RGB565, stride,
+                   snapshot_data_, size);
+  if (lv_snapshot_take_to_draw_buf(screen, LV_COLOR_FORMAT_RGB565,
+                                   &snapshot_) != LV_RESULT_OK) {
+    ESP_LOGW(TAG, "Snapshot failed, cutting");
+    return false;
+  }
+  transition_stats_.snapshot_us = (uint32_t)(esp_timer_get_time() - start_us);
+  transition_stats_.snapshot_bytes = size;
+  return true;
+}
+
+void WorkshopUI::finish_transition() {
+  if (!overlay_) {
+    return;
+  }
+  lv_anim_delete(overlay_, nullptr);
+  lv_obj_delete(overlay_);
+  overlay_ = nullptr;
+  // The buffer is reused: no decoder may keep serving the old pixels.
+  lv_image_cache_drop(&snapshot_);
+}
+
+void WorkshopUI::transition_done_cb(lv_anim_t* anim) {
+  auto* self = static_cast<WorkshopUI*>(lv_anim_get_user_data(anim));
+  // Deleting the animated object from its own completion callback is not
+  // safe; LVGL deletes it after the current timer pass.
+  lv_obj_delete_async(self->overlay_);
+  self->overlay_ = nullptr;
+  lv_image_cache_drop(&self->snapshot_);
+}
+
+const char* WorkshopUI::transition_name(Transition transition) {
+  switch (transition) {
+    case Transition::Cut:
+      return "cut";
+    case Transition::Slide:
+      return "slide";
+    case Transition::Crossfade:
+      return "crossfade";
+  }
+  return "unknown";
+}
+
+const char* WorkshopUI::animal_name(Animal animal) {
+  switch (animal) {
+    case Animal::Hummingbird:
+      return "hummingbird";
+    case Animal::Raccoon:
+      return "raccoon";
+    case Animal::Whale:
+      return "whale";
+  }
+  return "unknown";
+}
+
 void WorkshopUI::setup_whale(lvgl::Object& parent) {
   parent.clean();
+  bitmap_cache_.reset();
   current_image_.reset();
+  sprites_.clear();
 
   ESP_LOGI(TAG, "Setting up Whale");
 
@@ -67,24 +319,33 @@ void WorkshopUI::setup_whale(lvgl::Object& parent) {
       .border_width(0)
       .radius(0);
 
-  const char* raw_svg_ptr = whale_svg;
-  while (*raw_svg_ptr && *raw_svg_ptr != '<') raw_svg_ptr++;
+  const SvgSource svg = animal_svg(Animal::Whale);
+  if (!svg.data) return;
 
   // Whale is rendered at 150x150 pixels.
-  static lvgl::ImageDescriptor whale_dsc(
-      150, 150, lvgl::ColorFormat::Raw,
-      reinterpret_cast<const uint8_t*>(raw_svg_ptr), strlen(raw_svg_ptr) + 1);
+  static lvgl::ImageDescriptor whale_dsc(150, 150, lvgl::ColorFormat::Raw,
+                                         svg.data, svg.size);
 
   current_image_ = std::make_unique<lvgl::Image>(parent);
   current_image_->set_src(whale_dsc).center();
 
+  // The whale only moves and turns: with a bitmap cache it is rasterized
+  // once and both animations transform the cached layer instead.
+  lvgl::Image* whale = current_image_.get();
+#if CONFIG_WORKSHOP_CACHE_AS_BITMAP
+  if (cache_as_bitmap_) {
+    bitmap_cache_ = std::make_unique<BitmapCache>(parent, *current_image_);
+    whale = &bitmap_cache_->layer();
+  }
+#endif
+
   // We interpret the SVG's <animateTransform> tags and map them to LVGL
   // objects.
 
   // Component 1: BOBBING (Translate Y)
   // SVG: values="0 2; 0 -2; 0 2", keySplines="0.45 0 0.55 1"
   lvgl::Animation bob;
-  bob.set_var(*current_image_)
+  bob.set_var(*whale)
       .set_values(6, -6)  // Slightly amplified for visual impact
       .set_duration(2000)
       .set_playback_duration(2000)
@@ -97,7 +358,7 @@ void WorkshopUI::setup_whale(lvgl::Object& parent) {
   // Component 2: SWIMMING TILT (Rotation)
   // SVG: values="-8 0 0; 8 0 0; -8 0 0", dur="2s"
   lvgl::Animation tilt;
-  tilt.set_var(*current_image_)
+  tilt.set_var(*whale)
       .set_values(-80, 80)  // +/- 8.0 degrees
       .set_duration(1000)
       .set_playback_duration(1000)
@@ -112,7 +373,9 @@ void WorkshopUI::setup_whale(lvgl::Object& parent) {
 void WorkshopUI::setup_hummingbird(lvgl::Object& parent) {
   // Clean up previous UI elements to free memory.
   parent.clean();
+  bitmap_cache_.reset();
   current_image_.reset();
+  sprites_.clear();
 
   ESP_LOGI(TAG, "Setting up Hummingbird");
 
@@ -121,17 +384,13 @@ void WorkshopUI::setup_hummingbird(lvgl::Object& parent) {
       .bg_opa(lvgl::Opacity::Cover)
       .border_width(0)
       .radius(0);
-  // SVG pointer logic:
-  // We skip any leading metadata/whitespace in the header file to find
-  // the actual XML start tag '<'.
-  const char* raw_svg_ptr = hummingbird_svg;
-  while (*raw_svg_ptr && *raw_svg_ptr != '<') raw_svg_ptr++;
+  const SvgSource svg = animal_svg(Animal::Hummingbird);
+  if (!svg.data) return;
 
   // ImageDescriptor:
   // ThorVG reads the SVG data from this static descriptor.
-  static lvgl::ImageDescriptor bird_dsc(
-      200, 200, lvgl::ColorFormat::Raw,
-      reinterpret_cast<const uint8_t*>(raw_svg_ptr), strlen(raw_svg_ptr) + 1);
+  static lvgl::ImageDescriptor bird_dsc(200, 200, lvgl::ColorFormat::Raw,
+                                        svg.data, svg.size);
 
   // Display the SVG using a standard LVGL Image object.
   current_image_ = std::make_unique<lvgl::Image>(parent);
@@ -140,7 +399,9 @@ void WorkshopUI::setup_hummingbird(lvgl::Object& parent) {
 
 void WorkshopUI::setup_raccoon(lvgl::Object& parent) {
   parent.clean();
+  bitmap_cache_.reset();
   current_image_.reset();
+  sprites_.clear();
 
   ESP_LOGI(TAG, "Setting up Raccoon");
 
@@ -150,14 +411,12 @@ void WorkshopUI::setup_raccoon(lvgl::Object& parent) {
       .border_width(0)
       .radius(0);
 
-  // Similar SVG pointer logic for the Raccoon.
-  const char* raw_svg_ptr = raccoon_svg;
-  while (*raw_svg_ptr && *raw_svg_ptr != '<') raw_svg_ptr++;
+  const SvgSource svg = animal_svg(Animal::Raccoon);
+  if (!svg.data) return;
 
   // Raccoon is rendered at 180x180 pixels.
-  static lvgl::ImageDescriptor raccoon_dsc(
-      180, 180, lvgl::ColorFormat::Raw,
-      reinterpret_cast<const uint8_t*>(raw_svg_ptr), strlen(raw_svg_ptr) + 1);
+  static lvgl::ImageDescriptor raccoon_dsc(180, 180, lvgl::ColorFormat::Raw,
+                                           svg.data, svg.size);
 
   current_image_ = std::make_unique<lvgl::Image>(parent);
   current_image_->set_src(raccoon_dsc).center();
@@ -176,3 +435,95 @@ void WorkshopUI::setup_raccoon(lvgl::Object& parent) {
       })
       .start();
 }
+
+void WorkshopUI::show_stress(uint32_t count) {
+  lvgl::Object& parent = *screen_;
+  parent.clean();
+  bitmap_cache_.reset();
+  current_image_.reset();
+  sprites_.clear();
+
+  ESP_LOGI(TAG, "Setting up stress scene with %u sprites", (unsigned)count);
+
+  // Small descriptors: every sprite scales one of these, so ThorVG parses
+  // each SVG once and the sprite count is the only variable.
+  static constexpr int kSpriteSize = 64;
+  static std::unique_ptr<lvgl::ImageDescriptor> sprite_dsc[3];
+  for (int i = 0; i < 3; i++) {
+    if (sprite_dsc[i]) continue;
+    const SvgSource svg = animal_svg(kAnimals[i]);
+    if (!svg.data) return;
+    sprite_dsc[i] = std::make_unique<lvgl::ImageDescriptor>(
+        kSpriteSize, kSpriteSize, lvgl::ColorFormat::Raw, svg.data, svg.size);
+  }
+
+  // Deterministic layout (LCG): the same count gives the same scene on
+  // every run, device or host.
+  uint32_t seed = 0x5EED;
+  auto next = [&seed](uint32_t range) {
+    seed = seed * 1664525u + 1013904223u;
+    return (int32_t)((seed >> 8) % range);
+  };
+
+  const int32_t w = lv_obj_get_width(parent.raw());
+  const int32_t h = lv_obj_get_height(parent.raw());
+  sprites_.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    const int kind = i % 3;
+    auto sprite = std::make_unique<lvgl::Image>(parent);
+    sprite->set_src(*sprite_dsc[kind]).center();
+    lv_obj_align(sprite->raw(), LV_ALIGN_CENTER, next(w) - w / 2,
+                 next(h) - h / 2);
+
+    // 0.5x to 1.5x of the descriptor size.
+    const int32_t scale = 128 + next(257);
+    sprite->set_scale(scale);
+
+    // Durations and directions vary per sprite so the animations drift
+    // apart instead of invalidating in lockstep.
+    const uint32_t period = 800 + next(2200);
+    const int32_t amplitude = 4 + next(9);
+    const bool flip = next(2);
+    const int32_t from = flip ? amplitude : -amplitude;
+
+    lvgl::Animation bob;
+    bob.set_var(*sprite)
+        .set_values(from, -from)
+        .set_duration(period)
+        .set_playback_duration(period)
+        .set_repeat_count(lvgl::Animation::RepeatInfinite)
+        .set_path_cb(lvgl::Animation::Path::EaseInOut())
+        .set_exec_cb([](lvgl::Object& obj, int32_t val) {
+          obj.style().translate_y(val);
+        })
+        .start();
+
+    // Each kind keeps its own character: raccoons breathe, whales tilt,
+    // hummingbirds dart sideways.
+    lvgl::Animation motion;
+    motion.set_var(*sprite)
+        .set_duration(period / 2 + 200)
+        .set_playback_duration(period / 2 + 200)
+        .set_repeat_count(lvgl::Animation::RepeatInfinite)
+        .set_path_cb(lvgl::Animation::Path::EaseInOut());
+    if (kind == 1) {
+      motion.set_values(scale * 7 / 8, scale)
+          .set_exec_cb([](lvgl::Object& obj, int32_t val) {
+            static_cast<lvgl::Image&>(obj).set_scale(val);
+          });
+    } else if (kind == 2) {
+      motion.set_values(flip ? 80 : -80, flip ? -80 : 80)  // +/- 8 deg
+          .set_exec_cb([](lvgl::Object& obj, int32_t val) {
+            static_cast<lvgl::Image&>(obj).set_rotation(val);
+          });
+    } else {
+      motion.set_values(-from, from)
+          .set_exec_cb([](lvgl::Object& obj, int32_t val) {
+            obj.style().translate_x(val);
+          });
+    }
+    motion.start();
+
+    sprites_.push_back(std::move(sprite));
+  }
+}
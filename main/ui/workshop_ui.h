@@ -3,26 +3,122 @@
 #if defined(noreturn)
 #undef noreturn
 #endif
+#include <functional>
 #include <memory>
+#include <vector>
 
+#include "lvgl.h"
 #include "lvgl_cpp.h"
+#include "ui/bitmap_cache.h"
 
 class WorkshopUI {
  public:
+  enum class Animal { Hummingbird, Raccoon, Whale };
+  static constexpr Animal kAnimals[] = {Animal::Hummingbird, Animal::Raccoon,
+                                        Animal::Whale};
+
+  /**
+   * How next_animal() and transition_to() switch scenes. Slide and
+   * Crossfade composite a snapshot of the outgoing scene over the incoming
+   * one, so the old scene is never rasterized again.
+   */
+  enum class Transition { Cut, Slide, Crossfade };
+
+  struct TransitionStats {
+    uint32_t snapshot_us = 0;   // lv_snapshot of the outgoing scene.
+    uint32_t rebuild_us = 0;    // Teardown plus setup of the new scene.
+    size_t snapshot_bytes = 0;  // PSRAM held by the snapshot.
+  };
+
   WorkshopUI();
-  ~WorkshopUI() = default;
+  ~WorkshopUI();
 
   void init(lvgl::Display& display);
   void next_animal();
 
+  /**
+   * Switch directly to a scene (e.g. for benchmarks). Call with the LVGL
+   * lock held.
+   */
+  void show(Animal animal);
+  Animal current_animal() const { return current_animal_; }
+  static const char* animal_name(Animal animal);
+  static const char* transition_name(Transition transition);
+
+  /**
+   * Switch scenes with an animated transition over `duration_ms`. The
+   * outgoing scene is captured once into a PSRAM buffer (kept for the next
+   * transition) and shown on the top layer while the incoming scene runs
+   * underneath. Falls back to a cut if the snapshot fails. Call with the
+   * LVGL lock held.
+   */
+  void transition_to(Animal animal, Transition transition,
+                     uint32_t duration_ms);
+  bool transition_active() const { return overlay_ != nullptr; }
+  const TransitionStats& last_transition() const { return transition_stats_; }
+
+  /** Transition used by next_animal() (touch). */
+  void set_transition(Transition transition, uint32_t duration_ms) {
+    transition_ = transition;
+    transition_ms_ = duration_ms;
+  }
+
+  /**
+   * Length of a scene's animation loop: after it, every animation of the
+   * scene is back where it started. 0 for a still scene. Keep in sync with
+   * the setup_*() functions.
+   */
+  static uint32_t loop_ms(Animal animal);
+
+  /**
+   * Called at the end of show() with the LVGL lock held, e.g. to swap a
+   * scene for its pre-rendered clip.
+   */
+  using SceneHook = std::function<void(Animal animal)>;
+  void set_scene_hook(SceneHook hook) { scene_hook_ = std::move(hook); }
+
+  /**
+   * Stress scene: `count` independently animated copies of the three SVGs
+   * at varying sizes and positions. The layout is seeded, so a given count
+   * always produces the same scene. Call with the LVGL lock held; show()
+   * returns to a regular scene.
+   */
+  void show_stress(uint32_t count);
+
+  /**
+   * The current scene's bitmap cache (WORKSHOP_CACHE_AS_BITMAP), or nullptr
+   * if it renders normally.
+   */
+  const BitmapCache* bitmap_cache() const { return bitmap_cache_.get(); }
+
+  /**
+   * Whether scenes built from now on use a bitmap cache (on by default with
+   * WORKSHOP_CACHE_AS_BITMAP, which the cache needs). Turning it off gives
+   * an uncached baseline in the same build. Takes effect at the next
+   * show().
+   */
+  void set_cache_as_bitmap(bool on) { cache_as_bitmap_ = on; }
+
  private:
   void setup_hummingbird(lvgl::Object& parent);
   void setup_raccoon(lvgl::Object& parent);
   void setup_whale(lvgl::Object& parent);
-
-  enum class Animal { Hummingbird, Raccoon, Whale };
+  bool take_snapshot();
+  void finish_transition();
+  static void transition_done_cb(lv_anim_t* anim);
 
   Animal current_animal_ = Animal::Hummingbird;
   std::unique_ptr<lvgl::Object> screen_;
   std::unique_ptr<lvgl::Image> current_image_;
+  std::vector<std::unique_ptr<lvgl::Image>> sprites_;
+  std::unique_ptr<BitmapCache> bitmap_cache_;
+  bool cache_as_bitmap_ = true;
+  SceneHook scene_hook_;
+
+  Transition transition_ = Transition::Cut;
+  uint32_t transition_ms_ = 0;
+  TransitionStats transition_stats_;
+  lv_draw_buf_t snapshot_ = {};
+  void* snapshot_data_ = nullptr;
+  lv_obj_t* overlay_ = nullptr;  // Image on the top layer showing snapshot_.
 };
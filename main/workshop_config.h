@@ -1,11 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
 #include "display/display.h"
+#include "esp_attr.h"
 #include "esp_heap_caps.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "lvgl.h"
 #include "sdkconfig.h"
+#include "sys/flush_pipeline.h"
 
 /**
  * WORKSHOP CONFIGURATION REGISTRY
@@ -25,6 +31,14 @@
  * Phase 3: Parallelism (Partial Double Buffering)
  * Phase 4: Expert (Full-Frame PSRAM Double Buffering, SIMD Intrinsics)
  * Phase 5: Native (Native Display Driver, SIMD SW_ASM Shim)
+ *
+ * Buffer sizes are not part of a phase: they are derived from the panel
+ * resolution (H_RES x V_RES) below.
+ *
+ * A phase is only a preset. With CONFIG_WORKSHOP_CUSTOM_KNOBS each setting
+ * below (CPU and SPI clocks, buffer caps, double buffering, refresh mode,
+ * strip height, byte swap, driver, affinity) comes from its own Kconfig
+ * option instead, seeded from the phase.
  */
 #ifdef CONFIG_USE_KCONFIG_PHASE
 #define WORKSHOP_PHASE CONFIG_WORKSHOP_PHASE
@@ -46,18 +60,39 @@ enum class BufferMode { PartialStrip, FullFrame };
 // 160MHz (Phase 1) is the standard low-power speed.
 // 240MHz (Phase 2+) is the maximum for the ESP32-S3 and essential for vector
 // rasterization.
-static constexpr int CPU_FREQ_MHZ = (WORKSHOP_PHASE >= 2) ? 240 : 160;
+// Clock and bus speed are the only parts of a phase that can change at run
+// time (see the console's `phase` command), hence the functions.
+constexpr int phase_cpu_freq_mhz(int phase) { return phase >= 2 ? 240 : 160; }
+#ifdef CONFIG_WORKSHOP_CUSTOM_KNOBS
+static constexpr int CPU_FREQ_MHZ = CONFIG_WORKSHOP_CPU_FREQ_MHZ;
+#else
+static constexpr int CPU_FREQ_MHZ = phase_cpu_freq_mhz(WORKSHOP_PHASE);
+#endif
+static_assert(CPU_FREQ_MHZ == 80 || CPU_FREQ_MHZ == 160 || CPU_FREQ_MHZ == 240,
+              "the ESP32-S3 runs at 80, 160 or 240 MHz");
 
 // SPI BUS SPEED:
 // 20MHz (Phase 1) is safe for most modern SPI devices.
 // 80MHz (Phase 2+) is the absolute hardware limit of the S3's SPIRAM.
-static constexpr uint32_t SPI_BUS_SPEED =
-    (WORKSHOP_PHASE >= 2) ? (80 * 1000 * 1000) : (20 * 1000 * 1000);
+constexpr uint32_t phase_spi_bus_speed(int phase) {
+  return phase >= 2 ? (80 * 1000 * 1000) : (20 * 1000 * 1000);
+}
+#ifdef CONFIG_WORKSHOP_CUSTOM_KNOBS
+static constexpr uint32_t SPI_BUS_SPEED = CONFIG_WORKSHOP_SPI_MHZ * 1000 * 1000;
+#else
+static constexpr uint32_t SPI_BUS_SPEED = phase_spi_bus_speed(WORKSHOP_PHASE);
+#endif
 
 // MEMORY STRATEGY:
 // Phase 4 uses the 8MB Octal PSRAM for massive distinct buffers.
 // All other phases rely on the fast internal SRAM (~320KB).
+#if !defined(CONFIG_WORKSHOP_CUSTOM_KNOBS)
 static constexpr bool USE_PSRAM = (WORKSHOP_PHASE == 4);
+#elif defined(CONFIG_WORKSHOP_PSRAM_BUFFERS)
+static constexpr bool USE_PSRAM = true;
+#else
+static constexpr bool USE_PSRAM = false;
+#endif
 
 static constexpr uint32_t ALLOC_CAPS =
     USE_PSRAM ? (MALLOC_CAP_DMA | MALLOC_CAP_SPIRAM)
@@ -65,50 +100,398 @@ static constexpr uint32_t ALLOC_CAPS =
 
 // CONCURRENCY (DOUBLE BUFFERING):
 // Phase 3+ enables a second buffer to decouple render time from flush time.
+#if !defined(CONFIG_WORKSHOP_CUSTOM_KNOBS)
 static constexpr bool USE_DOUBLE_BUFFERING = (WORKSHOP_PHASE >= 3);
+#elif defined(CONFIG_WORKSHOP_DOUBLE_BUFFER)
+static constexpr bool USE_DOUBLE_BUFFERING = true;
+#else
+static constexpr bool USE_DOUBLE_BUFFERING = false;
+#endif
 
-// RENDERING MODE:
-// Phase 1-2: Naive full refresh (redraws everything).
-// Phase 3+: Optimized partial refresh (redraws only changed areas).
-static constexpr lvgl::Display::RenderMode LVGL_RENDER_MODE =
-    (WORKSHOP_PHASE >= 3) ? lvgl::Display::RenderMode::Partial
-                          : lvgl::Display::RenderMode::Full;
+// RESOLUTION:
+// The Round Display is 240x240. Every size below (frame, strips, SPI
+// transfers) is derived from these two values.
+#ifdef CONFIG_WORKSHOP_H_RES
+static constexpr int H_RES = CONFIG_WORKSHOP_H_RES;
+static constexpr int V_RES = CONFIG_WORKSHOP_V_RES;
+#else
+static constexpr int H_RES = 240;
+static constexpr int V_RES = 240;
+#endif
+static constexpr size_t FRAME_BYTES = (size_t)H_RES * V_RES * sizeof(uint16_t);
+
+// Largest frame buffer we carve out of internal SRAM. A 240x240 frame
+// (112.5 KB) fits; a 360x360 one (253 KB) would leave nothing for ThorVG
+// and the task stacks.
+static constexpr size_t SRAM_FRAME_BUDGET = 160 * 1024;
 
 // BUFFER SIZING:
 // FullFrame: Used when we have massive RAM (Phase 4) or when we only have
 // one buffer (Phase 1-2) and it fits in SRAM.
 // PartialStrip: Used when we want double-buffering but are constrained by
-// Internal SRAM size (Phase 3, 5).
-static constexpr BufferMode BUFFER_MODE = (USE_PSRAM || !USE_DOUBLE_BUFFERING)
-                                              ? BufferMode::FullFrame
-                                              : BufferMode::PartialStrip;
+// Internal SRAM size (Phase 3, 5), or when a single frame does not fit.
+static constexpr BufferMode BUFFER_MODE =
+    (USE_PSRAM || (!USE_DOUBLE_BUFFERING && FRAME_BYTES <= SRAM_FRAME_BUDGET))
+        ? BufferMode::FullFrame
+        : BufferMode::PartialStrip;
+
+// RENDERING MODE:
+// Phase 1-2: Naive full refresh (redraws everything).
+// Phase 3+: Optimized partial refresh (redraws only changed areas).
+// Full refresh needs a full-frame buffer; without one we render partially.
+#if !defined(CONFIG_WORKSHOP_CUSTOM_KNOBS)
+static constexpr bool PARTIAL_REFRESH = (WORKSHOP_PHASE >= 3);
+#elif defined(CONFIG_WORKSHOP_PARTIAL_REFRESH)
+static constexpr bool PARTIAL_REFRESH = true;
+#else
+static constexpr bool PARTIAL_REFRESH = false;
+#endif
+static constexpr lvgl::Display::RenderMode LVGL_RENDER_MODE =
+    (PARTIAL_REFRESH || BUFFER_MODE != BufferMode::FullFrame)
+        ? lvgl::Display::RenderMode::Partial
+        : lvgl::Display::RenderMode::Full;
 
 // TASK STACK DEPTH:
 // Vector graphics engines (ThorVG) use recursion for path parsing and
 // scaling. 32KB (Phase 1) is recommended to prevent stack overflows during
 // complex SVG rendering. 64KB (Phase 2+) provides the headroom needed for
 // fluid animations.
-static constexpr uint32_t LVGL_STACK_SIZE =
+static constexpr uint32_t PHASE_STACK_SIZE =
     (WORKSHOP_PHASE >= 2) ? 64 * 1024 : 32 * 1024;
 
+// Stack calibration mode measures the real peak; its recommendation is
+// applied through CONFIG_WORKSHOP_LVGL_STACK_SIZE.
+static constexpr uint32_t LVGL_STACK_SIZE =
+    (CONFIG_WORKSHOP_LVGL_STACK_SIZE > 0) ? CONFIG_WORKSHOP_LVGL_STACK_SIZE
+                                          : PHASE_STACK_SIZE;
+
+// STRIP HEIGHT:
+// Partial strips default to 20 lines of the 240-pixel Round Display (see
+// Postmortem 3). They are budgeted in bytes, so a wider panel gets fewer
+// lines for the same SRAM. Internal SRAM reclaimed by a calibrated, smaller
+// stack is split across the two strips. Full-frame buffers (Phase 4 keeps
+// them in PSRAM) and the native driver (Phase 5 sizes its own) have no
+// strips to grow: there the saving simply stays on the internal heap.
+static constexpr uint32_t STACK_RECLAIMED_BYTES =
+    (PHASE_STACK_SIZE > LVGL_STACK_SIZE) ? PHASE_STACK_SIZE - LVGL_STACK_SIZE
+                                         : 0;
+static constexpr int STRIP_BUDGET_LINES = 20;
+static constexpr int STRIP_BUDGET_WIDTH = 240;
+static constexpr size_t STRIP_BUDGET_BYTES =
+    (size_t)STRIP_BUDGET_LINES * STRIP_BUDGET_WIDTH * sizeof(uint16_t);
+static constexpr size_t STRIP_BYTES =
+    STRIP_BUDGET_BYTES + STACK_RECLAIMED_BYTES / 2;
+#if defined(CONFIG_WORKSHOP_CUSTOM_KNOBS) && CONFIG_WORKSHOP_STRIP_LINES > 0
+static constexpr int STRIP_LINES =
+    std::clamp(CONFIG_WORKSHOP_STRIP_LINES, 1, V_RES);
+#else
+static constexpr int STRIP_LINES = std::clamp(
+    (int)(STRIP_BYTES / (H_RES * sizeof(uint16_t))), 1, V_RES);
+#endif
+
 // COMPILER OPTIMIZATIONS (BYTE SWAPPING):
 // SIMD Intrinsics (Phase 4+): Replaces manual loops with a single-cycle
 // hardware instruction
 // (`__builtin_bswap16`) to swap Little-Endian CPU bytes for the Big-Endian
 // LCD.
+#if !defined(CONFIG_WORKSHOP_CUSTOM_KNOBS)
 static constexpr bool USE_XTENSA_INTRINSICS = (WORKSHOP_PHASE >= 4);
+#elif defined(CONFIG_WORKSHOP_BSWAP_INTRINSICS)
+static constexpr bool USE_XTENSA_INTRINSICS = true;
+#else
+static constexpr bool USE_XTENSA_INTRINSICS = false;
+#endif
+
+// FLUSH PIPELINE:
+// What flush_cb does to every pixel, as stages fused into one loop (see
+// sys/flush_pipeline.h). Add a stage here (e.g. Invert for a panel that
+// shows negatives) rather than a branch in flush_cb.
+using FlushStages =
+    std::conditional_t<USE_XTENSA_INTRINSICS, FlushPipeline<BswapBuiltin>,
+                       FlushPipeline<BswapShift>>;
 
 // DRIVER STRATEGY:
 // Legacy (Phase 1-4): LvglPort manages buffers and manual flushing.
 // Native (Phase 5): Esp32SpiDisplay manages buffers and dedicated SPI/DMA
 // logic.
+#if !defined(CONFIG_WORKSHOP_CUSTOM_KNOBS)
 static constexpr bool USE_NATIVE_DRIVER = (WORKSHOP_PHASE >= 5);
+#elif defined(CONFIG_WORKSHOP_NATIVE_DRIVER)
+static constexpr bool USE_NATIVE_DRIVER = true;
+#else
+static constexpr bool USE_NATIVE_DRIVER = false;
+#endif
+
+// Whether STACK_RECLAIMED_BYTES reaches the strips (see STRIP HEIGHT).
+static constexpr bool STACK_RECLAIMED_TO_STRIPS =
+    !USE_NATIVE_DRIVER && BUFFER_MODE == BufferMode::PartialStrip;
 
 // CORE AFFINITY:
 // Phase 1-4: Pin to Core 1.
 // Phase 5: No Affinity (Load Balancing) to isolate ThorVG and maximize
 // throughput.
+// Check the choice with WORKSHOP_CPU_MONITOR: the bench records then show
+// each core's load, where the LVGL task ran and how often it migrated.
+#ifdef CONFIG_WORKSHOP_CUSTOM_KNOBS
+static constexpr BaseType_t LVGL_TASK_CORE =
+    (CONFIG_WORKSHOP_LVGL_CORE < 0) ? tskNO_AFFINITY
+                                    : CONFIG_WORKSHOP_LVGL_CORE;
+#else
 static constexpr BaseType_t LVGL_TASK_CORE =
     (WORKSHOP_PHASE == 5) ? tskNO_AFFINITY : 1;
+#endif
+
+// FLIGHT RECORDER (DIAGNOSTICS):
+// Independent of the phase. Keeps the last N frames in PSRAM and dumps them
+// when a frame exceeds the jank budget. A depth of 0 disables it.
+#ifdef CONFIG_WORKSHOP_FLIGHT_RECORDER
+static constexpr size_t FLIGHT_RECORDER_DEPTH =
+    CONFIG_WORKSHOP_FLIGHT_RECORDER_DEPTH;
+static constexpr uint32_t JANK_BUDGET_MS = CONFIG_WORKSHOP_JANK_BUDGET_MS;
+#else
+static constexpr size_t FLIGHT_RECORDER_DEPTH = 0;
+static constexpr uint32_t JANK_BUDGET_MS = 0;
+#endif
+
+// EVENT TRACE (INSTRUMENTATION):
+// Task switches, ISR and pipeline stages as timestamped events for Perfetto.
+// A capacity of 0 disables it.
+#ifdef CONFIG_WORKSHOP_TRACE
+static constexpr size_t TRACE_EVENTS = CONFIG_WORKSHOP_TRACE_EVENTS;
+#else
+static constexpr size_t TRACE_EVENTS = 0;
+#endif
+
+// CPU MONITOR (INSTRUMENTATION):
+// Per-core busy time, per-task share and LVGL task migrations from FreeRTOS
+// run-time stats. A period of 0 disables it.
+#ifdef CONFIG_WORKSHOP_CPU_MONITOR
+static constexpr uint32_t CPU_MONITOR_PERIOD_MS =
+    CONFIG_WORKSHOP_CPU_MONITOR_PERIOD_MS;
+#else
+static constexpr uint32_t CPU_MONITOR_PERIOD_MS = 0;
+#endif
+
+// REDRAW HEATMAP (INSTRUMENTATION):
+// Per-tile invalidated / blended / flushed pixel counters. Off by default:
+// its draw unit is asked about every draw task and splits each one over
+// the tiles it covers, with the LVGL lock held, and the tile counters take
+// 3 * 4 bytes per tile of RAM.
+#ifdef CONFIG_WORKSHOP_REDRAW_HEATMAP
+static constexpr int HEATMAP_TILE_SIZE = CONFIG_WORKSHOP_HEATMAP_TILE_SIZE;
+static constexpr uint32_t HEATMAP_REPORT_FRAMES =
+    CONFIG_WORKSHOP_HEATMAP_REPORT_FRAMES;
+#else
+static constexpr int HEATMAP_TILE_SIZE = 0;
+static constexpr uint32_t HEATMAP_REPORT_FRAMES = 0;
+#endif
+
+// IMAGE CACHE (INSTRUMENTATION):
+// Per-source hit/miss/eviction counters for LVGL's image cache and the
+// eviction policy. A report interval of 0 disables the monitor.
+#ifdef CONFIG_WORKSHOP_IMAGE_CACHE_STATS
+static constexpr uint32_t IMAGE_CACHE_REPORT_MS =
+    CONFIG_WORKSHOP_IMAGE_CACHE_REPORT_MS;
+#else
+static constexpr uint32_t IMAGE_CACHE_REPORT_MS = 0;
+#endif
+
+#ifdef CONFIG_WORKSHOP_IMAGE_CACHE_COST_EVICTION
+static constexpr bool IMAGE_CACHE_COST_EVICTION = true;
+#else
+static constexpr bool IMAGE_CACHE_COST_EVICTION = false;
+#endif
+
+// HOT PATH PLACEMENT:
+// Our flush path goes to IRAM through IRAM_ATTR; LVGL, ThorVG and the blend
+// shims are placed by linker fragments (main/linker.lf and the SIMD patch
+// component). Compare the "TLM hotpath" records with and without it.
+#ifdef CONFIG_WORKSHOP_IRAM_FLUSH
+#define WORKSHOP_HOT_FLUSH IRAM_ATTR
+#else
+#define WORKSHOP_HOT_FLUSH
+#endif
+
+#ifdef CONFIG_WORKSHOP_HOT_PATH_PROFILING
+static constexpr bool HOT_PATH_PROFILING = true;
+#else
+static constexpr bool HOT_PATH_PROFILING = false;
+#endif
+
+// FRAME GOVERNOR:
+// Low CPU frequency (or light sleep) between frames, CPU_FREQ_MHZ while
+// rendering. Without it the CPU is pinned at CPU_FREQ_MHZ.
+#ifdef CONFIG_WORKSHOP_PM_GOVERNOR
+static constexpr int PM_MIN_FREQ_MHZ = CONFIG_WORKSHOP_PM_MIN_FREQ_MHZ;
+static constexpr uint32_t PM_FRAME_BUDGET_MS =
+    CONFIG_WORKSHOP_PM_FRAME_BUDGET_MS;
+static constexpr uint32_t PM_REPORT_MS = CONFIG_WORKSHOP_PM_REPORT_MS;
+#else
+static constexpr int PM_MIN_FREQ_MHZ = 0;
+static constexpr uint32_t PM_FRAME_BUDGET_MS = 0;
+static constexpr uint32_t PM_REPORT_MS = 0;
+#endif
+
+#ifdef CONFIG_WORKSHOP_PM_LIGHT_SLEEP
+static constexpr bool PM_LIGHT_SLEEP = true;
+#else
+static constexpr bool PM_LIGHT_SLEEP = false;
+#endif
+
+// STATIC SCENE:
+// Suspend the refresh loop while nothing changes; optionally sleep the
+// backlight and panel after a timeout.
+#ifdef CONFIG_WORKSHOP_STATIC_SCENE
+static constexpr uint32_t STATIC_IDLE_FRAMES =
+    CONFIG_WORKSHOP_STATIC_IDLE_FRAMES;
+static constexpr uint32_t STATIC_SLEEP_MS = CONFIG_WORKSHOP_STATIC_SLEEP_MS;
+#else
+static constexpr uint32_t STATIC_IDLE_FRAMES = 0;
+static constexpr uint32_t STATIC_SLEEP_MS = 0;
+#endif
+
+// FRAME PACING:
+// Lock refreshes to the fastest of PACING_MAX_HZ / 1..4 the frame cost
+// sustains, instead of LV_DEF_REFR_PERIOD (0 disables it).
+#ifdef CONFIG_WORKSHOP_FRAME_PACING
+static constexpr uint32_t PACING_MAX_HZ = CONFIG_WORKSHOP_PACING_MAX_HZ;
+static constexpr uint32_t PACING_HEADROOM_PCT =
+    CONFIG_WORKSHOP_PACING_HEADROOM_PCT;
+static constexpr uint32_t PACING_REPORT_MS = CONFIG_WORKSHOP_PACING_REPORT_MS;
+#else
+static constexpr uint32_t PACING_MAX_HZ = 0;
+static constexpr uint32_t PACING_HEADROOM_PCT = 90;
+static constexpr uint32_t PACING_REPORT_MS = 0;
+#endif
+
+// DISPLAYS:
+// Number of panels on the shared SPI bus and their CS pins. Display 1 uses
+// the Round Display's own CS (GPIO 2).
+#ifdef CONFIG_WORKSHOP_DISPLAY_COUNT
+static constexpr int DISPLAY_COUNT = CONFIG_WORKSHOP_DISPLAY_COUNT;
+#else
+static constexpr int DISPLAY_COUNT = 1;
+#endif
+
+#ifndef CONFIG_WORKSHOP_DISPLAY2_CS_GPIO
+#define CONFIG_WORKSHOP_DISPLAY2_CS_GPIO -1
+#endif
+#ifndef CONFIG_WORKSHOP_DISPLAY3_CS_GPIO
+#define CONFIG_WORKSHOP_DISPLAY3_CS_GPIO -1
+#endif
+#ifndef CONFIG_WORKSHOP_DISPLAY4_CS_GPIO
+#define CONFIG_WORKSHOP_DISPLAY4_CS_GPIO -1
+#endif
+static constexpr int DISPLAY_CS_PINS[] = {
+    2, CONFIG_WORKSHOP_DISPLAY2_CS_GPIO, CONFIG_WORKSHOP_DISPLAY3_CS_GPIO,
+    CONFIG_WORKSHOP_DISPLAY4_CS_GPIO};
+
+// SPLASH:
+// Stream a build-time rasterized first frame before LVGL is up.
+#ifdef CONFIG_WORKSHOP_SPLASH
+static constexpr bool SPLASH = true;
+#else
+static constexpr bool SPLASH = false;
+#endif
+
+// ASSETS:
+// SVGs from the memory-mapped asset partition instead of the app image.
+#ifdef CONFIG_WORKSHOP_ASSET_PARTITION
+static constexpr bool ASSET_PARTITION = true;
+#else
+static constexpr bool ASSET_PARTITION = false;
+#endif
+
+// Time reading and decoding every asset after the mount.
+#ifdef CONFIG_WORKSHOP_ASSET_BENCHMARK
+static constexpr bool ASSET_BENCHMARK = true;
+#else
+static constexpr bool ASSET_BENCHMARK = false;
+#endif
+
+// CLIPS:
+// Pre-rendered animation loops from the asset partition replace their
+// scenes; on the host, capture mode renders one such loop.
+#ifdef CONFIG_WORKSHOP_CLIP_PLAYBACK
+static constexpr bool CLIP_PLAYBACK = true;
+#else
+static constexpr bool CLIP_PLAYBACK = false;
+#endif
+// Kconfig cannot see a phase set by the #define above.
+static_assert(!CLIP_PLAYBACK || !USE_NATIVE_DRIVER,
+              "Clip playback needs the port's flush path (phases 1-4)");
+
+#ifdef CONFIG_WORKSHOP_CLIP_CAPTURE
+static constexpr bool CLIP_CAPTURE = true;
+static constexpr const char* CLIP_ANIMAL = CONFIG_WORKSHOP_CLIP_ANIMAL;
+static constexpr uint32_t CLIP_FPS = CONFIG_WORKSHOP_CLIP_FPS;
+#else
+static constexpr bool CLIP_CAPTURE = false;
+static constexpr const char* CLIP_ANIMAL = "";
+static constexpr uint32_t CLIP_FPS = 30;
+#endif
+
+// TRANSITIONS:
+// Scene changes slide or crossfade a snapshot of the outgoing scene; 0 ms
+// means a plain cut.
+#ifdef CONFIG_WORKSHOP_TRANSITIONS
+static constexpr uint32_t TRANSITION_MS = CONFIG_WORKSHOP_TRANSITION_MS;
+#else
+static constexpr uint32_t TRANSITION_MS = 0;
+#endif
+
+#ifdef CONFIG_WORKSHOP_TRANSITION_CROSSFADE
+static constexpr bool TRANSITION_CROSSFADE = true;
+#else
+static constexpr bool TRANSITION_CROSSFADE = false;
+#endif
+
+// CACHE AS BITMAP:
+// The whale renders once into a layer that its animations transform.
+#ifdef CONFIG_WORKSHOP_CACHE_AS_BITMAP
+static constexpr bool CACHE_AS_BITMAP = true;
+#else
+static constexpr bool CACHE_AS_BITMAP = false;
+#endif
+
+// CONSOLE:
+// Benchmark and tuning commands on the serial console (stdin on the host),
+// answered with TLM records.
+#ifdef CONFIG_WORKSHOP_CONSOLE
+static constexpr bool CONSOLE = true;
+#else
+static constexpr bool CONSOLE = false;
+#endif
+
+// BENCHMARK & CALIBRATION:
+// Deterministic per-animal frame benchmark after boot, optionally followed by
+// the many-sprite stress sweep; calibration mode also samples stack and heap
+// high-water marks while it runs.
+#ifdef CONFIG_WORKSHOP_BENCHMARK_ON_BOOT
+static constexpr uint32_t BENCHMARK_FRAMES = CONFIG_WORKSHOP_BENCHMARK_FRAMES;
+#else
+static constexpr uint32_t BENCHMARK_FRAMES = 0;
+#endif
+
+#ifdef CONFIG_WORKSHOP_BENCHMARK_FULL_REDRAW
+static constexpr bool BENCHMARK_FULL_REDRAW = true;
+#else
+static constexpr bool BENCHMARK_FULL_REDRAW = false;
+#endif
+
+#ifdef CONFIG_WORKSHOP_STRESS_MAX_SPRITES
+static constexpr uint32_t STRESS_MAX_SPRITES =
+    CONFIG_WORKSHOP_STRESS_MAX_SPRITES;
+#else
+static constexpr uint32_t STRESS_MAX_SPRITES = 0;
+#endif
+
+#ifdef CONFIG_WORKSHOP_STACK_CALIBRATION
+static constexpr bool STACK_CALIBRATION = true;
+static constexpr uint32_t STACK_MARGIN_PCT = CONFIG_WORKSHOP_STACK_MARGIN_PCT;
+#else
+static constexpr bool STACK_CALIBRATION = false;
+static constexpr uint32_t STACK_MARGIN_PCT = 0;
+#endif
 
 }  // namespace Workshop
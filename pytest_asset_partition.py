@@ -0,0 +1,61 @@
+import logging
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+ASSETS_RECORD = r'TLM assets count=(\d+) bytes=(\d+) raw_bytes=(\d+) partition=(\d+) mount_us=(\d+)'
+ASSET_BENCH_RECORD = (
+    r'TLM asset_bench name=(\w+) compression=(\d) size=(\d+) raw_size=(\d+) ratio=([\d.]+) '
+    r'read_us=(-?\d+) decode_us=(-?\d+) .* saved_us=(-?\d+) verified=(\d)'
+)
+BENCH_RECORD = r'TLM bench phase=\d+ res=\d+x\d+ animal=(\w+) frames=(\d+)'
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['assets'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_asset_partition_linux(dut: IdfDut) -> None:
+    assets = dut.expect(ASSETS_RECORD, timeout=30)
+    assert int(assets.group(1)) == 3
+    assert 0 < int(assets.group(2)) <= int(assets.group(4))
+    # Stored as is: the decoded bytes are part of the blob.
+    assert int(assets.group(3)) < int(assets.group(2))
+
+    # Every scene renders from the mapped partition.
+    animals = set()
+    for _ in range(3):
+        bench = dut.expect(BENCH_RECORD, timeout=300)
+        assert int(bench.group(2)) > 0
+        animals.add(bench.group(1).decode())
+    assert animals == {'hummingbird', 'raccoon', 'whale'}
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['asset_compression'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_asset_compression_linux(dut: IdfDut) -> None:
+    assets = dut.expect(ASSETS_RECORD, timeout=30)
+    assert int(assets.group(1)) == 3
+    assert int(assets.group(2)) < int(assets.group(3))
+
+    logging.info('%-12s %8s %8s %6s %9s %9s %9s', 'asset', 'size', 'raw', 'ratio', 'read_us', 'decode_us', 'saved_us')
+    for _ in range(3):
+        bench = dut.expect(ASSET_BENCH_RECORD, timeout=30)
+        name = bench.group(1).decode()
+        assert int(bench.group(2)) == 1, f'{name} was not compressed'
+        assert int(bench.group(3)) < int(bench.group(4))
+        assert int(bench.group(9)) == 1, f'{name} failed to decode'
+        logging.info(
+            '%-12s %8s %8s %6s %9s %9s %9s',
+            name,
+            *(bench.group(i).decode() for i in (3, 4, 5, 6, 7, 8)),
+        )
+
+    # The scenes render from the decoded documents.
+    animals = set()
+    for _ in range(3):
+        bench = dut.expect(BENCH_RECORD, timeout=300)
+        assert int(bench.group(2)) > 0
+        animals.add(bench.group(1).decode())
+    assert animals == {'hummingbird', 'raccoon', 'whale'}
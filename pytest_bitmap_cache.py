@@ -0,0 +1,44 @@
+import logging
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+BENCH_RECORD = (
+    r'TLM bench phase=\d+ res=\d+x\d+ animal=whale frames=(\d+) '
+    r'ms_per_frame=([\d.]+) fps=[\d.]+ min_ms=[\d.]+ max_ms=([\d.]+) '
+    r'render_ms=([\d.]+) flush_ms=([\d.]+) flushed_px=(\d+)'
+)
+CACHE_RECORD = r'TLM bitmap_cache animal=whale frames=(\d+) renders=(\d+) render_ms=([\d.]+) kb=(\d+)'
+AB_RECORD = (
+    r'TLM bitmap_cache_ab animal=whale frames=(\d+) uncached_ms=([\d.]+) cached_ms=([\d.]+) speedup=([\d.]+)'
+)
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['bitmap_cache'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_bitmap_cache_linux(dut: IdfDut) -> None:
+    bench = dut.expect(BENCH_RECORD, timeout=600)
+    cache = dut.expect(CACHE_RECORD, timeout=60)
+    assert int(cache.group(1)) == int(bench.group(1))
+
+    # Bob and tilt only transform the layer: the whale was rendered once,
+    # when the scene was built, and never again while it animated.
+    assert int(cache.group(2)) == 1
+    # A 150x150 ARGB8888 layer, at least.
+    assert int(cache.group(4)) >= 150 * 150 * 4 // 1024
+
+    logging.info(
+        'whale: %s ms/frame, max %s ms, render %s ms/frame; layer rendered in %s ms (%s KB)',
+        *(g.decode() for g in (bench.group(2), bench.group(3), bench.group(4), cache.group(3), cache.group(4))),
+    )
+
+    # The same scene without the cache, timed in the same run: caching must
+    # make the whale's frames cheaper.
+    ab = dut.expect(AB_RECORD, timeout=600)
+    uncached_ms, cached_ms = float(ab.group(2)), float(ab.group(3))
+    logging.info('whale: %.2f ms/frame uncached, %.2f ms/frame cached (%sx)', uncached_ms, cached_ms,
+                 ab.group(4).decode())
+    assert int(ab.group(1)) > 0
+    assert cached_ms < uncached_ms
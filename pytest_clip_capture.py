@@ -0,0 +1,96 @@
+import logging
+import pathlib
+import sys
+
+import pexpect
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+sys.path.insert(0, str(pathlib.Path(__file__).parent / 'tools'))
+import bake_clip  # noqa: E402
+
+CAPTURE_RECORD = r'TLM clip_capture animal=(\w+) frames=(\d+) loop_ms=(\d+) path=(\S+)'
+CHECK_RECORD = rb'TLM clip_check frame=(\d+) sent=(\d+) transfers=(\d+) checksum=0x([0-9a-f]+)'
+CLIP_RECORD = rb'TLM clip frames=(\d+) fps=([\d.]+) target_fps=(\d+)'
+CLIP_CHUNK_LINES = 10  # kClipChunkLines in main/sys/lvgl_port.cpp.
+
+
+def fnv1a(data: bytes) -> int:
+    """HostPanel::checksum() of a framebuffer."""
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def clip_transfers(clip: bytes, width: int, sent: int) -> int:
+    """Transfers LvglPort::play_clip() makes for the first `sent` frames."""
+    _, _, _, _, frames, _, _ = bake_clip.HEADER.unpack_from(clip)
+    boxes = []
+    for i in range(frames + 1):
+        _, _, x1, y1, x2, y2 = bake_clip.ENTRY.unpack_from(clip, bake_clip.HEADER.size + i * bake_clip.ENTRY.size)
+        boxes.append((x1, y1, x2, y2))
+    total = 0
+    # The key frame, then the deltas in a loop.
+    for k in range(sent):
+        x1, y1, x2, y2 = boxes[0] if k == 0 else boxes[1 + k % frames]
+        if x1 < x2 and y1 < y2:
+            lines = max(1, width * CLIP_CHUNK_LINES // (x2 - x1))
+            total += -(-(y2 - y1) // lines)
+    return total
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['clip_capture'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_clip_capture_linux(dut: IdfDut, tmp_path: pathlib.Path) -> None:
+    # The frames are as large as the build's panel.
+    width, height = dut.app.sdkconfig['WORKSHOP_H_RES'], dut.app.sdkconfig['WORKSHOP_V_RES']
+    fps = dut.app.sdkconfig['WORKSHOP_CLIP_FPS']
+
+    capture = dut.expect(CAPTURE_RECORD, timeout=600)
+    assert capture.group(1) == b'whale'
+    frames, loop_ms = int(capture.group(2)), int(capture.group(3))
+    assert frames == loop_ms * fps // 1000
+
+    # The app writes the capture into its working directory.
+    raw = pathlib.Path(capture.group(4).decode())
+    captured = bake_clip.read_frames(raw, width, height)
+    assert len(captured) == frames
+    # An animated scene: the frames are not all the same.
+    assert sum(captured[i - 1] != captured[i] for i in range(frames)) > frames // 2
+
+    clip = bake_clip.encode(captured, width, height, fps)
+    raw_size = frames * width * height * 2
+    logging.info('whale: %d frames, clip %d bytes, %.1fx smaller than raw', frames, len(clip), raw_size / len(clip))
+    assert len(clip) < raw_size
+
+    # Pack the clip into a playback build and check that the panel shows
+    # exactly the captured frames (see check_clip_playback() in main.cpp).
+    clip_path = tmp_path / 'whale.clip'
+    clip_path.write_bytes(clip)
+    fragment = tmp_path / 'sdkconfig.playback'
+    fragment.write_text('CONFIG_USE_KCONFIG_PHASE=y\n'
+                        'CONFIG_WORKSHOP_PHASE=3\n'
+                        'CONFIG_WORKSHOP_CLIP_PLAYBACK=y\n'
+                        f'CONFIG_WORKSHOP_CLIP_FILES="{clip_path}"\n'
+                        f'CONFIG_WORKSHOP_H_RES={width}\n'
+                        f'CONFIG_WORKSHOP_V_RES={height}\n')
+    elf = bake_clip.build_host(tmp_path / 'build', fragment, ('sdkconfig.defaults.assets',))
+    app = pexpect.spawn(str(elf), cwd=str(tmp_path), timeout=300)
+    try:
+        app.expect(CHECK_RECORD)
+        frame, sent, transfers = (int(app.match.group(i)) for i in (1, 2, 3))
+        checksum = int(app.match.group(4), 16)
+        app.expect(CLIP_RECORD)
+        played = int(app.match.group(1))
+    finally:
+        app.terminate(force=True)
+
+    # A whole loop went out, every frame of it as captured.
+    assert sent > frames + 1
+    assert played == sent
+    assert transfers == clip_transfers(clip, width, sent)
+    assert checksum == fnv1a(captured[frame].tobytes()), f'frame {frame} differs from the capture'
+    logging.info('whale: played %d frames in %d transfers, frame %d matches', sent, transfers, frame)
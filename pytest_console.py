@@ -0,0 +1,75 @@
+import logging
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+BENCH_RECORD = (
+    r'TLM bench phase=(\d+) res=\d+x\d+ animal=(\w+) frames=(\d+) ms_per_frame=([\d.]+) '
+    r'fps=[\d.]+ min_ms=[\d.]+ max_ms=[\d.]+'
+)
+STATS_RECORD = r'TLM stats phase=(\d+) build_phase=(\d+) cpu_mhz=(\d+) spi_mhz=(\d+) strip=(\d+)'
+
+
+def command(dut: IdfDut, line: str, status: str = 'ok', timeout: int = 60) -> None:
+    """Send a console command and wait for its completion record."""
+    name = line.split()[0]
+    dut.write(line)
+    match = dut.expect(rf'TLM cmd name={name} status=(\w+) err=(\w+)', timeout=timeout)
+    assert match.group(1).decode() == status, f'{line}: {match.group(2).decode()}'
+
+
+def run_bench(dut: IdfDut, animal: str, frames: int) -> float:
+    dut.write(f'bench {animal} {frames}')
+    match = dut.expect(BENCH_RECORD, timeout=600)
+    dut.expect(r'TLM cmd name=bench status=ok', timeout=10)
+    assert match.group(2).decode() == animal
+    assert int(match.group(3)) == frames
+    return float(match.group(4))
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['console'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_console_linux(dut: IdfDut) -> None:
+    dut.expect_exact('Console ready', timeout=120)
+
+    dut.write('stats')
+    match = dut.expect(STATS_RECORD, timeout=30)
+    assert match.group(1) == match.group(2) == b'3'
+    assert int(match.group(4)) == 80
+    dut.expect(r'TLM cmd name=stats status=ok', timeout=10)
+
+    fast = run_bench(dut, 'whale', 30)
+
+    # The emulated wire is four times slower for the same frames.
+    command(dut, 'spi 20')
+    slow = run_bench(dut, 'whale', 30)
+    logging.info('whale: %.2f ms/frame at 80 MHz, %.2f ms/frame at 20 MHz', fast, slow)
+    assert slow > fast
+
+    # The phase preset brings the bus back; buffers stay as built.
+    dut.write('phase 2')
+    match = dut.expect(r'TLM phase phase=2 build_phase=3 cpu_mhz=(\d+) spi_mhz=(\d+) spi=(\w+)', timeout=30)
+    assert int(match.group(2)) == 80 and match.group(3) == b'applied'
+    dut.expect(r'TLM cmd name=phase status=ok', timeout=10)
+
+    dut.write('strip 10')
+    match = dut.expect(r'TLM buffers id=0 h_res=\d+ v_res=\d+ mode=strip lines=(\d+)', timeout=30)
+    assert int(match.group(1)) == 10
+    dut.expect(r'TLM cmd name=strip status=ok', timeout=10)
+    run_bench(dut, 'raccoon', 10)
+
+    command(dut, 'trace start')
+    run_bench(dut, 'hummingbird', 10)
+    dut.write('trace stop')
+    match = dut.expect(r'TLM trace frames=(\d+) dropped=(\d+)', timeout=30)
+    assert int(match.group(1)) > 0
+    dut.expect(r'TLM cmd name=trace status=ok', timeout=10)
+
+    dut.write('heap')
+    dut.expect(r'TLM allocs allocs=\d+ frees=\d+', timeout=30)
+    dut.expect(r'TLM cmd name=heap status=ok', timeout=10)
+
+    command(dut, 'strip 0', status='error')
+    command(dut, 'bench dragon 10', status='error')
@@ -0,0 +1,54 @@
+import logging
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+CPU_RECORD = (
+    r'TLM cpu window_ms=(\d+) cores=(\d+) core0_busy=([\d.]+) lvgl_core0=([\d.]+) lvgl_migrations=(\d+)'
+)
+LVGL_TASK_RECORD = r'TLM cpu_task name=taskLVGL pct=([\d.]+)'  # esp_lvgl_port's task
+CHECK_RECORD = r'TLM cpu_check migrations=(\d+) lvgl_core0_us=(\d+) lvgl_core1_us=(\d+)'
+BENCH_RECORD = r'TLM bench phase=\d+ res=\d+x\d+ animal=(\w+) frames=\d+ .* core0_busy=([\d.]+) lvgl_core0=([\d.]+)'
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['cpu_monitor'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_cpu_monitor_linux(dut: IdfDut) -> None:
+    # A report from while the boot benchmark renders: the LVGL task runs on
+    # the (single host) core and never migrates.
+    for _ in range(30):
+        cpu = dut.expect(CPU_RECORD, timeout=60)
+        assert 900 <= int(cpu.group(1)) <= 1100
+        assert int(cpu.group(2)) == 1
+        assert int(cpu.group(5)) == 0
+        if float(cpu.group(4)) >= 5.0:
+            break
+    else:
+        pytest.fail('the LVGL task never showed up on core 0')
+    busy, lvgl = float(cpu.group(3)), float(cpu.group(4))
+    assert lvgl <= busy + 1.0
+
+    # The switch hooks and FreeRTOS's own run-time counter time the same
+    # task over the same window: they must agree.
+    task = dut.expect(LVGL_TASK_RECORD, timeout=10)
+    task_pct = float(task.group(1))
+    logging.info('core0 busy %.1f%%: LVGL task %.1f%% by placement, %.1f%% by run time', busy, lvgl, task_pct)
+    assert abs(task_pct - lvgl) <= 5.0
+
+    bench = dut.expect(BENCH_RECORD, timeout=600)
+    busy, lvgl = float(bench.group(2)), float(bench.group(3))
+    logging.info('%s: core0 busy %.1f%%, LVGL task %.1f%%', bench.group(1).decode(), busy, lvgl)
+    assert 0.0 < lvgl <= 100.0
+    assert 0.0 < busy <= 100.0
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['cpu_monitor_selftest'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_cpu_monitor_selftest_linux(dut: IdfDut) -> None:
+    # Scripted switches on two cores: 0 -> 1 -> 1 -> 0 (see check_placement()).
+    check = dut.expect(CHECK_RECORD, timeout=600)
+    assert int(check.group(1)) == 2
+    assert (int(check.group(2)), int(check.group(3))) == (160, 150)
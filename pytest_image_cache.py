@@ -0,0 +1,63 @@
+import logging
+
+import pexpect
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+CACHE_RECORD = (
+    r'TLM imgcache policy=(\w+) hits=(\d+) misses=(\d+) hit_pct=([\d.]+) evictions=(\d+) drops=(\d+) '
+    r'entries=(\d+) bytes=(\d+) max_bytes=(\d+) choices=(\d+) cheapest=(\d+)'
+)
+SOURCE_RECORD = (
+    r'TLM imgcache_src name=(\w+) hits=(\d+) misses=(\d+) evictions=(\d+) drops=(\d+) '
+    r'entries=(\d+) bytes=(\d+) cost_us=(\d+) cost_max_us=(\d+)'
+)
+POLICIES = {'image_cache': 'lru', 'image_cache_cost': 'cost'}
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', list(POLICIES), indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_image_cache_linux(dut: IdfDut, config: str) -> None:
+    # The first window spans the boot benchmark, which shows every scene.
+    cache = dut.expect(CACHE_RECORD, timeout=600)
+    assert cache.group(1).decode() == POLICIES[config]
+    assert int(cache.group(3)) > 0
+    assert int(cache.group(8)) <= int(cache.group(9))
+    logging.info('%s: %s%% hits, %s evictions', config, cache.group(4).decode(), cache.group(5).decode())
+
+    sources = {}
+    while True:
+        try:
+            src = dut.expect(SOURCE_RECORD, timeout=2)
+        except pexpect.TIMEOUT:  # The report is complete.
+            break
+        sources[src.group(1).decode()] = src
+        logging.info(
+            '%-12s hits=%s misses=%s evictions=%s bytes=%s cost_us=%s',
+            *(src.group(i).decode() for i in (1, 2, 3, 4, 7, 8)),
+        )
+
+    # Every scene image was rasterized into the cache at least once, and the
+    # rasterization was timed.
+    for animal in ('hummingbird', 'raccoon', 'whale'):
+        assert animal in sources, f'no cache traffic for {animal}'
+        assert int(sources[animal].group(3)) > 0
+        assert int(sources[animal].group(9)) > 0
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['image_cache_evict'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_image_cache_cost_eviction_linux(dut: IdfDut) -> None:
+    cache = dut.expect(CACHE_RECORD, timeout=600)
+    assert cache.group(1).decode() == 'cost'
+    evictions, choices, cheapest = (int(cache.group(i)) for i in (5, 10, 11))
+    logging.info('%d evictions, %d with a choice, %d of those the cheapest per KB', evictions, choices, cheapest)
+    # The cache is too small for the scenes, so they evict each other.
+    assert evictions > 0
+    assert choices > 0, 'no eviction had more than one candidate'
+    # Cheap entries go first. GreedyDual ages expensive entries that are no
+    # longer hit, so not every choice is the cheapest one.
+    assert cheapest * 2 > choices
@@ -0,0 +1,69 @@
+import logging
+import pathlib
+import sys
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+sys.path.insert(0, str(pathlib.Path(__file__).parent / 'tools'))
+import sweep_knobs  # noqa: E402
+
+BUFFERS_RECORD = r'TLM buffers id=0 h_res=(\d+) v_res=\d+ mode=(\w+) lines=(\d+) count=(\d+) bytes=(\d+)'
+STATS_RECORD = (
+    r'TLM stats phase=\d+ build_phase=(\d+) cpu_mhz=(\d+) spi_mhz=(\d+) strip=(\d+) .* '
+    r'psram=(\d) double=(\d) partial=(\d) bswap=(\d) core=(-?\d) sram=(\d+)'
+)
+PHASE3_STACK = 64 * 1024
+
+
+class DutConsole(sweep_knobs.Console):
+    """The sweep tool's console protocol over the test's DUT."""
+
+    def __init__(self, dut: IdfDut) -> None:
+        super().__init__()
+        self.dut = dut
+
+    def write(self, line: str) -> None:
+        self.dut.write(line)
+
+    def wait_for(self, pattern: str, timeout: float) -> str:
+        return self.dut.expect(pattern + r'[^\r\n]*', timeout=timeout).group(0).decode()
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['knobs'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_knobs_linux(dut: IdfDut) -> None:
+    buffers = dut.expect(BUFFERS_RECORD, timeout=120)
+    h_res = int(buffers.group(1))
+    assert buffers.group(2) == b'strip'
+    assert int(buffers.group(3)) == 30
+    assert int(buffers.group(4)) == 2
+    dut.expect_exact('Console ready', timeout=120)
+
+    # Everything the phase 3 preset does not override keeps its value.
+    dut.write('stats')
+    stats = dut.expect(STATS_RECORD, timeout=30)
+    assert [int(g) for g in stats.groups()[:4]] == [3, 160, 40, 30]
+    assert [int(g) for g in stats.groups()[4:9]] == [0, 1, 1, 0, 0]
+    assert int(stats.group(10)) == 2 * 30 * h_res * 2 + PHASE3_STACK
+    dut.expect(r'TLM cmd name=stats status=ok', timeout=10)
+
+    console = DutConsole(dut)
+    console.command('cpu 240', timeout=30)
+    with pytest.raises(RuntimeError):
+        console.command('cpu 100', timeout=30)
+
+    results = [
+        sweep_knobs.measure(console, {'spi': spi, 'strip': strip}, ['whale'], 10)
+        for spi in ('20', '80')
+        for strip in ('10', '30')
+    ]
+    sweep_knobs.mark_pareto(results)
+    for r in results:
+        logging.info('%s: %.1f fps, %d B%s', r.settings, r.fps, r.sram, ' *' if r.pareto else '')
+    assert not any(r.error for r in results)
+    assert len({r.sram for r in results}) == 2
+    # The cheapest point is always on the frontier.
+    assert min(results, key=lambda r: (r.sram, -r.fps)).pareto
@@ -0,0 +1,29 @@
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+DISPLAY_RECORD = (
+    r'TLM display id=(\d+) fps=([\d.]+) frames=(\d+) flushes=(\d+) '
+    r'flushed_px=(\d+) bus_wait_us=(\d+) contention_pct=([\d.]+)'
+)
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['multi_display'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_multi_display_linux(dut: IdfDut) -> None:
+    # Both host panels show the same scene, so a fair arbiter hands both the
+    # same number of pixels in the first report window.
+    records = {}
+    while len(records) < 2:
+        match = dut.expect(DISPLAY_RECORD, timeout=60)
+        records[int(match.group(1))] = {
+            'frames': int(match.group(3)),
+            'flushed_px': int(match.group(5)),
+        }
+
+    for display_id, record in records.items():
+        assert record['frames'] > 0, f'display {display_id} never refreshed'
+
+    px = [r['flushed_px'] for r in records.values()]
+    assert min(px) >= 0.9 * max(px), f'unfair bus arbitration: {px}'
@@ -0,0 +1,41 @@
+import logging
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+PACING_RECORD = (
+    r'TLM pacing hz=(\d+) slots=(\d+) frames=(\d+) dropped=(\d+) overruns=(\d+) '
+    r'rate_changes=(\d+) render_us=(\d+) flush_us=(\d+) cost_us=(\d+) '
+    r'jitter_avg_us=(\d+) jitter_max_us=(\d+)'
+)
+RATES = (60, 30, 20, 15)
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['pacing'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_pacing_linux(dut: IdfDut) -> None:
+    # The first window includes start-up; judge the ones after it.
+    dut.expect(PACING_RECORD, timeout=60)
+    for _ in range(2):
+        match = dut.expect(PACING_RECORD, timeout=60)
+        hz, slots, frames, dropped = (int(match.group(i)) for i in range(1, 5))
+        cost_us = int(match.group(9))
+        logging.info(
+            '%d Hz: %d frames in %d slots, %d dropped, %s overruns, cost %d us, jitter avg %s us max %s us',
+            hz,
+            frames,
+            slots,
+            dropped,
+            match.group(5).decode(),
+            cost_us,
+            match.group(10).decode(),
+            match.group(11).decode(),
+        )
+        assert hz in RATES
+        assert frames > 0, 'nothing was rendered'
+        # At most one frame per slot: late slots are dropped, not queued (one
+        # slot of slack for the window boundary).
+        assert frames + dropped <= slots + 1
+        assert cost_us > 0
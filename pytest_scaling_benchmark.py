@@ -0,0 +1,72 @@
+import logging
+from typing import Dict
+from typing import List
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+BUFFERS_RECORD = (
+    r'TLM buffers id=0 h_res=(\d+) v_res=(\d+) mode=(\w+) lines=(\d+) '
+    r'count=(\d+) bytes=(\d+)'
+)
+BENCH_RECORD = (
+    r'TLM bench phase=\d+ res=(\d+)x(\d+) animal=(\w+) frames=(\d+) '
+    r'ms_per_frame=([\d.]+) fps=[\d.]+ min_ms=[\d.]+ max_ms=[\d.]+ '
+    r'render_ms=([\d.]+) flush_ms=([\d.]+) flushed_px=(\d+)'
+)
+ANIMALS = 3
+
+
+@pytest.fixture(scope='session')
+def scaling() -> List[Dict[str, object]]:
+    """Rows collected across the parametrized runs, so the last one logs the whole table."""
+    return []
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize(
+    'config',
+    ['scale_240x240', 'scale_320x240', 'scale_360x360', 'scale_480x480'],
+    indirect=True,
+)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_resolution_scaling_linux(dut: IdfDut, scaling: List[Dict[str, object]]) -> None:
+    buffers = dut.expect(BUFFERS_RECORD, timeout=60)
+    h_res, v_res = int(buffers.group(1)), int(buffers.group(2))
+    buffer_bytes = int(buffers.group(6))
+    assert int(buffers.group(4)) * h_res * 2 * int(buffers.group(5)) == buffer_bytes
+
+    for _ in range(ANIMALS):
+        bench = dut.expect(BENCH_RECORD, timeout=600)
+        assert (int(bench.group(1)), int(bench.group(2))) == (h_res, v_res)
+        frames = int(bench.group(4))
+        render_ms = float(bench.group(6))
+        flush_ms = float(bench.group(7))
+
+        # Full-redraw mode: every frame pushes the whole panel.
+        assert int(bench.group(8)) == frames * h_res * v_res
+
+        px = h_res * v_res
+        scaling.append(
+            {
+                'res': f'{h_res}x{v_res}',
+                'animal': bench.group(3),
+                'ms_per_frame': float(bench.group(5)),
+                'render_ns_px': render_ms * 1e6 / px,
+                'flush_ns_px': flush_ms * 1e6 / px,
+                'buffer_bytes': buffer_bytes,
+            }
+        )
+
+    logging.info('%-8s %-12s %9s %13s %12s %8s', 'res', 'animal', 'ms/frame', 'render ns/px', 'flush ns/px', 'buffers')
+    for row in scaling:
+        logging.info(
+            '%-8s %-12s %9.2f %13.1f %12.1f %8d',
+            row['res'],
+            row['animal'],
+            row['ms_per_frame'],
+            row['render_ns_px'],
+            row['flush_ns_px'],
+            row['buffer_bytes'],
+        )
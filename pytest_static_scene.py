@@ -0,0 +1,30 @@
+import logging
+import time
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+IDLE_RECORD = r'TLM idle suspends=(\d+) panel_sleeps=(\d+) frames_skipped=(\d+) asleep_us=(\d+)'
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['static_scene'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_static_scene_linux(dut: IdfDut) -> None:
+    # The hummingbird has nothing to animate: rendering suspends on its own.
+    dut.expect_exact('Console ready', timeout=120)
+    first = dut.expect(IDLE_RECORD, timeout=30)
+    assert int(first.group(1)) == 1
+
+    # Stay suspended for a while, then draw frames and let it settle again.
+    # The second record includes the whole first suspension.
+    time.sleep(1)
+    dut.write('bench hummingbird 10')
+    dut.expect(r'TLM cmd name=bench status=ok', timeout=600)
+    second = dut.expect(IDLE_RECORD, timeout=60)
+    suspends, frames_skipped, asleep_us = (int(second.group(i)) for i in (1, 3, 4))
+    logging.info('%d suspends, %d frames skipped, asleep %.1f s', suspends, frames_skipped, asleep_us / 1e6)
+    assert suspends > 1
+    assert frames_skipped > 0
+    assert asleep_us >= 1_000_000
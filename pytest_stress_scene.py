@@ -0,0 +1,66 @@
+import logging
+from typing import List
+from typing import Tuple
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+STRESS_RECORD = (
+    r'TLM stress phase=\d+ sprites=(\d+) frames=(\d+) ms_per_frame=([\d.]+) '
+    r'fps=([\d.]+) max_ms=[\d.]+ render_ms=[\d.]+ flush_ms=[\d.]+ '
+    r'anim_ms=([\d.]+) dirty_px=(\d+) flushed_px=(\d+) heap_bytes=(\d+)'
+)
+MAX_SPRITES = 64  # CONFIG_WORKSHOP_STRESS_MAX_SPRITES in sdkconfig.ci.stress
+# A doubling of the sprite count that more than triples the frame time is
+# reported as a cliff.
+CLIFF_RATIO = 3.0
+
+
+def sweep(dut: IdfDut) -> List[Tuple[int, float, float, float, int, int]]:
+    rows = []
+    count = 1
+    while count <= MAX_SPRITES:
+        match = dut.expect(STRESS_RECORD, timeout=600)
+        sprites = int(match.group(1))
+        assert sprites == count, f'expected {count} sprites, got {sprites}'
+        assert int(match.group(2)) > 0
+        rows.append(
+            (
+                sprites,
+                float(match.group(3)),
+                float(match.group(4)),
+                float(match.group(5)),
+                int(match.group(6)),
+                int(match.group(8)),
+            )
+        )
+        count *= 2
+    return rows
+
+
+def log_sweep(rows: List[Tuple[int, float, float, float, int, int]]) -> None:
+    logging.info('%7s %9s %7s %8s %9s %10s', 'sprites', 'ms/frame', 'fps', 'anim ms', 'dirty px', 'heap')
+    for row in rows:
+        logging.info('%7d %9.2f %7.1f %8.3f %9d %10d', *row)
+    for prev, cur in zip(rows, rows[1:]):
+        if prev[1] > 0 and cur[1] / prev[1] > CLIFF_RATIO:
+            logging.warning('Cliff between %d and %d sprites: %.2f -> %.2f ms/frame', prev[0], cur[0], prev[1], cur[1])
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['stress'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_stress_scene_linux(dut: IdfDut) -> None:
+    rows = sweep(dut)
+    log_sweep(rows)
+    # Every sprite is animated, so more sprites must never invalidate less.
+    dirty = [row[4] for row in rows]
+    assert dirty[-1] > dirty[0], f'invalidated area did not grow: {dirty}'
+
+
+@pytest.mark.generic
+@pytest.mark.parametrize('config', ['stress'], indirect=True)
+@idf_parametrize('target', ['esp32s3'], indirect=['target'])
+def test_stress_scene(dut: IdfDut) -> None:
+    log_sweep(sweep(dut))
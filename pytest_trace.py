@@ -0,0 +1,37 @@
+import logging
+import pathlib
+import sys
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+sys.path.insert(0, str(pathlib.Path(__file__).parent / 'tools'))
+import trace_to_perfetto  # noqa: E402
+
+TRACE_RECORD = r'(TLM trace_\w+ [^\r\n]*)'
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['trace'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_trace_linux(dut: IdfDut) -> None:
+    lines = []
+    while not lines or not lines[-1].startswith('TLM trace_end'):
+        lines.append(dut.expect(TRACE_RECORD, timeout=600).group(1).decode())
+
+    captures = trace_to_perfetto.parse_log(lines)
+    assert len(captures) == 1
+    capture = captures[0]
+    assert capture.events and capture.tasks
+
+    events = trace_to_perfetto.to_chrome(capture)['traceEvents']
+    slices = [e for e in events if e['ph'] == 'X']
+    tasks = {e['name'] for e in slices if e['pid'] == trace_to_perfetto.CORES_PID}
+    stages = {e['name'] for e in slices if e['pid'] == trace_to_perfetto.STAGES_PID}
+    logging.info('%d events, %d dropped, tasks: %s', len(capture.events), capture.dropped, sorted(tasks))
+    assert 'taskLVGL' in tasks  # esp_lvgl_port's task
+    # Phase 5 runs the native driver: its flush_cb is timed from LVGL's
+    # flush events, its flush-ready ISR is not traced.
+    assert {'refresh', 'render', 'flush_cb'} <= stages
+    assert all(e['dur'] >= 0 for e in slices)
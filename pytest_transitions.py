@@ -0,0 +1,71 @@
+import logging
+import pathlib
+import sys
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+sys.path.insert(0, str(pathlib.Path(__file__).parent / 'tools'))
+import trace_to_perfetto  # noqa: E402
+
+TRANSITION_RECORD = (
+    r'TLM transition kind=(\w+) from=(\w+) to=(\w+) duration_ms=(\d+) frames=(\d+) ms_per_frame=([\d.]+) '
+    r'max_ms=([\d.]+) render_ms=([\d.]+) flush_ms=([\d.]+) flushed_px=(\d+) '
+    r'snapshot_ms=([\d.]+) rebuild_ms=([\d.]+) snapshot_kb=(\d+)'
+)
+TRACE_RECORD = r'(TLM trace_\w+ [^\r\n]*)'
+KINDS = ('cut', 'slide', 'crossfade')
+SCENES = 3
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', ['transitions'], indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_transitions_linux(dut: IdfDut) -> None:
+    records = {kind: [] for kind in KINDS}
+    for _ in range(len(KINDS) * SCENES):
+        match = dut.expect(TRANSITION_RECORD, timeout=600)
+        kind = match.group(1).decode()
+        records[kind].append(match)
+        logging.info(
+            '%-9s %s -> %s: %s ms/frame, max %s ms, snapshot %s ms, rebuild %s ms',
+            kind,
+            *(match.group(i).decode() for i in (2, 3, 6, 7, 11, 12)),
+        )
+
+    for kind, matches in records.items():
+        assert len(matches) == SCENES, f'{kind}: {len(matches)} records'
+        for match in matches:
+            # Every frame of the transition plus the switch was timed.
+            assert int(match.group(5)) >= int(match.group(4)) // 33
+            if kind == 'cut':
+                assert int(match.group(13)) == 0
+            else:
+                # The outgoing scene was captured once, into one panel-sized
+                # RGB565 buffer.
+                assert float(match.group(11)) > 0
+                assert int(match.group(13)) > 0
+
+    def worst(kind: str) -> float:
+        return max(float(m.group(7)) for m in records[kind])
+
+    logging.info('worst frame: cut %.2f ms, slide %.2f ms, crossfade %.2f ms', *(worst(k) for k in KINDS))
+
+    # The transitions' own trace capture follows their records.
+    lines = []
+    while not lines or not lines[-1].startswith('TLM trace_end'):
+        lines.append(dut.expect(TRACE_RECORD, timeout=60).group(1).decode())
+    capture = trace_to_perfetto.parse_log(lines)[-1]
+    slices = [e for e in trace_to_perfetto.to_chrome(capture)['traceEvents'] if e['ph'] == 'X']
+    spans = {}
+    for e in slices:
+        if e['pid'] == trace_to_perfetto.STAGES_PID:
+            spans.setdefault(e['name'], []).append(e['dur'])
+    # Every transition rebuilds; slides and crossfades also take a snapshot.
+    assert len(spans.get('rebuild', [])) >= len(KINDS) * SCENES
+    assert len(spans.get('snapshot', [])) >= (len(KINDS) - 1) * SCENES
+    logging.info(
+        'snapshot %.2f ms, rebuild %.2f ms on average',
+        *(sum(spans[name]) / len(spans[name]) / 1000 for name in ('snapshot', 'rebuild')),
+    )
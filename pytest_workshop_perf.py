@@ -0,0 +1,82 @@
+import json
+import logging
+import pathlib
+import sys
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+sys.path.insert(0, str(pathlib.Path(__file__).parent / 'tools'))
+import gen_phase_configs  # noqa: E402
+
+BENCH_RECORD = (
+    r'TLM bench phase=(\d+) res=\d+x\d+ animal=(\w+) frames=(\d+) ms_per_frame=([\d.]+) fps=[\d.]+ '
+    r'min_ms=[\d.]+ max_ms=([\d.]+) render_ms=([\d.]+) flush_ms=([\d.]+) flushed_px=\d+ '
+    r'allocs=(\d+) heap_bytes=(\d+)'
+)
+PIPELINE_RECORD = (
+    r'TLM flush_pipeline stages=(\d+) px=\d+ rounds=\d+ legacy_us=(\d+) fused_us=(\d+) speedup=([\d.]+) match=(\d)'
+)
+PHASES = [f'phase{n}' for n in gen_phase_configs.PHASES]
+ANIMALS = ('hummingbird', 'raccoon', 'whale')
+PROJECT_DIR = pathlib.Path(__file__).parent
+THRESHOLDS = json.loads((PROJECT_DIR / 'perf_thresholds.json').read_text())
+
+
+@pytest.mark.host_test
+@pytest.mark.parametrize('config', PHASES, indirect=True)
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_workshop_perf_linux(dut: IdfDut, config: str) -> None:
+    # The phase configs differ only in the phase; they are generated.
+    phase_config = (PROJECT_DIR / f'sdkconfig.ci.{config}').read_text()
+    assert phase_config == gen_phase_configs.TEMPLATE.format(phase=config[len('phase'):]), (
+        f'sdkconfig.ci.{config} is out of date: run tools/gen_phase_configs.py'
+    )
+
+    limits = THRESHOLDS['linux'][config]
+    if not limits.get('measured'):
+        logging.warning('%s budgets are estimates; calibrate them with tools/calibrate_thresholds.py', config)
+    regressions = []
+    pipeline = dut.expect(PIPELINE_RECORD, timeout=600)
+    logging.info(
+        '%s flush pipeline (%s stages): legacy %s us, fused %s us, %sx',
+        config,
+        pipeline.group(1).decode(),
+        pipeline.group(2).decode(),
+        pipeline.group(3).decode(),
+        pipeline.group(4).decode(),
+    )
+    assert pipeline.group(5) == b'1', f'{config}: flush pipeline output differs from the legacy loop'
+
+    for _ in ANIMALS:
+        bench = dut.expect(BENCH_RECORD, timeout=600)
+        assert f'phase{int(bench.group(1))}' == config
+        animal = bench.group(2).decode()
+        frames = int(bench.group(3))
+        ms_per_frame = float(bench.group(4))
+        allocs_per_frame = int(bench.group(8)) / frames
+        heap_bytes = int(bench.group(9))
+        logging.info(
+            '%s %-12s %7.2f ms/frame (max %s, render %s, flush %s) %6.1f allocs/frame %8d heap bytes',
+            config,
+            animal,
+            ms_per_frame,
+            bench.group(5).decode(),
+            bench.group(6).decode(),
+            bench.group(7).decode(),
+            allocs_per_frame,
+            heap_bytes,
+        )
+
+        budget = limits['ms_per_frame'][animal]
+        if ms_per_frame > budget:
+            regressions.append(f'{animal}: {ms_per_frame:.2f} ms/frame > {budget}')
+        budget = limits['allocs_per_frame'][animal]
+        if allocs_per_frame > budget:
+            regressions.append(f'{animal}: {allocs_per_frame:.1f} allocs/frame > {budget}')
+        budget = limits['heap_bytes'][animal]
+        if heap_bytes > budget:
+            regressions.append(f'{animal}: {heap_bytes} heap bytes > {budget}')
+
+    assert not regressions, f'{config} regressed:\n' + '\n'.join(regressions)
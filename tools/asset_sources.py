@@ -0,0 +1,28 @@
+"""Read the workshop's SVG sources, wherever they live.
+
+The scenes were written as C++ headers holding a raw string literal
+(main/hummingbird.h, ...); new assets can be plain .svg files. Both build
+tools (bake_splash.py, pack_assets.py) read them through this module, so
+they always see the same bytes as the firmware.
+"""
+import pathlib
+import re
+import sys
+
+
+def extract_svg(header: pathlib.Path) -> bytes:
+    """Pull the raw string literal out of a C++ asset header."""
+    text = header.read_text(encoding='utf-8')
+    match = re.search(r'R"(\w*)\((.*?)\)\1"\s*;', text, re.DOTALL)
+    if not match:
+        sys.exit(f'{header}: no raw string literal found')
+    svg = match.group(2)
+    return svg[svg.index('<'):].encode('utf-8')
+
+
+def load_svg(path: pathlib.Path) -> bytes:
+    """SVG document from a .svg file or a C++ header, starting at '<'."""
+    if path.suffix == '.h':
+        return extract_svg(path)
+    data = path.read_bytes()
+    return data[data.index(b'<'):]
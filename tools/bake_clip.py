@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""Render a scene's animation loop on the host and encode it as a clip.
+
+The clip is rendered by the app itself: the linux target is built with
+WORKSHOP_CLIP_CAPTURE, which steps the scene's animation loop with the
+benchmark's virtual clock and dumps the emulated panel after every frame
+(LVGL and ThorVG exactly as on the chip, byte-swapped as the panel gets
+it). This tool then delta/RLE-encodes the frames for LvglPort::play_clip()
+(see main/sys/clip.h); pack_assets.py puts the result into the asset
+partition.
+
+Layout (little-endian, frame data 4-byte aligned):
+
+    header   magic "WSCL", u16 version, u16 width, u16 height, u16 frames,
+             u16 fps, u16 reserved
+    table    (frames + 1) x { u32 offset, u32 size, u16 x1, y1, x2, y2 }
+             entry 0: the key frame (frame 0, whole panel)
+             entry 1 + i: what changed from frame i - 1 to frame i, with
+             frame -1 being the last one, so the loop closes
+    data     per entry, (y2 - y1) rows of (x2 - x1) pixels, each row a
+             sequence of u16 ops: bit 15 set = run of (op & 0x7fff) copies
+             of the next pixel, clear = that many literal pixels follow
+
+An entry with an empty box (x1 == x2) sends nothing.
+
+The frame size defaults to the panel size of the app's build
+(CONFIG_WORKSHOP_H_RES / V_RES in --sdkconfig, ./sdkconfig by default), so
+the clip matches the firmware it is packed for.
+
+Usage:
+    bake_clip.py capture --animal whale --fps 30 --out clips/whale.clip
+    bake_clip.py encode --raw clip_whale.raw --sdkconfig build_clip/sdkconfig \\
+                        --fps 30 --out clips/whale.clip
+"""
+import argparse
+import array
+import pathlib
+import struct
+import subprocess
+import sys
+import tempfile
+
+from build_config import add_size_arguments
+from build_config import resolve_size
+
+MAGIC = b'WSCL'
+VERSION = 1
+HEADER = struct.Struct('<4sHHHHHH')
+ENTRY = struct.Struct('<IIHHHH')
+RUN_FLAG = 0x8000
+MAX_COUNT = 0x7FFF
+MIN_RUN = 3  # Shorter repeats cost as much as literals.
+
+PROJECT_DIR = pathlib.Path(__file__).resolve().parent.parent
+
+
+def encode_row(row: array.array) -> bytes:
+    out = bytearray()
+    literal = array.array('H')
+
+    def flush_literal() -> None:
+        for start in range(0, len(literal), MAX_COUNT):
+            chunk = literal[start:start + MAX_COUNT]
+            out.extend(struct.pack('<H', len(chunk)))
+            out.extend(chunk.tobytes())
+        del literal[:]
+
+    i, n = 0, len(row)
+    while i < n:
+        j = i + 1
+        while j < n and row[j] == row[i] and j - i < MAX_COUNT:
+            j += 1
+        if j - i >= MIN_RUN:
+            flush_literal()
+            # The pixel goes back out as the same two bytes it came in as.
+            out.extend(struct.pack('<H', RUN_FLAG | (j - i)))
+            out.extend(row[i:i + 1].tobytes())
+        else:
+            literal.extend(row[i:j])
+        i = j
+    flush_literal()
+    return bytes(out)
+
+
+def changed_box(prev: array.array, cur: array.array, width: int, height: int) -> tuple:
+    """Bounding box (x1, y1, x2, y2) of the pixels that differ."""
+    x1, y1, x2, y2 = width, height, 0, 0
+    for y in range(height):
+        a = prev[y * width:(y + 1) * width]
+        b = cur[y * width:(y + 1) * width]
+        if a == b:
+            continue
+        diff = [x for x in range(width) if a[x] != b[x]]
+        x1, x2 = min(x1, diff[0]), max(x2, diff[-1] + 1)
+        y1, y2 = min(y1, y), y + 1
+    return (x1, y1, x2, y2) if x1 < x2 else (0, 0, 0, 0)
+
+
+def encode_box(frame: array.array, width: int, box: tuple) -> bytes:
+    x1, y1, x2, y2 = box
+    return b''.join(encode_row(frame[y * width + x1:y * width + x2]) for y in range(y1, y2))
+
+
+def encode(frames: list, width: int, height: int, fps: int) -> bytes:
+    entries = [((0, 0, width, height), encode_box(frames[0], width, (0, 0, width, height)))]
+    for i, frame in enumerate(frames):
+        box = changed_box(frames[i - 1], frame, width, height)
+        entries.append((box, encode_box(frame, width, box)))
+
+    table_size = HEADER.size + len(entries) * ENTRY.size
+    offset = (table_size + 3) & ~3
+    table, data = bytearray(), bytearray(offset - table_size)
+    for box, blob in entries:
+        table += ENTRY.pack(offset, len(blob), *box)
+        data += blob + bytes(-len(blob) % 4)
+        offset += len(blob) + (-len(blob) % 4)
+    header = HEADER.pack(MAGIC, VERSION, width, height, len(frames), fps, 0)
+    return header + bytes(table) + bytes(data)
+
+
+def read_frames(raw: pathlib.Path, width: int, height: int) -> list:
+    data = raw.read_bytes()
+    frame_bytes = width * height * 2
+    if not data or len(data) % frame_bytes:
+        sys.exit(f'{raw}: {len(data)} bytes is not a whole number of {width}x{height} frames')
+    frames = []
+    for start in range(0, len(data), frame_bytes):
+        frame = array.array('H')
+        frame.frombytes(data[start:start + frame_bytes])
+        frames.append(frame)
+    return frames
+
+
+def build_host(build_dir: pathlib.Path, fragment: pathlib.Path, defaults: tuple = ()) -> pathlib.Path:
+    """Build the linux target with the common defaults, `defaults` and `fragment`; return the ELF."""
+    build_dir = build_dir.resolve()
+    files = [PROJECT_DIR / 'sdkconfig.defaults', *(PROJECT_DIR / d for d in defaults), fragment]
+    subprocess.run(['idf.py', '-C', str(PROJECT_DIR), '-B', str(build_dir),
+                    f'-DSDKCONFIG={build_dir / "sdkconfig"}',
+                    f'-DSDKCONFIG_DEFAULTS={";".join(str(f) for f in files)}',
+                    '-DIDF_TARGET=linux', 'build'], check=True)
+    return build_dir / 'animation_workshop.elf'
+
+
+def capture(args: argparse.Namespace, work_dir: pathlib.Path) -> pathlib.Path:
+    """Build the linux target in capture mode and run it."""
+    fragment = work_dir / 'sdkconfig.clip'
+    fragment.write_text('CONFIG_WORKSHOP_CLIP_CAPTURE=y\n'
+                        f'CONFIG_WORKSHOP_CLIP_ANIMAL="{args.animal}"\n'
+                        f'CONFIG_WORKSHOP_CLIP_FPS={args.fps}\n'
+                        f'CONFIG_WORKSHOP_H_RES={args.width}\n'
+                        f'CONFIG_WORKSHOP_V_RES={args.height}\n'
+                        # Keep the FPS overlay out of the frames.
+                        'CONFIG_LV_USE_PERF_MONITOR=n\n')
+    elf = build_host(args.build_dir, fragment)
+    subprocess.run([str(elf)], cwd=work_dir, check=True, timeout=600)
+    return work_dir / f'clip_{args.animal}.raw'
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest='command', required=True)
+    cap = sub.add_parser('capture', help='render on the host, then encode')
+    cap.add_argument('--animal', required=True)
+    cap.add_argument('--build-dir', type=pathlib.Path, default=PROJECT_DIR / 'build_clip')
+    enc = sub.add_parser('encode', help='encode an existing capture')
+    enc.add_argument('--raw', type=pathlib.Path, required=True)
+    for p in (cap, enc):
+        p.add_argument('--out', type=pathlib.Path, required=True)
+        p.add_argument('--fps', type=int, default=30)
+        add_size_arguments(p)
+    args = parser.parse_args()
+    resolve_size(args)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        if args.command == 'capture':
+            raw = capture(args, pathlib.Path(tmp))
+        else:
+            raw = args.raw
+        frames = read_frames(raw, args.width, args.height)
+        clip = encode(frames, args.width, args.height, args.fps)
+
+    args.out.parent.mkdir(parents=True, exist_ok=True)
+    args.out.write_bytes(clip)
+    raw_size = len(frames) * args.width * args.height * 2
+    print(f'{args.out}: {len(frames)} frames at {args.fps} fps, {len(clip)} bytes '
+          f'({raw_size / len(clip):.1f}x smaller than raw)')
+
+
+if __name__ == '__main__':
+    main()
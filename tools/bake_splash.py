@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""Bake the first frame of every workshop scene into panel-ready blobs.
+
+The first live frame needs the SVG to be parsed and rasterized by ThorVG
+before anything reaches the glass. This build step renders the same first
+frame on the host instead and stores it exactly as the flush path sends it
+to the GC9A01: RGB565, byte-swapped (big-endian), full panel size. LvglPort
+streams the blob from flash right after the panel is initialized.
+
+The scene table mirrors main/ui/workshop_ui.cpp (image size and the first
+value of every animation); keep the two in sync.
+
+Requires cairosvg and Pillow in the ESP-IDF Python environment:
+    pip install cairosvg pillow
+"""
+import argparse
+import io
+import pathlib
+import sys
+
+from asset_sources import extract_svg
+from build_config import add_size_arguments
+from build_config import resolve_size
+
+try:
+    import cairosvg
+    from PIL import Image
+except ImportError:
+    sys.exit('bake_splash.py needs cairosvg and Pillow: pip install cairosvg pillow')
+
+BACKGROUND = (0xE0, 0xF2, 0xFE)  # Screen background in workshop_ui.cpp
+
+# size: ImageDescriptor size, scale: LVGL scale / 256,
+# rotation: degrees clockwise, dy: translate_y in pixels.
+SCENES = {
+    'hummingbird': dict(header='hummingbird.h', size=200, scale=1.0, rotation=0.0, dy=0),
+    'raccoon': dict(header='raccoon.h', size=180, scale=160 / 256, rotation=0.0, dy=0),
+    'whale': dict(header='whale.h', size=150, scale=1.0, rotation=-8.0, dy=6),
+}
+
+
+def render_scene(svg: bytes, scene: dict, width: int, height: int) -> Image.Image:
+    side = max(1, round(scene['size'] * scene['scale']))
+    png = cairosvg.svg2png(bytestring=svg, output_width=side, output_height=side)
+    image = Image.open(io.BytesIO(png)).convert('RGBA')
+    if scene['rotation']:
+        # PIL rotates counter-clockwise, LVGL clockwise.
+        image = image.rotate(-scene['rotation'], resample=Image.BICUBIC, expand=True)
+
+    frame = Image.new('RGBA', (width, height), BACKGROUND + (255,))
+    x = (width - image.width) // 2
+    y = (height - image.height) // 2 + scene['dy']
+    frame.alpha_composite(image, (x, y))
+    return frame.convert('RGB')
+
+
+def to_panel_rgb565(frame: Image.Image) -> bytes:
+    """RGB565, high byte first: what flush_cb sends after its byte swap."""
+    out = bytearray()
+    for r, g, b in frame.getdata():
+        value = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+        out += bytes((value >> 8, value & 0xFF))
+    return bytes(out)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--src', type=pathlib.Path, required=True, help='directory with the *.h SVG headers')
+    parser.add_argument('--out', type=pathlib.Path, required=True, help='output directory')
+    add_size_arguments(parser)
+    args = parser.parse_args()
+    resolve_size(args)
+
+    args.out.mkdir(parents=True, exist_ok=True)
+    for name, scene in SCENES.items():
+        svg = extract_svg(args.src / scene['header'])
+        frame = render_scene(svg, scene, args.width, args.height)
+        blob = to_panel_rgb565(frame)
+        (args.out / f'splash_{name}.bin').write_bytes(blob)
+        print(f'splash_{name}.bin: {args.width}x{args.height}, {len(blob)} bytes')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,49 @@
+"""Read the panel size (and other options) from a build's sdkconfig.
+
+The firmware sizes its frames from CONFIG_WORKSHOP_H_RES / V_RES, so the
+tools that produce frames for it (bake_splash.py, bake_clip.py,
+pack_assets.py) take the size from the same sdkconfig rather than
+assuming the 240x240 Round Display.
+"""
+import pathlib
+import sys
+
+PROJECT_DIR = pathlib.Path(__file__).resolve().parent.parent
+DEFAULT_SDKCONFIG = PROJECT_DIR / 'sdkconfig'
+
+
+def read_sdkconfig(path: pathlib.Path) -> dict:
+    """Options set in an sdkconfig file, without the CONFIG_ prefix."""
+    options = {}
+    for line in path.read_text(encoding='utf-8').splitlines():
+        name, sep, value = line.partition('=')
+        if sep and name.startswith('CONFIG_'):
+            options[name[len('CONFIG_'):]] = value.strip('"')
+    return options
+
+
+def panel_size(path: pathlib.Path) -> tuple:
+    """(width, height) the build renders at."""
+    if not path.is_file():
+        sys.exit(f'{path} not found: build the app first, or pass the size explicitly')
+    options = read_sdkconfig(path)
+    try:
+        return int(options['WORKSHOP_H_RES']), int(options['WORKSHOP_V_RES'])
+    except KeyError:
+        sys.exit(f'{path}: no CONFIG_WORKSHOP_H_RES / CONFIG_WORKSHOP_V_RES')
+
+
+def add_size_arguments(parser) -> None:
+    """--width / --height, defaulting to the size in --sdkconfig."""
+    parser.add_argument('--sdkconfig', type=pathlib.Path, default=DEFAULT_SDKCONFIG,
+                        help='build configuration to take the panel size from (default: %(default)s)')
+    parser.add_argument('--width', type=int, help='panel width (default: CONFIG_WORKSHOP_H_RES)')
+    parser.add_argument('--height', type=int, help='panel height (default: CONFIG_WORKSHOP_V_RES)')
+
+
+def resolve_size(args) -> None:
+    """Fill in --width / --height that were not given from --sdkconfig."""
+    if args.width is None or args.height is None:
+        width, height = panel_size(args.sdkconfig)
+        args.width = args.width if args.width is not None else width
+        args.height = args.height if args.height is not None else height
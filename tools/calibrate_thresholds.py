@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Set the budgets in perf_thresholds.json from measured benchmark runs.
+
+pytest_workshop_perf.py fails a phase when a scene gets slower, allocates
+more per frame or needs more heap than perf_thresholds.json allows. This
+tool reads console logs that hold TLM bench records (e.g. the dut.log files
+pytest-embedded writes, several runs per phase for a stable worst case),
+takes the worst value per phase and scene and adds a margin:
+
+    ms_per_frame      worst * --time-margin    (default 1.25)
+    allocs_per_frame  worst * --alloc-margin   (default 1.5), at least 1
+    heap_bytes        worst * --heap-margin    (default 1.25)
+
+Scenes found in the logs get new budgets, and a phase is marked
+"measured" once all of its scenes have been; everything else is left as
+it is. Review the diff before committing it.
+
+Usage:
+    calibrate_thresholds.py --target linux /tmp/pytest-embedded/*/*/dut.log
+"""
+import argparse
+import json
+import math
+import pathlib
+import re
+import sys
+from collections import defaultdict
+
+PROJECT_DIR = pathlib.Path(__file__).resolve().parent.parent
+THRESHOLDS = PROJECT_DIR / 'perf_thresholds.json'
+ANIMALS = ('hummingbird', 'raccoon', 'whale')
+
+BENCH_RECORD = re.compile(
+    r'TLM bench phase=(\d+) res=\d+x\d+ animal=(\w+) frames=(\d+) ms_per_frame=([\d.]+) .*'
+    r'allocs=(\d+) heap_bytes=(\d+)'
+)
+
+
+def worst_per_phase(paths: list) -> tuple:
+    """Worst values over all runs as {phase: {animal: {metric: value}}}, and the runs per (phase, animal)."""
+    worst = defaultdict(lambda: defaultdict(lambda: defaultdict(float)))
+    runs = defaultdict(int)
+    for path in paths:
+        for line in path.read_text(encoding='utf-8', errors='replace').splitlines():
+            match = BENCH_RECORD.search(line)
+            if not match:
+                continue
+            phase, animal = f'phase{match.group(1)}', match.group(2)
+            frames = max(1, int(match.group(3)))
+            sample = {
+                'ms_per_frame': float(match.group(4)),
+                'allocs_per_frame': int(match.group(5)) / frames,
+                'heap_bytes': int(match.group(6)),
+            }
+            for key, value in sample.items():
+                worst[phase][animal][key] = max(worst[phase][animal][key], value)
+            runs[phase, animal] += 1
+    return worst, runs
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('logs', type=pathlib.Path, nargs='+')
+    parser.add_argument('--target', default='linux')
+    parser.add_argument('--time-margin', type=float, default=1.25)
+    parser.add_argument('--alloc-margin', type=float, default=1.5)
+    parser.add_argument('--heap-margin', type=float, default=1.25)
+    parser.add_argument('--out', type=pathlib.Path, default=THRESHOLDS)
+    args = parser.parse_args()
+
+    worst, runs = worst_per_phase(args.logs)
+    if not worst:
+        print('No TLM bench records in the logs', file=sys.stderr)
+        return 1
+
+    thresholds = json.loads(THRESHOLDS.read_text(encoding='utf-8'))
+    target = thresholds.setdefault(args.target, {})
+    for phase in sorted(worst):
+        animals = worst[phase]
+        limits = target.setdefault(phase, {})
+        for animal, v in animals.items():
+            allocs = max(1, math.ceil(v['allocs_per_frame'] * args.alloc_margin))
+            limits.setdefault('ms_per_frame', {})[animal] = round(v['ms_per_frame'] * args.time_margin, 1)
+            limits.setdefault('allocs_per_frame', {})[animal] = allocs
+            limits.setdefault('heap_bytes', {})[animal] = math.ceil(v['heap_bytes'] * args.heap_margin)
+        # A phase counts as measured once every scene has been.
+        limits['measured'] = bool(limits.get('measured')) or set(animals) >= set(ANIMALS)
+        counts = ', '.join(f'{a} x{runs[phase, a]}' for a in sorted(animals))
+        print(f'{args.target} {phase}: {counts}')
+
+    args.out.write_text(json.dumps(thresholds, indent=2) + '\n', encoding='utf-8')
+    print(f'Wrote {args.out}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
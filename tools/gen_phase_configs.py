@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""Write the per-phase CI configs (sdkconfig.ci.phase1..5) from one template.
+
+pytest_workshop_perf.py benchmarks every phase with the same options; only
+CONFIG_WORKSHOP_PHASE differs. The CI build picks up one sdkconfig.ci.<name>
+per build, so the files must exist, but they are generated: change TEMPLATE
+below and rerun this script instead of editing them.
+
+Usage:
+    gen_phase_configs.py            rewrite the files
+    gen_phase_configs.py --check    exit 1 if any file is out of date
+"""
+import argparse
+import pathlib
+import sys
+
+PROJECT_DIR = pathlib.Path(__file__).resolve().parent.parent
+PHASES = range(1, 6)
+
+TEMPLATE = """\
+# Generated by tools/gen_phase_configs.py; edit the template there.
+# Phase {phase}, benchmarked on boot with the flight recorder (render/flush split,
+# heap low-water) and allocation counting. Used by pytest_workshop_perf.py,
+# which gates the results on perf_thresholds.json.
+CONFIG_USE_KCONFIG_PHASE=y
+CONFIG_WORKSHOP_PHASE={phase}
+CONFIG_WORKSHOP_FLIGHT_RECORDER=y
+CONFIG_WORKSHOP_ALLOC_COUNTING=y
+CONFIG_WORKSHOP_BENCHMARK_ON_BOOT=y
+CONFIG_WORKSHOP_BENCHMARK_FRAMES=60
+"""
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--check', action='store_true', help='only report files that differ')
+    args = parser.parse_args()
+
+    stale = []
+    for phase in PHASES:
+        path = PROJECT_DIR / f'sdkconfig.ci.phase{phase}'
+        text = TEMPLATE.format(phase=phase)
+        if path.is_file() and path.read_text(encoding='utf-8') == text:
+            continue
+        stale.append(path.name)
+        if not args.check:
+            path.write_text(text, encoding='utf-8')
+
+    if args.check and stale:
+        print(f'Out of date: {", ".join(stale)}. Run tools/gen_phase_configs.py', file=sys.stderr)
+        return 1
+    for name in stale:
+        print(f'Wrote {name}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""Pack the workshop assets into an indexed blob for the asset partition.
+
+The firmware maps the partition with esp_partition_mmap() and points LVGL
+image descriptors straight into it (see main/sys/asset_store.h), so the
+assets are neither part of the app image nor copied to RAM. Changing an
+asset only needs `idf.py assets-flash`.
+
+Layout (little-endian, every data block 4-byte aligned):
+
+    header   magic "WSAS", u16 version, u16 count, u32 blob size,
+             u32 CRC-32 of the index
+    index    count x { char name[32], u32 offset, u32 size, u32 raw_size,
+                       u32 raw_crc, u16 width, u16 height, u8 format,
+                       u8 compression, u8 pad[2] }
+    data     the assets, at the offsets in the index
+
+Formats: 0 = SVG document, NUL-terminated (raw_size includes the NUL);
+width and height are 0, the UI picks the render size. 1 = RGB565 raster,
+byte-swapped for the panel (what bake_splash.py writes). 2 = animation clip
+(what bake_clip.py writes); never deflated, it is played in place.
+
+Compression: 0 = stored, 1 = raw deflate (RFC 1951, no zlib header), which
+the firmware streams through the ROM's tinfl (zlib on the linux target).
+size is the stored size, raw_size and raw_crc describe the decoded bytes.
+
+A raw frame is given as name=path@WIDTHxHEIGHT, or name=path@panel for the
+panel size of the build (CONFIG_WORKSHOP_H_RES / V_RES in --sdkconfig).
+
+Usage:
+    pack_assets.py --out assets.bin [--compress] hummingbird=main/hummingbird.h
+                   splash=build/splash.bin@panel clip_whale=clips/whale.clip
+"""
+import argparse
+import pathlib
+import struct
+import sys
+import zlib
+
+from asset_sources import load_svg
+from build_config import DEFAULT_SDKCONFIG
+from build_config import panel_size
+
+MAGIC = b'WSAS'
+VERSION = 2
+HEADER = struct.Struct('<4sHHII')
+ENTRY = struct.Struct('<32sIIIIHHBB2x')
+NAME_MAX = 31
+ALIGN = 4
+
+FORMAT_SVG = 0
+FORMAT_RGB565_SWAPPED = 1
+FORMAT_CLIP = 2
+
+CLIP_HEADER = struct.Struct('<4sHHH')  # magic, version, width, height
+
+COMPRESSION_NONE = 0
+COMPRESSION_DEFLATE = 1
+
+
+def align(value: int) -> int:
+    return (value + ALIGN - 1) & ~(ALIGN - 1)
+
+
+def deflate(data: bytes) -> bytes:
+    compressor = zlib.compressobj(9, zlib.DEFLATED, -15, 9)
+    return compressor.compress(data) + compressor.flush()
+
+
+def pack(assets: list, compress: bool = False) -> bytes:
+    """assets: (name, format, width, height, payload) tuples."""
+    index = bytearray()
+    data = bytearray()
+    data_start = align(HEADER.size + ENTRY.size * len(assets))
+    for name, fmt, width, height, payload in assets:
+        stored, compression = payload, COMPRESSION_NONE
+        if compress and fmt != FORMAT_CLIP:
+            packed = deflate(payload)
+            if len(packed) < len(payload):
+                stored, compression = packed, COMPRESSION_DEFLATE
+
+        offset = data_start + len(data)
+        index += ENTRY.pack(name.encode('ascii'), offset, len(stored), len(payload), zlib.crc32(payload), width,
+                            height, fmt, compression)
+        data += stored
+        data += bytes(align(len(data)) - len(data))
+
+    size = data_start + len(data)
+    header = HEADER.pack(MAGIC, VERSION, len(assets), size, zlib.crc32(index))
+    padding = bytes(data_start - HEADER.size - len(index))
+    return header + bytes(index) + padding + bytes(data)
+
+
+def parse_asset(spec: str, sdkconfig: pathlib.Path) -> tuple:
+    name, sep, path = spec.partition('=')
+    if not sep or not name or not path:
+        sys.exit(f'{spec}: expected name=path')
+    if len(name) > NAME_MAX:
+        sys.exit(f'{name}: names are limited to {NAME_MAX} characters')
+
+    path, sep, size = path.partition('@')
+    if sep:
+        # Raw panel-order RGB565 frame, e.g. a baked splash frame.
+        if size == 'panel':
+            width, height = panel_size(sdkconfig)
+        else:
+            try:
+                width, height = (int(v) for v in size.split('x'))
+            except ValueError:
+                sys.exit(f'{spec}: expected name=path@WIDTHxHEIGHT or name=path@panel')
+        raster = pathlib.Path(path).read_bytes()
+        if len(raster) != width * height * 2:
+            sys.exit(f'{path}: {len(raster)} bytes is not a {width}x{height} RGB565 frame')
+        return (name, FORMAT_RGB565_SWAPPED, width, height, raster)
+
+    if path.endswith('.clip'):
+        clip = pathlib.Path(path).read_bytes()
+        if len(clip) < CLIP_HEADER.size or clip[:4] != b'WSCL':
+            sys.exit(f'{path}: not a clip (make one with bake_clip.py)')
+        _, _, width, height = CLIP_HEADER.unpack_from(clip)
+        return (name, FORMAT_CLIP, width, height, clip)
+
+    svg = load_svg(pathlib.Path(path))
+    return (name, FORMAT_SVG, 0, 0, svg + b'\0')
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--out', type=pathlib.Path, required=True, help='output blob')
+    parser.add_argument('--max-size', type=lambda v: int(v, 0), default=0, help='partition size to check against')
+    parser.add_argument('--compress', action='store_true', help='deflate every asset that gets smaller')
+    parser.add_argument('--sdkconfig', type=pathlib.Path, default=DEFAULT_SDKCONFIG,
+                        help='build configuration for name=path@panel (default: %(default)s)')
+    parser.add_argument('assets', nargs='+', help='name=path (.svg file, C++ header or .clip) or name=path@WxH or name=path@panel (RGB565 frame)')
+    args = parser.parse_args()
+
+    assets = [parse_asset(spec, args.sdkconfig) for spec in args.assets]
+    names = [a[0] for a in assets]
+    if len(set(names)) != len(names):
+        sys.exit('duplicate asset names')
+
+    blob = pack(assets, args.compress)
+    if args.max_size and len(blob) > args.max_size:
+        sys.exit(f'{len(blob)} bytes of assets do not fit the {args.max_size} byte partition')
+
+    args.out.parent.mkdir(parents=True, exist_ok=True)
+    args.out.write_bytes(blob)
+    raw = sum(len(a[4]) for a in assets)
+    print(f'{args.out.name}: {len(assets)} assets, {len(blob)} bytes ({raw} bytes decoded)')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+"""Sweep the phase settings and report the FPS / SRAM Pareto frontier.
+
+Runs the deterministic frame benchmark through the benchmark console
+(main/sys/bench_console.h) for every combination of the given settings. It
+prints one row per combination and marks with '*' those on the Pareto
+frontier, where no other combination is both faster and uses less internal
+SRAM (draw buffers plus the LVGL task stack, as the console's `stats`
+reports).
+
+Settings that change at run time (--cpu, --spi, --strip) are applied with
+console commands. The build-time ones (--driver, --psram, --double,
+--partial, --bswap, --core) need a build per combination, so they can only
+be swept on the host simulator:
+
+    sweep_knobs.py host --phase 3 --double 0,1 --spi 20,40,80 --strip 10,20,40
+    sweep_knobs.py device --port /dev/ttyACM0 --cpu 160,240 --spi 40,80
+
+A device runs whatever was flashed; build it with WORKSHOP_CONSOLE. A
+combination the build cannot apply (e.g. `strip` with the native driver) is
+listed as skipped.
+"""
+import argparse
+import csv
+import itertools
+import pathlib
+import queue
+import re
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from dataclasses import dataclass
+from typing import Dict
+from typing import List
+
+PROJECT_DIR = pathlib.Path(__file__).resolve().parent.parent
+ANIMALS = ('hummingbird', 'raccoon', 'whale')
+
+# Build-time settings: option name and how a value maps to sdkconfig.
+BUILD_KNOBS = {
+    'driver': ('CONFIG_WORKSHOP_NATIVE_DRIVER', {'port': 'n', 'native': 'y'}),
+    'psram': ('CONFIG_WORKSHOP_PSRAM_BUFFERS', {'0': 'n', '1': 'y'}),
+    'double': ('CONFIG_WORKSHOP_DOUBLE_BUFFER', {'0': 'n', '1': 'y'}),
+    'partial': ('CONFIG_WORKSHOP_PARTIAL_REFRESH', {'0': 'n', '1': 'y'}),
+    'bswap': ('CONFIG_WORKSHOP_BSWAP_INTRINSICS', {'0': 'n', '1': 'y'}),
+    'core': ('CONFIG_WORKSHOP_LVGL_CORE', None),
+}
+# Run-time settings: the console command that applies them.
+RUN_KNOBS = ('cpu', 'spi', 'strip')
+
+CMD_RECORD = re.compile(r'TLM cmd name=(\w+) status=(\w+) err=(\w+)')
+BENCH_RECORD = re.compile(r'TLM bench .*animal=(\w+) frames=(\d+) ms_per_frame=([\d.]+)')
+STATS_RECORD = re.compile(r'TLM stats .* sram=(\d+)')
+
+
+@dataclass
+class Result:
+    settings: Dict[str, str]
+    ms_per_frame: float = 0.0
+    sram: int = 0
+    error: str = ''
+    pareto: bool = False
+
+    @property
+    def fps(self) -> float:
+        return 1000.0 / self.ms_per_frame if self.ms_per_frame else 0.0
+
+
+class Console:
+    """Sends console commands and collects the TLM records they print."""
+
+    def __init__(self) -> None:
+        self.lines: 'queue.Queue[str]' = queue.Queue()
+
+    def write(self, line: str) -> None:
+        raise NotImplementedError
+
+    def pump(self, stream) -> None:
+        for raw in stream:
+            if raw:
+                self.lines.put(raw.decode(errors='replace') if isinstance(raw, bytes) else raw)
+
+    def wait_for(self, pattern: str, timeout: float) -> str:
+        deadline = time.monotonic() + timeout
+        while True:
+            try:
+                line = self.lines.get(timeout=max(0.0, deadline - time.monotonic()))
+            except queue.Empty:
+                raise TimeoutError(f'no "{pattern}" within {timeout:.0f} s') from None
+            if re.search(pattern, line):
+                return line
+
+    def command(self, line: str, timeout: float = 600) -> List[str]:
+        """Run a command; returns its TLM records, raises on an error status."""
+        name = line.split()[0]
+        self.write(line)
+        records = []
+        deadline = time.monotonic() + timeout
+        while True:
+            record = self.wait_for(r'TLM ', deadline - time.monotonic())
+            done = CMD_RECORD.search(record)
+            if done and done.group(1) == name:
+                if done.group(2) != 'ok':
+                    raise RuntimeError(f'{line}: {done.group(3)}')
+                return records
+            records.append(record)
+
+
+class HostConsole(Console):
+    """The linux target, built with the given sdkconfig lines."""
+
+    def __init__(self, build_dir: pathlib.Path, options: List[str]) -> None:
+        super().__init__()
+        build_dir.mkdir(parents=True, exist_ok=True)
+        fragment = build_dir / 'sdkconfig.sweep'
+        fragment.write_text('\n'.join(options) + '\n')
+        defaults = ';'.join([str(PROJECT_DIR / 'sdkconfig.defaults'), str(fragment)])
+        # A fresh sdkconfig, so every option takes its phase default again.
+        (build_dir / 'sdkconfig').unlink(missing_ok=True)
+        subprocess.run(['idf.py', '-C', str(PROJECT_DIR), '-B', str(build_dir),
+                        f'-DSDKCONFIG={build_dir / "sdkconfig"}', f'-DSDKCONFIG_DEFAULTS={defaults}',
+                        '-DIDF_TARGET=linux', 'build'], check=True, stdout=subprocess.DEVNULL)
+        self.work_dir = tempfile.TemporaryDirectory()
+        self.proc = subprocess.Popen([str(build_dir / 'animation_workshop.elf')], cwd=self.work_dir.name,
+                                     stdin=subprocess.PIPE, stdout=subprocess.PIPE, text=True, errors='replace')
+        threading.Thread(target=self.pump, args=(self.proc.stdout,), daemon=True).start()
+
+    def write(self, line: str) -> None:
+        self.proc.stdin.write(line + '\n')
+        self.proc.stdin.flush()
+
+    def close(self) -> None:
+        self.proc.kill()
+        self.proc.wait()
+        self.work_dir.cleanup()
+
+
+class DeviceConsole(Console):
+    """A flashed board on a serial port (needs pyserial)."""
+
+    def __init__(self, port: str, baud: int) -> None:
+        super().__init__()
+        import serial  # Only needed for devices.
+        self.serial = serial.Serial(port, baud, timeout=1)
+        threading.Thread(target=self.pump, args=(iter(self.serial.readline, None),), daemon=True).start()
+
+    def write(self, line: str) -> None:
+        self.serial.write((line + '\n').encode())
+
+    def close(self) -> None:
+        self.serial.close()
+
+
+def measure(console: Console, settings: Dict[str, str], animals: List[str], frames: int) -> Result:
+    result = Result(settings)
+    try:
+        for knob in RUN_KNOBS:
+            if knob in settings:
+                console.command(f'{knob} {settings[knob]}', timeout=60)
+        total_ms = 0.0
+        for animal in animals:
+            for record in console.command(f'bench {animal} {frames}'):
+                bench = BENCH_RECORD.search(record)
+                if bench:
+                    total_ms += float(bench.group(3))
+        result.ms_per_frame = total_ms / len(animals)
+        for record in console.command('stats', timeout=60):
+            stats = STATS_RECORD.search(record)
+            if stats:
+                result.sram = int(stats.group(1))
+    except (RuntimeError, TimeoutError) as e:
+        result.error = str(e)
+    return result
+
+
+def mark_pareto(results: List[Result]) -> None:
+    """Flag the results no other result beats on both FPS and SRAM."""
+    best_fps = -1.0
+    for r in sorted((r for r in results if not r.error), key=lambda r: (r.sram, -r.fps)):
+        if r.fps > best_fps:
+            r.pareto = True
+            best_fps = r.fps
+
+
+def grid(args: argparse.Namespace, names) -> List[Dict[str, str]]:
+    swept = [(name, getattr(args, name).split(',')) for name in names if getattr(args, name)]
+    return [dict(zip([n for n, _ in swept], values)) for values in itertools.product(*[v for _, v in swept])]
+
+
+def build_options(args: argparse.Namespace, settings: Dict[str, str]) -> List[str]:
+    options = ['CONFIG_USE_KCONFIG_PHASE=y', f'CONFIG_WORKSHOP_PHASE={args.phase}',
+               'CONFIG_WORKSHOP_CUSTOM_KNOBS=y', 'CONFIG_WORKSHOP_CONSOLE=y']
+    for name, value in settings.items():
+        option, values = BUILD_KNOBS[name]
+        options.append(f'{option}={values[value] if values else value}')
+    return options
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest='target', required=True)
+    host = sub.add_parser('host', help='build and run the linux target per build-time combination')
+    # Phase 3, not 5: the native driver of phase 5 cannot apply --strip.
+    host.add_argument('--phase', type=int, default=3, help='preset the unswept settings come from')
+    host.add_argument('--build-dir', type=pathlib.Path, default=PROJECT_DIR / 'build_sweep')
+    for name in BUILD_KNOBS:
+        host.add_argument(f'--{name}', help='comma-separated values')
+    device = sub.add_parser('device', help='a flashed board with the console enabled')
+    device.add_argument('--port', required=True)
+    device.add_argument('--baud', type=int, default=115200)
+    for p in (host, device):
+        p.add_argument('--cpu', help='CPU clocks in MHz, comma-separated')
+        p.add_argument('--spi', help='SPI clocks in MHz, comma-separated')
+        p.add_argument('--strip', help='strip heights in lines, comma-separated')
+        p.add_argument('--animals', default=','.join(ANIMALS))
+        p.add_argument('--frames', type=int, default=60)
+        p.add_argument('--csv', type=pathlib.Path, help='also write the results here')
+    args = parser.parse_args()
+
+    animals = args.animals.split(',')
+    builds = grid(args, BUILD_KNOBS) if args.target == 'host' else [{}]
+    runs = grid(args, RUN_KNOBS)
+    results = []
+    for build in builds:
+        if args.target == 'host':
+            print(f'Building {build or "phase " + str(args.phase)}...', file=sys.stderr)
+            console = HostConsole(args.build_dir.resolve(), build_options(args, build))
+        else:
+            console = DeviceConsole(args.port, args.baud)
+        try:
+            if args.target == 'host':
+                console.wait_for('Console ready', timeout=600)
+            for run in runs:
+                result = measure(console, {**build, **run}, animals, args.frames)
+                print(f'  {result.settings}: {result.error or f"{result.fps:.1f} fps, {result.sram} B"}',
+                      file=sys.stderr)
+                results.append(result)
+        finally:
+            console.close()
+
+    mark_pareto(results)
+    names = [n for n in list(BUILD_KNOBS) + list(RUN_KNOBS) if any(n in r.settings for r in results)]
+    print(' '.join(f'{n:>7}' for n in names) + '      fps   ms/frame   sram (B)')
+    for r in sorted(results, key=lambda r: (bool(r.error), r.sram, -r.fps)):
+        row = ' '.join(f'{r.settings.get(n, "-"):>7}' for n in names)
+        if r.error:
+            print(f'{row}   skipped: {r.error}')
+        else:
+            print(f'{row} {r.fps:8.1f} {r.ms_per_frame:10.2f} {r.sram:10d} {"*" if r.pareto else ""}')
+    if args.csv:
+        with args.csv.open('w', newline='') as f:
+            writer = csv.writer(f)
+            writer.writerow(names + ['fps', 'ms_per_frame', 'sram', 'pareto', 'error'])
+            for r in results:
+                writer.writerow([r.settings.get(n, '') for n in names] +
+                                [f'{r.fps:.2f}', f'{r.ms_per_frame:.3f}', r.sram, int(r.pareto), r.error])
+    return 0 if any(r.pareto for r in results) else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
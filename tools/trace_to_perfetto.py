@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Convert an event trace from the console log into Chrome trace JSON.
+
+With WORKSHOP_TRACE the app records task switches, the flush-ready ISR,
+flush_cb, the touch read, LVGL's refresh phases and the snapshot and
+rebuild of scene transitions (main/sys/trace_recorder.h) and prints each
+capture as TLM records:
+
+    TLM trace_start version=1 events=N dropped=D tasks=T event_bytes=8
+                    spans=refresh,render,...
+    TLM trace_task id=I name=NAME                        (T lines)
+    TLM trace_data index=FIRST hex=...                   (64 events a line)
+    TLM trace_end events=N
+
+Every event is 8 bytes, little-endian: u32 microseconds since the start of
+the capture, u16 argument (task id or span index), u8 type (0 task
+switched in, 1 task switched out, 2 span begin, 3 span end), u8 core.
+
+The JSON shows one track per core with the task running on it, and one
+track per pipeline stage with its spans (the core they ran on is in the
+arguments). Open it in https://ui.perfetto.dev or chrome://tracing.
+
+Usage:
+    trace_to_perfetto.py console.log --out trace.json [--capture -1]
+"""
+import argparse
+import json
+import re
+import struct
+import sys
+from dataclasses import dataclass
+from dataclasses import field
+from typing import Dict
+from typing import Iterable
+from typing import List
+from typing import Tuple
+
+EVENT = struct.Struct('<IHBB')
+TASK_IN, TASK_OUT, BEGIN, END = range(4)
+UNKNOWN_TASK = 0xFFFF
+
+RECORD = re.compile(r'TLM (trace_\w+) (.*)')
+FIELD = re.compile(r'(\w+)=(\S*)')
+
+CORES_PID = 1
+STAGES_PID = 2
+
+
+@dataclass
+class Capture:
+    spans: List[str]
+    dropped: int
+    tasks: Dict[int, str] = field(default_factory=dict)
+    events: List[Tuple[int, int, int, int]] = field(default_factory=list)
+
+    def task_name(self, task_id: int) -> str:
+        if task_id == UNKNOWN_TASK:
+            return 'unknown'  # The recorder's task table was full.
+        return self.tasks.get(task_id, f'task_{task_id}')
+
+
+def parse_log(lines: Iterable[str]) -> List[Capture]:
+    """Every complete capture in the log, in order."""
+    captures = []
+    current = None
+    data = bytearray()
+    for line in lines:
+        match = RECORD.search(line)
+        if not match:
+            continue
+        kind = match.group(1)
+        fields = dict(FIELD.findall(match.group(2)))
+        if kind == 'trace_start':
+            if int(fields['event_bytes']) != EVENT.size:
+                raise ValueError(f'unexpected event size {fields["event_bytes"]}')
+            current = Capture(spans=fields['spans'].split(','), dropped=int(fields['dropped']))
+            data = bytearray()
+        elif current is None:
+            continue
+        elif kind == 'trace_task':
+            current.tasks[int(fields['id'])] = fields['name']
+        elif kind == 'trace_data':
+            if int(fields['index']) * EVENT.size != len(data):
+                raise ValueError(f'trace_data index {fields["index"]} out of order')
+            data.extend(bytes.fromhex(fields['hex']))
+        elif kind == 'trace_end':
+            current.events = list(EVENT.iter_unpack(bytes(data)))
+            if len(current.events) != int(fields['events']):
+                raise ValueError('truncated capture')
+            captures.append(current)
+            current = None
+    return captures
+
+
+def to_chrome(capture: Capture) -> dict:
+    out = [
+        {'ph': 'M', 'name': 'process_name', 'pid': CORES_PID, 'args': {'name': 'CPU cores'}},
+        {'ph': 'M', 'name': 'process_name', 'pid': STAGES_PID, 'args': {'name': 'Render pipeline'}},
+    ]
+    for i, name in enumerate(capture.spans):
+        out.append({'ph': 'M', 'name': 'thread_name', 'pid': STAGES_PID, 'tid': i, 'args': {'name': name}})
+
+    running: Dict[int, Tuple[int, int]] = {}  # core -> (task, since)
+    open_spans: Dict[int, List[Tuple[int, int]]] = {}  # span -> [(since, core)]
+    cores = set()
+    # Events are written in claim order; cores may interleave slightly.
+    for ts, arg, kind, core in sorted(capture.events, key=lambda e: e[0]):
+        cores.add(core)
+        if kind == TASK_IN:
+            running[core] = (arg, ts)
+        elif kind == TASK_OUT:
+            task, since = running.pop(core, (arg, None))
+            if since is not None:
+                out.append({'ph': 'X', 'name': capture.task_name(task), 'pid': CORES_PID, 'tid': core,
+                            'ts': since, 'dur': ts - since})
+        elif kind == BEGIN:
+            open_spans.setdefault(arg, []).append((ts, core))
+        elif kind == END and open_spans.get(arg):
+            since, begin_core = open_spans[arg].pop()
+            name = capture.spans[arg] if arg < len(capture.spans) else f'span_{arg}'
+            out.append({'ph': 'X', 'name': name, 'pid': STAGES_PID, 'tid': arg, 'ts': since,
+                        'dur': ts - since, 'args': {'core': begin_core, 'end_core': core}})
+    for core in sorted(cores):
+        out.append({'ph': 'M', 'name': 'thread_name', 'pid': CORES_PID, 'tid': core,
+                    'args': {'name': f'core {core}'}})
+    return {'traceEvents': out, 'displayTimeUnit': 'ms',
+            'otherData': {'dropped_events': capture.dropped}}
+
+
+def summarize(capture: Capture) -> Dict[Tuple[int, str], int]:
+    """Microseconds each task ran on each core."""
+    busy: Dict[Tuple[int, str], int] = {}
+    for event in to_chrome(capture)['traceEvents']:
+        if event['ph'] == 'X' and event['pid'] == CORES_PID:
+            key = (event['tid'], event['name'])
+            busy[key] = busy.get(key, 0) + event['dur']
+    return busy
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('log', help='console log holding TLM trace_* records')
+    parser.add_argument('--out', required=True, help='Chrome trace JSON to write')
+    parser.add_argument('--capture', type=int, default=-1, help='which capture in the log (default: the last)')
+    args = parser.parse_args()
+
+    with open(args.log, encoding='utf-8', errors='replace') as f:
+        captures = parse_log(f)
+    if not captures:
+        print(f'No complete trace capture in {args.log}', file=sys.stderr)
+        return 1
+    capture = captures[args.capture]
+    with open(args.out, 'w', encoding='utf-8') as f:
+        json.dump(to_chrome(capture), f)
+
+    span_us = max((e[0] for e in capture.events), default=0)
+    print(f'{len(capture.events)} events over {span_us / 1000:.1f} ms, {capture.dropped} dropped -> {args.out}')
+    for (core, task), us in sorted(summarize(capture).items(), key=lambda kv: (kv[0][0], -kv[1])):
+        print(f'  core {core}  {task:<16} {us / 1000:9.1f} ms  {100.0 * us / max(span_us, 1):5.1f}%')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())